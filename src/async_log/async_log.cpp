@@ -0,0 +1,253 @@
+#include <atomic>
+#include <bit>
+#include <string>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "async_log/async_log.hpp"
+
+namespace {
+    /**
+     * Producers notify the writer without locking, so a notification may occasionally be missed.
+     * The writer therefore never sleeps longer than this while records may be pending.
+     */
+    constexpr auto WRITER_IDLE_TIMEOUT = std::chrono::milliseconds(10);
+}
+
+namespace async_log {
+    struct Log::State {
+        struct alignas(64) Slot {
+            // Equals the position of the record for a free slot, and the position plus one for a published one
+            std::atomic<uint64_t> sequence = 0;
+            size_t length = 0;
+            char text[RECORD_SIZE]{};
+        };
+
+        State(Sink sink, const size_t capacity) : sink(std::move(sink)), slots(capacity), mask(capacity - 1) {
+            for(size_t i = 0; i < capacity; ++i) {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        Sink sink;
+        std::vector<Slot> slots;
+        const uint64_t mask;
+
+        alignas(64) std::atomic<uint64_t> enqueue_position = 0;
+        std::atomic<uint64_t> dropped = 0;
+
+        // Owned by whichever thread holds `consuming`
+        alignas(64) std::atomic<uint64_t> dequeue_position = 0;
+        uint64_t reported_dropped = 0;
+        std::atomic_flag consuming;
+
+        std::atomic<bool> stopped = false;
+        std::atomic<bool> writer_waiting = false;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable drained;
+
+        [[nodiscard]] bool has_pending() const {
+            const auto position = dequeue_position.load(std::memory_order_relaxed);
+            return slots[position & mask].sequence.load(std::memory_order_acquire) == position + 1;
+        }
+
+        void write(const std::string_view line) const {
+            try {
+                sink(line);
+            } catch(...) {
+                // A failing sink must not terminate the writer thread
+            }
+        }
+
+        /**
+         * Must only be called while holding `consuming`
+         */
+        void drain() {
+            auto position = dequeue_position.load(std::memory_order_relaxed);
+
+            while(true) {
+                auto& slot = slots[position & mask];
+                if(slot.sequence.load(std::memory_order_acquire) != position + 1) {
+                    break;
+                }
+
+                write({slot.text, slot.length});
+
+                slot.sequence.store(position + mask + 1, std::memory_order_release);
+                dequeue_position.store(++position, std::memory_order_release);
+            }
+
+            if(const auto total_dropped = dropped.load(std::memory_order_relaxed); total_dropped > reported_dropped) {
+                write(
+                    std::to_string(total_dropped - reported_dropped) +
+                    " log records were dropped because the log buffer was full"
+                );
+                reported_dropped = total_dropped;
+            }
+        }
+
+        bool try_acquire_consumer() {
+            return not consuming.test_and_set(std::memory_order_acquire);
+        }
+
+        /**
+         * @return false if another thread kept consuming until the deadline
+         */
+        bool acquire_consumer(const std::chrono::steady_clock::time_point deadline) {
+            while(not try_acquire_consumer()) {
+                if(std::chrono::steady_clock::now() >= deadline) {
+                    return false;
+                }
+
+                std::this_thread::yield();
+            }
+
+            return true;
+        }
+
+        static void run_writer(const std::shared_ptr<State>& state) {
+            while(not state->stopped.load(std::memory_order_acquire)) {
+                if(state->has_pending() && state->try_acquire_consumer()) {
+                    state->drain();
+                    state->release_consumer();
+                    continue;
+                }
+
+                std::unique_lock lock(state->mutex);
+                state->writer_waiting.store(true);
+                state->wake.wait_for(
+                    lock, WRITER_IDLE_TIMEOUT, [&] {
+                        return state->stopped.load() || state->has_pending();
+                    }
+                );
+                state->writer_waiting.store(false, std::memory_order_relaxed);
+            }
+
+            // Records claimed while the log was stopping
+            if(state->try_acquire_consumer()) {
+                state->drain();
+                state->release_consumer();
+            }
+        }
+
+        void release_consumer() {
+            consuming.clear(std::memory_order_release);
+
+            {
+                const std::lock_guard lock(mutex);
+            }
+            drained.notify_all();
+        }
+    };
+
+    Log::Log(Sink sink, const size_t capacity) :
+        state(std::make_shared<State>(std::move(sink), std::bit_ceil(std::max<size_t>(capacity, 2)))) {
+        // Detached, since a thread cannot be joined from DllMain during process exit
+        std::thread(State::run_writer, state).detach();
+    }
+
+    Log::~Log() {
+        stop();
+    }
+
+    bool Log::push(const std::string_view line) {
+        return push_with(
+            [line](char* text, const size_t size) {
+                const auto length = std::min(line.size(), size);
+                std::copy_n(line.data(), length, text);
+                return length;
+            }
+        );
+    }
+
+    char* Log::claim(uint64_t& position) {
+        position = state->enqueue_position.load(std::memory_order_relaxed);
+
+        while(true) {
+            auto& slot = state->slots[position & state->mask];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<int64_t>(sequence - position);
+
+            if(difference == 0) {
+                if(state->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return slot.text;
+                }
+            } else if(difference < 0) {
+                state->dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            } else {
+                position = state->enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void Log::publish(const uint64_t position, const size_t length) {
+        auto& slot = state->slots[position & state->mask];
+        slot.length = length;
+        slot.sequence.store(position + 1, std::memory_order_release);
+
+        if(state->writer_waiting.load()) {
+            state->wake.notify_one();
+        }
+    }
+
+    bool Log::is_stopped() const {
+        return state->stopped.load(std::memory_order_acquire);
+    }
+
+    void Log::write_directly(const std::string_view line) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+
+        if(not state->acquire_consumer(deadline)) {
+            state->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        state->write(line);
+        state->release_consumer();
+    }
+
+    void Log::flush() {
+        const auto target = state->enqueue_position.load(std::memory_order_acquire);
+
+        state->wake.notify_one();
+
+        std::unique_lock lock(state->mutex);
+        state->drained.wait(
+            lock, [&] {
+                return state->dequeue_position.load(std::memory_order_acquire) >= target || is_stopped();
+            }
+        );
+    }
+
+    void Log::stop(const std::chrono::milliseconds timeout) {
+        if(state->stopped.exchange(true)) {
+            return;
+        }
+
+        state->wake.notify_one();
+
+        if(not state->acquire_consumer(std::chrono::steady_clock::now() + timeout)) {
+            // The writer thread was terminated while writing
+            return;
+        }
+
+        state->drain();
+        state->release_consumer();
+    }
+
+    size_t Log::capacity() const {
+        return state->slots.size();
+    }
+
+    uint64_t Log::written() const {
+        return state->dequeue_position.load(std::memory_order_acquire);
+    }
+
+    uint64_t Log::dropped() const {
+        return state->dropped.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * Asynchronous log for hot paths, such as API hooks.
+ *
+ * Producers write records directly into the slots of a bounded lock-free
+ * multi-producer ring buffer, which a background thread drains into a sink.
+ * Producers never block and never allocate: if the buffer is full,
+ * the record is dropped and counted, and the writer reports the number
+ * of dropped records once there is room again.
+ */
+namespace async_log {
+    class Log {
+    public:
+        /**
+         * Maximum length of a record. Longer records are truncated.
+         */
+        static constexpr size_t RECORD_SIZE = 480;
+
+        using Sink = std::function<void(std::string_view line)>;
+
+        /**
+         * Starts the writer thread
+         *
+         * @param sink Receives records in the order they were pushed, from a single thread at a time
+         * @param capacity Number of records. Rounded up to a power of two.
+         */
+        Log(Sink sink, size_t capacity);
+
+        ~Log();
+
+        Log(const Log&) = delete;
+
+        Log& operator=(const Log&) = delete;
+
+        /**
+         * Lets the caller format a record directly into its slot, without any allocations.
+         * Once the log is stopped, records are passed to the sink synchronously instead.
+         *
+         * @param write Called with the text buffer of the record and its size `RECORD_SIZE`.
+         * Returns the length of the record, which is truncated to `RECORD_SIZE`.
+         * Suitable for `std::format_to_n(text, size, ...).size`.
+         * @return false if the record was dropped because the buffer is full
+         */
+        template<typename Writer>
+        bool push_with(const Writer& write) {
+            if(is_stopped()) {
+                char text[RECORD_SIZE];
+                write_directly({text, write_record(write, text)});
+                return true;
+            }
+
+            uint64_t position = 0;
+            auto* const text = claim(position);
+            if(not text) {
+                return false;
+            }
+
+            publish(position, write_record(write, text));
+            return true;
+        }
+
+        /**
+         * Copies the line into a record
+         *
+         * @return false if the record was dropped because the buffer is full
+         */
+        bool push(std::string_view line);
+
+        /**
+         * Blocks until every record pushed before the call has been passed to the sink
+         */
+        void flush();
+
+        /**
+         * Passes all remaining records to the sink on the calling thread and stops the writer.
+         * Does not wait for the writer thread, which may already have been terminated
+         * if this is called during process exit. Waits at most `timeout` if the writer
+         * is in the middle of writing records.
+         */
+        void stop(std::chrono::milliseconds timeout = std::chrono::milliseconds(100));
+
+        [[nodiscard]] size_t capacity() const;
+
+        [[nodiscard]] uint64_t written() const;
+
+        [[nodiscard]] uint64_t dropped() const;
+
+    private:
+        struct State;
+
+        // Shared with the writer thread, which is detached and may outlive the log
+        std::shared_ptr<State> state;
+
+        [[nodiscard]] bool is_stopped() const;
+
+        /**
+         * @return Text of the claimed slot, or nullptr if the buffer is full
+         */
+        char* claim(uint64_t& position);
+
+        void publish(uint64_t position, size_t length);
+
+        void write_directly(std::string_view line);
+
+        template<typename Writer>
+        static size_t write_record(const Writer& write, char* text) {
+            try {
+                const auto length = static_cast<int64_t>(write(text, RECORD_SIZE));
+                return static_cast<size_t>(std::clamp<int64_t>(length, 0, RECORD_SIZE));
+            } catch(...) {
+                // A claimed slot must always be published, or the writer would wait for it forever
+                return 0;
+            }
+        }
+    };
+}
@@ -0,0 +1,735 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "byte_scanner/byte_scanner.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BYTE_SCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BYTE_SCANNER_TARGET(ISA) __attribute__((target(ISA)))
+#else
+#define BYTE_SCANNER_TARGET(ISA)
+#endif
+
+namespace {
+    using namespace byte_scanner;
+
+    int parse_hex_digit(const char c) {
+        if(c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if(c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if(c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    bool is_space(const char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+#ifdef BYTE_SCANNER_X86
+    struct CpuFeatures {
+        bool sse2 = false;
+        bool avx2 = false;
+    };
+
+    CpuFeatures detect_cpu_features() {
+#ifdef _MSC_VER
+        int info[4]{};
+        __cpuid(info, 0);
+        const auto max_leaf = info[0];
+
+        __cpuid(info, 1);
+        const bool sse2 = info[3] & (1 << 26);
+        const bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+
+        bool avx2 = false;
+        if(max_leaf >= 7 && os_saves_ymm) {
+            __cpuidex(info, 7, 0);
+            avx2 = info[1] & (1 << 5);
+        }
+
+        return {.sse2 = sse2, .avx2 = avx2};
+#else
+        __builtin_cpu_init();
+        return {
+            .sse2 = static_cast<bool>(__builtin_cpu_supports("sse2")),
+            .avx2 = static_cast<bool>(__builtin_cpu_supports("avx2")),
+        };
+#endif
+    }
+
+    const CpuFeatures& get_cpu_features() {
+        static const auto features = detect_cpu_features();
+        return features;
+    }
+
+    BYTE_SCANNER_TARGET("avx2")
+    __m256i load_table(const std::array<uint8_t, 16>& table) {
+        return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data())));
+    }
+
+    /**
+     * @return Bitwise AND of the table entries for the low and high nibble of every byte in the block
+     */
+    BYTE_SCANNER_TARGET("avx2")
+    __m256i lookup_nibbles(const __m256i block, const __m256i low_table, const __m256i high_table) {
+        const auto nibble_mask = _mm256_set1_epi8(0x0F);
+        const auto low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(block, nibble_mask));
+        const auto high = _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble_mask));
+        return _mm256_and_si256(low, high);
+    }
+#endif
+}
+
+namespace byte_scanner {
+    Isa best_isa() {
+        return supported_isas().back();
+    }
+
+    std::vector<Isa> supported_isas() {
+        std::vector isas{Isa::SCALAR};
+#ifdef BYTE_SCANNER_X86
+        const auto& features = get_cpu_features();
+        if(features.sse2) {
+            isas.push_back(Isa::SSE2);
+        }
+        if(features.avx2) {
+            isas.push_back(Isa::AVX2);
+        }
+#endif
+        return isas;
+    }
+
+    const char* to_string(const Isa isa) {
+        switch(isa) {
+        case Isa::SSE2:
+            return "SSE2";
+        case Isa::AVX2:
+            return "AVX2";
+        default:
+            return "scalar";
+        }
+    }
+
+    Signature Signature::literal(const std::string_view bytes) {
+        if(bytes.empty()) {
+            throw std::invalid_argument("Literal pattern must not be empty");
+        }
+
+        return {
+            std::vector<uint8_t>(bytes.begin(), bytes.end()),
+            std::vector<uint8_t>(bytes.size(), 0xFF),
+        };
+    }
+
+    Signature Signature::parse(const std::string_view signature) {
+        std::vector<uint8_t> bytes;
+        std::vector<uint8_t> mask;
+
+        size_t i = 0;
+        while(i < signature.size()) {
+            if(is_space(signature[i])) {
+                ++i;
+                continue;
+            }
+
+            auto end = i;
+            while(end < signature.size() && not is_space(signature[end])) {
+                ++end;
+            }
+            const auto token = signature.substr(i, end - i);
+            i = end;
+
+            if(token == "?" || token == "??") {
+                bytes.push_back(0);
+                mask.push_back(0);
+                continue;
+            }
+
+            const auto high = token.size() == 2 ? parse_hex_digit(token[0]) : -1;
+            const auto low = token.size() == 2 ? parse_hex_digit(token[1]) : -1;
+            if(high < 0 || low < 0) {
+                throw std::invalid_argument(
+                    "Invalid byte '" + std::string(token) + "' in signature '" + std::string(signature) + "'"
+                );
+            }
+
+            bytes.push_back(static_cast<uint8_t>(high << 4 | low));
+            mask.push_back(0xFF);
+        }
+
+        if(std::ranges::none_of(mask, [](const uint8_t m) { return m != 0; })) {
+            throw std::invalid_argument(
+                "Signature '" + std::string(signature) + "' must contain at least one non-wildcard byte"
+            );
+        }
+
+        return {std::move(bytes), std::move(mask)};
+    }
+
+    Signature::Signature(std::vector<uint8_t> bytes, std::vector<uint8_t> mask) :
+        bytes(std::move(bytes)), mask(std::move(mask)) {
+        const auto m = this->bytes.size();
+
+        // Compare the last fixed byte and the first fixed byte that differs from it,
+        // which filters out runs of repeated bytes such as padding
+        last_anchor = m - 1;
+        while(this->mask[last_anchor] == 0) {
+            --last_anchor;
+        }
+
+        const auto is_fixed = [&](const size_t j) { return this->mask[j] != 0; };
+        const auto is_distinct = [&](const size_t j) { return is_fixed(j) && this->bytes[j] != this->bytes[last_anchor]; };
+
+        first_anchor = 0;
+        while(first_anchor < last_anchor && not is_distinct(first_anchor)) {
+            ++first_anchor;
+        }
+        if(first_anchor == last_anchor) {
+            first_anchor = 0;
+            while(not is_fixed(first_anchor)) {
+                ++first_anchor;
+            }
+        }
+
+        // A wildcard matches every byte, so no shift may skip past it
+        size_t default_shift = m;
+        for(size_t j = 0; j + 1 < m; ++j) {
+            if(this->mask[j] == 0) {
+                default_shift = m - 1 - j;
+            }
+        }
+
+        shifts.fill(default_shift);
+        for(size_t j = 0; j + 1 < m; ++j) {
+            if(this->mask[j] != 0) {
+                auto& shift = shifts[this->bytes[j]];
+                shift = std::min(shift, m - 1 - j);
+            }
+        }
+    }
+
+    size_t Signature::size() const {
+        return bytes.size();
+    }
+
+    size_t Signature::wildcard_count() const {
+        return std::ranges::count(mask, 0);
+    }
+
+    bool Signature::matches_at(const uint8_t* const position) const {
+        for(size_t j = 0; j < bytes.size(); ++j) {
+            if((position[j] & mask[j]) != bytes[j]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool Signature::matches_at(const std::string_view haystack, const size_t offset) const {
+        if(offset > haystack.size() || haystack.size() - offset < bytes.size()) {
+            return false;
+        }
+
+        return matches_at(reinterpret_cast<const uint8_t*>(haystack.data()) + offset);
+    }
+
+    std::optional<size_t> Signature::find(const std::string_view haystack) const {
+        static const auto isa = best_isa();
+
+        return find(haystack, isa);
+    }
+
+    std::optional<size_t> Signature::find(const std::string_view haystack, const Isa isa) const {
+        const auto* const data = reinterpret_cast<const uint8_t*>(haystack.data());
+
+        if(haystack.size() < bytes.size()) {
+            return std::nullopt;
+        }
+
+        switch(isa) {
+        case Isa::AVX2:
+            return find_avx2(data, haystack.size());
+        case Isa::SSE2:
+            return find_sse2(data, haystack.size());
+        default:
+            return find_scalar(data, haystack.size());
+        }
+    }
+
+    std::optional<size_t> Signature::find_naive(const uint8_t* const data, size_t begin, const size_t size) const {
+        for(; begin + bytes.size() <= size; ++begin) {
+            if(matches_at(data + begin)) {
+                return begin;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<size_t> Signature::find_scalar(const uint8_t* const data, const size_t size) const {
+        const auto m = bytes.size();
+
+        size_t position = 0;
+        while(position + m <= size) {
+            if(matches_at(data + position)) {
+                return position;
+            }
+
+            position += shifts[data[position + m - 1]];
+        }
+
+        return std::nullopt;
+    }
+
+#ifdef BYTE_SCANNER_X86
+    BYTE_SCANNER_TARGET("sse2")
+    std::optional<size_t> Signature::find_sse2(const uint8_t* const data, const size_t size) const {
+        constexpr size_t WIDTH = 16;
+
+        const auto first = _mm_set1_epi8(static_cast<char>(bytes[first_anchor]));
+        const auto last = _mm_set1_epi8(static_cast<char>(bytes[last_anchor]));
+
+        // Every candidate in a block must leave room for the whole signature
+        size_t position = 0;
+        for(; position + bytes.size() + WIDTH - 1 <= size; position += WIDTH) {
+            const auto first_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position + first_anchor));
+            const auto last_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position + last_anchor));
+
+            auto candidates = static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(first_block, first), _mm_cmpeq_epi8(last_block, last))
+            ));
+
+            while(candidates != 0) {
+                const auto offset = position + std::countr_zero(candidates);
+                if(matches_at(data + offset)) {
+                    return offset;
+                }
+                candidates &= candidates - 1;
+            }
+        }
+
+        return find_naive(data, position, size);
+    }
+
+    BYTE_SCANNER_TARGET("avx2")
+    std::optional<size_t> Signature::find_avx2(const uint8_t* const data, const size_t size) const {
+        constexpr size_t WIDTH = 32;
+
+        const auto first = _mm256_set1_epi8(static_cast<char>(bytes[first_anchor]));
+        const auto last = _mm256_set1_epi8(static_cast<char>(bytes[last_anchor]));
+
+        size_t position = 0;
+        for(; position + bytes.size() + WIDTH - 1 <= size; position += WIDTH) {
+            const auto first_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position + first_anchor));
+            const auto last_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position + last_anchor));
+
+            auto candidates = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(first_block, first), _mm256_cmpeq_epi8(last_block, last))
+            ));
+
+            while(candidates != 0) {
+                const auto offset = position + std::countr_zero(candidates);
+                if(matches_at(data + offset)) {
+                    return offset;
+                }
+                candidates &= candidates - 1;
+            }
+        }
+
+        return find_naive(data, position, size);
+    }
+#else
+    std::optional<size_t> Signature::find_sse2(const uint8_t* const data, const size_t size) const {
+        return find_scalar(data, size);
+    }
+
+    std::optional<size_t> Signature::find_avx2(const uint8_t* const data, const size_t size) const {
+        return find_scalar(data, size);
+    }
+#endif
+}
+
+namespace byte_scanner {
+    SignatureSet::SignatureSet(std::vector<Signature> signatures) : signatures(std::move(signatures)) {
+        // The longest run of fixed bytes is the most selective key of a signature
+        for(const auto& signature : this->signatures) {
+            Key best;
+            Key current;
+            for(size_t j = 0; j < signature.size(); ++j) {
+                if(signature.mask[j] == 0) {
+                    current = {.offset = j + 1, .length = 0};
+                    continue;
+                }
+
+                if(++current.length > best.length) {
+                    best = current;
+                }
+            }
+            keys.push_back(best);
+        }
+
+        for(const auto& signature : this->signatures) {
+            max_signature_size = std::max(max_signature_size, signature.size());
+        }
+
+        repeated_signatures.assign(this->signatures.size(), NOT_REPEATED);
+        for(size_t i = 0; i < this->signatures.size(); ++i) {
+            const auto& signature = this->signatures[i];
+            for(size_t j = i; j-- > 0;) {
+                if(signature.bytes == this->signatures[j].bytes && signature.mask == this->signatures[j].mask) {
+                    repeated_signatures[i] = j;
+                    break;
+                }
+            }
+        }
+
+        for(size_t i = 0; i < keys.size(); ++i) {
+            const auto& signature = this->signatures[i];
+            for(size_t j = keys[i].offset; j < keys[i].offset + keys[i].length; ++j) {
+                if(byte_classes[signature.bytes[j]] == 0) {
+                    byte_classes[signature.bytes[j]] = static_cast<uint16_t>(class_count++);
+                }
+            }
+        }
+
+        // Build the trie of keys
+        constexpr auto ABSENT = UINT32_MAX;
+        transitions.assign(class_count, ABSENT);
+        std::vector<std::vector<uint32_t>> state_outputs(1);
+
+        for(size_t i = 0; i < keys.size(); ++i) {
+            const auto& signature = this->signatures[i];
+
+            auto state = ROOT_STATE;
+            for(size_t j = keys[i].offset; j < keys[i].offset + keys[i].length; ++j) {
+                const auto index = state * class_count + byte_classes[signature.bytes[j]];
+
+                if(transitions[index] == ABSENT) {
+                    transitions[index] = static_cast<uint32_t>(state_outputs.size());
+                    transitions.resize(transitions.size() + class_count, ABSENT);
+                    state_outputs.emplace_back();
+                }
+
+                state = transitions[index];
+            }
+            state_outputs[state].push_back(static_cast<uint32_t>(i));
+        }
+
+        // Turn the trie into a complete automaton in breadth-first order,
+        // so that failure states are always complete before they are used
+        const auto state_count = state_outputs.size();
+        std::vector<uint32_t> failures(state_count, ROOT_STATE);
+        std::vector<uint32_t> queue;
+        queue.reserve(state_count);
+
+        for(size_t c = 0; c < class_count; ++c) {
+            auto& next = transitions[c];
+            if(next == ABSENT) {
+                next = ROOT_STATE;
+            } else {
+                queue.push_back(next);
+            }
+        }
+
+        for(size_t head = 0; head < queue.size(); ++head) {
+            const auto state = queue[head];
+            const auto failure = failures[state];
+
+            state_outputs[state].insert(
+                state_outputs[state].end(), state_outputs[failure].begin(), state_outputs[failure].end()
+            );
+
+            for(size_t c = 0; c < class_count; ++c) {
+                auto& next = transitions[state * class_count + c];
+                const auto failure_next = transitions[failure * class_count + c];
+
+                if(next == ABSENT) {
+                    next = failure_next;
+                } else {
+                    failures[next] = failure_next;
+                    queue.push_back(next);
+                }
+            }
+        }
+
+        // Store the row offset of the next state rather than its index, flagging states with outputs
+        for(auto& next : transitions) {
+            next = static_cast<uint32_t>(next * class_count) | (state_outputs[next].empty() ? 0 : OUTPUT_FLAG);
+        }
+
+        // Every key is assigned to one of 8 buckets, and each of its first two bytes
+        // marks that bucket in the tables of its low and high nibble
+        for(size_t i = 0; i < keys.size(); ++i) {
+            const auto bucket = static_cast<uint8_t>(1 << (i % 8));
+            const auto* const key = this->signatures[i].bytes.data() + keys[i].offset;
+
+            first_low_nibbles[key[0] & 0xF] |= bucket;
+            first_high_nibbles[key[0] >> 4] |= bucket;
+
+            if(keys[i].length > 1) {
+                second_low_nibbles[key[1] & 0xF] |= bucket;
+                second_high_nibbles[key[1] >> 4] |= bucket;
+            } else {
+                for(size_t nibble = 0; nibble < 16; ++nibble) {
+                    second_low_nibbles[nibble] |= bucket;
+                    second_high_nibbles[nibble] |= bucket;
+                }
+            }
+        }
+
+        output_offsets.reserve(state_count + 1);
+        for(const auto& state_output : state_outputs) {
+            output_offsets.push_back(static_cast<uint32_t>(outputs.size()));
+            outputs.insert(outputs.end(), state_output.begin(), state_output.end());
+        }
+        output_offsets.push_back(static_cast<uint32_t>(outputs.size()));
+    }
+
+    size_t SignatureSet::size() const {
+        return signatures.size();
+    }
+
+    size_t SignatureSet::state_count() const {
+        return output_offsets.size() - 1;
+    }
+
+    std::vector<std::optional<size_t>> SignatureSet::find_all(const std::string_view haystack) const {
+        static const auto isa = best_isa();
+
+        return find_all(haystack, isa);
+    }
+
+    std::vector<std::optional<size_t>> SignatureSet::find_all(const std::string_view haystack, const Isa isa) const {
+        auto results = find_first_matches(haystack, isa);
+        find_repeated_matches(haystack, isa, results);
+
+        return results;
+    }
+
+    std::vector<std::optional<size_t>> SignatureSet::find_first_matches(
+        const std::string_view haystack,
+        const Isa isa
+    ) const {
+        std::vector<std::optional<size_t>> results(signatures.size());
+        auto remaining = signatures.size();
+
+        const auto* const data = reinterpret_cast<const uint8_t*>(haystack.data());
+        const auto size = haystack.size();
+
+        uint32_t row = ROOT_STATE;
+        for(size_t i = 0; i < size; ++i) {
+            // Most of the haystack leaves the automaton in the root state, which only a start byte can leave
+            if(row == ROOT_STATE && not may_start_key(data, i, size)) {
+                i = isa == Isa::AVX2 ? skip_to_start_avx2(data, i, size) : skip_to_start(data, i, size);
+                if(i == size) {
+                    break;
+                }
+            }
+
+            const auto next = transitions[row + byte_classes[data[i]]];
+            row = next & ~OUTPUT_FLAG;
+
+            if((next & OUTPUT_FLAG) == 0) {
+                continue;
+            }
+
+            const auto state = row / class_count;
+            for(auto k = output_offsets[state]; k < output_offsets[state + 1]; ++k) {
+                const auto id = outputs[k];
+                const auto& key = keys[id];
+                const auto& signature = signatures[id];
+
+                // Key ends at `i`, so the signature would start `key.offset` bytes before the key
+                const auto key_start = i + 1 - key.length;
+                if(results[id] || key_start < key.offset) {
+                    continue;
+                }
+
+                const auto start = key_start - key.offset;
+                if(start + signature.size() <= size && signature.matches_at(data + start)) {
+                    results[id] = start;
+
+                    if(--remaining == 0) {
+                        return results;
+                    }
+                }
+            }
+        }
+
+        return results;
+    }
+
+    std::vector<std::optional<size_t>> SignatureSet::find_all_parallel(
+        const std::string_view haystack,
+        const size_t thread_count,
+        const size_t chunk_size
+    ) const {
+        if(chunk_size == 0 || thread_count <= 1 || haystack.size() <= chunk_size) {
+            return find_all(haystack);
+        }
+
+        static const auto isa = best_isa();
+
+        const auto chunk_count = (haystack.size() + chunk_size - 1) / chunk_size;
+        const auto worker_count = std::min(thread_count, chunk_count);
+
+        constexpr auto NOT_FOUND = SIZE_MAX;
+        std::vector<std::atomic<size_t>> first_matches(signatures.size());
+        for(auto& first_match : first_matches) {
+            first_match = NOT_FOUND;
+        }
+
+        std::atomic<size_t> next_chunk = 0;
+
+        const auto work = [&] {
+            // Chunks are claimed in address order, so once every signature has a match
+            // before the start of a chunk, no later chunk can improve on it
+            for(auto chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++) {
+                const auto begin = chunk * chunk_size;
+
+                const auto all_found_before = std::ranges::all_of(first_matches, [&](const auto& first_match) {
+                    return first_match.load(std::memory_order_relaxed) < begin;
+                });
+                if(all_found_before) {
+                    return;
+                }
+
+                // Any match that starts within the chunk also ends within the overlap
+                const auto end = std::min(haystack.size(), begin + chunk_size + max_signature_size - 1);
+                const auto results = find_first_matches(haystack.substr(begin, end - begin), isa);
+
+                for(size_t i = 0; i < results.size(); ++i) {
+                    if(not results[i]) {
+                        continue;
+                    }
+
+                    const auto offset = begin + *results[i];
+                    auto current = first_matches[i].load(std::memory_order_relaxed);
+                    while(offset < current && not first_matches[i].compare_exchange_weak(current, offset)) {}
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(size_t index = 1; index < worker_count; ++index) {
+            threads.emplace_back(work);
+        }
+
+        work();
+
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        std::vector<std::optional<size_t>> results(signatures.size());
+        for(size_t i = 0; i < signatures.size(); ++i) {
+            if(const auto first_match = first_matches[i].load(); first_match != NOT_FOUND) {
+                results[i] = first_match;
+            }
+        }
+
+        find_repeated_matches(haystack, isa, results);
+
+        return results;
+    }
+
+    void SignatureSet::find_repeated_matches(
+        const std::string_view haystack,
+        const Isa isa,
+        std::vector<std::optional<size_t>>& results
+    ) const {
+        // Signatures are visited in order, so the previous identical signature is always resolved
+        for(size_t i = 0; i < signatures.size(); ++i) {
+            const auto previous = repeated_signatures[i];
+            if(previous == NOT_REPEATED) {
+                continue;
+            }
+
+            results[i].reset();
+            if(not results[previous]) {
+                continue;
+            }
+
+            const auto begin = *results[previous] + signatures[i].size();
+            if(const auto offset = signatures[i].find(haystack.substr(std::min(begin, haystack.size())), isa)) {
+                results[i] = begin + *offset;
+            }
+        }
+    }
+
+    bool SignatureSet::may_start_key(const uint8_t* const data, const size_t position, const size_t size) const {
+        const auto first = data[position];
+        auto buckets = first_low_nibbles[first & 0xF] & first_high_nibbles[first >> 4];
+
+        if(position + 1 < size) {
+            const auto second = data[position + 1];
+            buckets &= second_low_nibbles[second & 0xF] & second_high_nibbles[second >> 4];
+        }
+
+        return buckets != 0;
+    }
+
+    size_t SignatureSet::skip_to_start(const uint8_t* const data, size_t begin, const size_t size) const {
+        while(begin < size && not may_start_key(data, begin, size)) {
+            ++begin;
+        }
+
+        return begin;
+    }
+
+#ifdef BYTE_SCANNER_X86
+    /**
+     * Tests 32 positions at once against the nibble tables of the first two bytes of every key.
+     * Keys that share a bucket can combine into false positives, which are rejected by the automaton.
+     */
+    BYTE_SCANNER_TARGET("avx2")
+    size_t SignatureSet::skip_to_start_avx2(const uint8_t* const data, size_t begin, const size_t size) const {
+        constexpr size_t WIDTH = 32;
+
+        const auto first_low = load_table(first_low_nibbles);
+        const auto first_high = load_table(first_high_nibbles);
+        const auto second_low = load_table(second_low_nibbles);
+        const auto second_high = load_table(second_high_nibbles);
+        const auto zero = _mm256_setzero_si256();
+
+        // The second byte of the last position in a block must be readable
+        for(; begin + WIDTH + 1 <= size; begin += WIDTH) {
+            const auto first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + begin));
+            const auto second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + begin + 1));
+
+            const auto buckets = _mm256_and_si256(
+                lookup_nibbles(first, first_low, first_high), lookup_nibbles(second, second_low, second_high)
+            );
+            const auto misses = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(buckets, zero)));
+
+            if(misses != UINT32_MAX) {
+                return begin + std::countr_one(misses);
+            }
+        }
+
+        return skip_to_start(data, begin, size);
+    }
+#else
+    size_t SignatureSet::skip_to_start_avx2(const uint8_t* const data, const size_t begin, const size_t size) const {
+        return skip_to_start(data, begin, size);
+    }
+#endif
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/**
+ * Search for byte signatures in large memory regions, such as PE sections.
+ *
+ * A signature is a sequence of bytes where any position may be a wildcard.
+ * Candidates are located by comparing two anchor bytes of the signature
+ * against 16 (SSE2) or 32 (AVX2) positions of the haystack at once,
+ * and only candidates that pass this filter are verified byte by byte.
+ * On other architectures a Horspool search with a wildcard-aware
+ * skip table is used instead.
+ *
+ * Several signatures can be searched in a single pass with a `SignatureSet`.
+ */
+namespace byte_scanner {
+    enum class Isa {
+        SCALAR,
+        SSE2,
+        AVX2,
+    };
+
+    /**
+     * @return The most capable instruction set supported by the current CPU
+     */
+    Isa best_isa();
+
+    /**
+     * @return Every instruction set supported by the current CPU, starting with `SCALAR`
+     */
+    std::vector<Isa> supported_isas();
+
+    const char* to_string(Isa isa);
+
+    class Signature {
+    public:
+        /**
+         * Creates a signature that matches the exact bytes of the given string
+         *
+         * @throws std::invalid_argument if the string is empty
+         */
+        static Signature literal(std::string_view bytes);
+
+        /**
+         * Parses an IDA-style signature, such as `48 8B ?? ?? 05`.
+         * Bytes are pairs of hexadecimal digits separated by whitespace.
+         * Wildcards are written as `?` or `??`.
+         *
+         * @throws std::invalid_argument if the signature is malformed or consists only of wildcards
+         */
+        static Signature parse(std::string_view signature);
+
+        /**
+         * @return Offset of the first match, if any
+         */
+        [[nodiscard]] std::optional<size_t> find(std::string_view haystack) const;
+
+        /**
+         * Same as `find`, but with an explicit instruction set. The instruction set must be supported.
+         */
+        [[nodiscard]] std::optional<size_t> find(std::string_view haystack, Isa isa) const;
+
+        /**
+         * @return true if the signature matches the haystack at the given offset
+         */
+        [[nodiscard]] bool matches_at(std::string_view haystack, size_t offset) const;
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] size_t wildcard_count() const;
+
+    private:
+        friend class SignatureSet;
+
+        std::vector<uint8_t> bytes;
+        // 0xFF for bytes that must match, 0x00 for wildcards
+        std::vector<uint8_t> mask;
+        // Positions of the bytes compared by the vectorized filter
+        size_t first_anchor = 0;
+        size_t last_anchor = 0;
+        // Horspool shift for each byte value
+        std::array<size_t, 256> shifts{};
+
+        Signature(std::vector<uint8_t> bytes, std::vector<uint8_t> mask);
+
+        [[nodiscard]] bool matches_at(const uint8_t* position) const;
+
+        [[nodiscard]] std::optional<size_t> find_scalar(const uint8_t* data, size_t size) const;
+
+        [[nodiscard]] std::optional<size_t> find_sse2(const uint8_t* data, size_t size) const;
+
+        [[nodiscard]] std::optional<size_t> find_avx2(const uint8_t* data, size_t size) const;
+
+        [[nodiscard]] std::optional<size_t> find_naive(const uint8_t* data, size_t begin, size_t size) const;
+    };
+
+    /**
+     * Finds the first match of each of several signatures in a single pass over the haystack.
+     *
+     * The longest run of non-wildcard bytes of every signature is inserted into
+     * an Aho-Corasick automaton. Whenever the automaton reports such a run,
+     * the signature it belongs to is verified in full at the corresponding offset.
+     * While the automaton is in its root state, positions where no key can start are skipped
+     * 32 at a time with AVX2 if it is available, based on the first two bytes of every key.
+     * The scan stops as soon as every signature has been found.
+     *
+     * A signature that repeats an earlier signature of the set finds the first match
+     * after the match of the earlier one, without overlapping it. Hence repeated signatures
+     * resolve to successive matches, as if every match was overwritten before the next search.
+     */
+    class SignatureSet {
+    public:
+        explicit SignatureSet(std::vector<Signature> signatures);
+
+        /**
+         * @return Offset of the match of each signature, in the order the signatures were given
+         */
+        [[nodiscard]] std::vector<std::optional<size_t>> find_all(std::string_view haystack) const;
+
+        /**
+         * Same as `find_all`, but with an explicit instruction set. The instruction set must be supported.
+         */
+        [[nodiscard]] std::vector<std::optional<size_t>> find_all(std::string_view haystack, Isa isa) const;
+
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+        /**
+         * Splits the haystack into chunks that overlap by the length of the longest signature minus one,
+         * and scans them in address order on up to `thread_count` threads.
+         * The results are identical to those of `find_all`. Chunks that start after the first match
+         * of every signature has been found are skipped.
+         */
+        [[nodiscard]] std::vector<std::optional<size_t>> find_all_parallel(
+            std::string_view haystack,
+            size_t thread_count,
+            size_t chunk_size = DEFAULT_CHUNK_SIZE
+        ) const;
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] size_t state_count() const;
+
+    private:
+        static constexpr uint32_t ROOT_STATE = 0;
+        static constexpr uint32_t OUTPUT_FLAG = 1u << 31;
+        static constexpr size_t NOT_REPEATED = SIZE_MAX;
+
+        struct Key {
+            // Offset of the run within its signature
+            size_t offset = 0;
+            size_t length = 0;
+        };
+
+        std::vector<Signature> signatures;
+        std::vector<Key> keys;
+        size_t max_signature_size = 0;
+        // Index of the previous identical signature, or `NOT_REPEATED`
+        std::vector<size_t> repeated_signatures;
+
+        // Bytes that do not occur in any key share class 0
+        std::array<uint16_t, 256> byte_classes{};
+        size_t class_count = 1;
+        // Row offsets of next states, indexed by row offset of the current state plus byte class
+        std::vector<uint32_t> transitions;
+        // Signatures whose key ends in a given state, as ranges into `outputs`
+        std::vector<uint32_t> output_offsets;
+        std::vector<uint32_t> outputs;
+
+        // Nibble tables of the first two bytes of keys, in the style of the Teddy algorithm
+        std::array<uint8_t, 16> first_low_nibbles{};
+        std::array<uint8_t, 16> first_high_nibbles{};
+        std::array<uint8_t, 16> second_low_nibbles{};
+        std::array<uint8_t, 16> second_high_nibbles{};
+
+        /**
+         * @return Offset of the first match of each signature, including repeated ones
+         */
+        [[nodiscard]] std::vector<std::optional<size_t>> find_first_matches(std::string_view haystack, Isa isa) const;
+
+        /**
+         * Moves the matches of repeated signatures past the match of the previous identical signature
+         */
+        void find_repeated_matches(std::string_view haystack, Isa isa, std::vector<std::optional<size_t>>& results) const;
+
+        /**
+         * @return false if no key can start at the given position
+         */
+        [[nodiscard]] bool may_start_key(const uint8_t* data, size_t position, size_t size) const;
+
+        /**
+         * @return First position at or after `begin` where a key may start, or `size` if there is none
+         */
+        [[nodiscard]] size_t skip_to_start(const uint8_t* data, size_t begin, size_t size) const;
+
+        [[nodiscard]] size_t skip_to_start_avx2(const uint8_t* data, size_t begin, size_t size) const;
+    };
+}
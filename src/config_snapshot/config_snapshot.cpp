@@ -0,0 +1,159 @@
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "config_snapshot/config_snapshot.hpp"
+#include "utf8_path/utf8_path.hpp"
+
+namespace {
+    using namespace config_snapshot;
+
+    constexpr std::string_view MAGIC = "koaloader-config-snapshot";
+    constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * FNV-1a, which is enough to detect truncated or partially written snapshots
+     */
+    uint64_t checksum(const std::string_view data) {
+        uint64_t hash = 14695981039346656037ull;
+        for(const auto c : data) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+namespace config_snapshot {
+    void Writer::write_string(const std::string_view str) {
+        write<uint64_t>(str.size());
+        buffer.append(str);
+    }
+
+    const std::string& Writer::data() const {
+        return buffer;
+    }
+
+    Reader::Reader(const std::string_view data) : data(data) {}
+
+    std::string Reader::read_string() {
+        const auto size = read<uint64_t>();
+        if(size > remaining()) {
+            throw std::runtime_error("Truncated snapshot");
+        }
+
+        return {take(size), size};
+    }
+
+    size_t Reader::remaining() const {
+        return data.size();
+    }
+
+    const char* Reader::take(const size_t size) {
+        if(size > data.size()) {
+            throw std::runtime_error("Truncated snapshot");
+        }
+
+        const auto* const result = data.data();
+        data.remove_prefix(size);
+        return result;
+    }
+
+    std::optional<Stamp> get_stamp(const fs::path& path) {
+        std::error_code ec;
+
+        const auto size = fs::file_size(path, ec);
+        if(ec) {
+            return std::nullopt;
+        }
+
+        const auto modified = fs::last_write_time(path, ec);
+        if(ec) {
+            return std::nullopt;
+        }
+
+        return Stamp{.size = size, .modified = static_cast<int64_t>(modified.time_since_epoch().count())};
+    }
+
+    /**
+     * Layout:
+     *
+     * magic, format version, build id, source stamp, payload checksum, payload
+     */
+    std::optional<std::string> load(const fs::path& snapshot_path, const Stamp& source, const std::string_view build_id) {
+        std::ifstream file(snapshot_path, std::ios::binary);
+        if(not file) {
+            return std::nullopt;
+        }
+
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        const auto data = std::move(contents).str();
+
+        try {
+            Reader reader(data);
+
+            if(reader.read_string() != MAGIC || reader.read<uint32_t>() != FORMAT_VERSION) {
+                return std::nullopt;
+            }
+
+            if(reader.read_string() != build_id) {
+                return std::nullopt;
+            }
+
+            const Stamp stamp{.size = reader.read<uint64_t>(), .modified = reader.read<int64_t>()};
+            if(stamp != source) {
+                return std::nullopt;
+            }
+
+            const auto expected_checksum = reader.read<uint64_t>();
+            auto payload = reader.read_string();
+
+            if(checksum(payload) != expected_checksum) {
+                return std::nullopt;
+            }
+
+            return payload;
+        } catch(const std::runtime_error&) {
+            return std::nullopt;
+        }
+    }
+
+    void store(
+        const fs::path& snapshot_path,
+        const Stamp& source,
+        const std::string_view build_id,
+        const std::string_view payload
+    ) {
+        Writer writer;
+        writer.write_string(MAGIC);
+        writer.write(FORMAT_VERSION);
+        writer.write_string(build_id);
+        writer.write(source.size);
+        writer.write(source.modified);
+        writer.write(checksum(payload));
+        writer.write_string(payload);
+
+        auto temp_path = snapshot_path;
+        temp_path += ".";
+        temp_path += std::to_string(std::random_device()()) + ".tmp";
+
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            if(not file) {
+                throw std::runtime_error("Failed to open " + utf8_path::to_utf8(temp_path) + " for writing");
+            }
+
+            file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+            if(not file) {
+                throw std::runtime_error("Failed to write " + utf8_path::to_utf8(temp_path));
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(temp_path, snapshot_path, ec);
+        if(ec) {
+            fs::remove(temp_path, ec);
+            throw std::runtime_error("Failed to replace " + utf8_path::to_utf8(snapshot_path));
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Compiled snapshot of a JSON config file.
+ *
+ * The snapshot holds an opaque binary payload, such as a serialized config
+ * together with matchers compiled from it, and is valid as long as the config
+ * file keeps its size and modification time and the snapshot was written
+ * by the same build. Loading it is a single read and a checksum,
+ * which is much cheaper than parsing the JSON and compiling the matchers again.
+ */
+namespace config_snapshot {
+    namespace fs = std::filesystem;
+
+    /**
+     * Appends values in native byte order, since a snapshot never leaves the machine that wrote it
+     */
+    class Writer {
+    public:
+        template<typename T> requires std::is_trivially_copyable_v<T>
+        void write(const T value) {
+            buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void write_string(std::string_view str);
+
+        template<typename T> requires std::is_trivially_copyable_v<T>
+        void write_vector(const std::vector<T>& values) {
+            write<uint64_t>(values.size());
+            buffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+
+        [[nodiscard]] const std::string& data() const;
+
+    private:
+        std::string buffer;
+    };
+
+    /**
+     * Reads values written by `Writer` in the same order.
+     * All reads throw `std::runtime_error` if the data is truncated.
+     */
+    class Reader {
+    public:
+        explicit Reader(std::string_view data);
+
+        template<typename T> requires std::is_trivially_copyable_v<T>
+        T read() {
+            T value;
+            std::memcpy(&value, take(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        std::string read_string();
+
+        template<typename T> requires std::is_trivially_copyable_v<T>
+        std::vector<T> read_vector() {
+            const auto count = read<uint64_t>();
+            if(count > remaining() / sizeof(T)) {
+                throw std::runtime_error("Truncated snapshot");
+            }
+
+            std::vector<T> values(count);
+            std::memcpy(values.data(), take(count * sizeof(T)), count * sizeof(T));
+            return values;
+        }
+
+        [[nodiscard]] size_t remaining() const;
+
+    private:
+        std::string_view data;
+
+        const char* take(size_t size);
+    };
+
+    /**
+     * Size and modification time of the source file
+     */
+    struct Stamp {
+        uint64_t size = 0;
+        int64_t modified = 0;
+
+        bool operator==(const Stamp&) const = default;
+    };
+
+    /**
+     * Should be taken before the source file is read, so that a change made while reading it
+     * leaves the snapshot outdated rather than silently stale.
+     *
+     * @return Stamp of the file, or nothing if it is inaccessible
+     */
+    std::optional<Stamp> get_stamp(const fs::path& path);
+
+    /**
+     * Corrupted, outdated or missing snapshots are treated as absent.
+     *
+     * @param build_id Identifies the layout of the payload, such as the version and build time
+     * @return Payload of the snapshot if it was made from a source with the given stamp by the same build
+     */
+    std::optional<std::string> load(const fs::path& snapshot_path, const Stamp& source, std::string_view build_id);
+
+    /**
+     * The snapshot is written to a temporary file first and then renamed over the previous one,
+     * since several processes that load Koaloader at the same time may write it concurrently.
+     *
+     * @throws std::runtime_error if the snapshot cannot be written
+     */
+    void store(
+        const fs::path& snapshot_path,
+        const Stamp& source,
+        std::string_view build_id,
+        std::string_view payload
+    );
+}
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "directory_walker/directory_walker.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+    using namespace directory_walker;
+
+    // How many entries are scanned between deadline checks within a single directory
+    constexpr size_t DEADLINE_CHECK_INTERVAL = 256;
+
+    struct Task {
+        fs::path directory;
+        int depth = 0;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    class Walker {
+    public:
+        Walker(const Predicate& predicate, const Options& options) :
+            predicate(predicate), options(options), queues(std::max<size_t>(options.thread_count, 1)) {}
+
+        Result run(const fs::path& root) {
+            push(0, {root, 0});
+
+            std::vector<std::thread> threads;
+            for(size_t index = 1; index < queues.size(); ++index) {
+                threads.emplace_back([this, index] { work(index); });
+            }
+
+            work(0);
+
+            for(auto& thread : threads) {
+                thread.join();
+            }
+
+            return {
+                .path = result,
+                .directories_visited = directories_visited,
+                .files_visited = files_visited,
+                .directories_excluded = directories_excluded,
+                .directories_beyond_max_depth = directories_beyond_max_depth,
+                .deadline_exceeded = deadline_exceeded,
+                .listed_directories = std::move(listed_directories),
+            };
+        }
+
+    private:
+        const Predicate& predicate;
+        const Options& options;
+        std::vector<WorkQueue> queues;
+
+        // Directories that were queued but not yet fully processed
+        std::atomic<size_t> pending = 0;
+        std::atomic<bool> stopped = false;
+
+        std::mutex idle_mutex;
+        std::condition_variable idle_condition;
+
+        std::mutex result_mutex;
+        std::optional<fs::path> result;
+
+        std::atomic<size_t> directories_visited = 0;
+        std::atomic<size_t> files_visited = 0;
+        std::atomic<size_t> directories_excluded = 0;
+        std::atomic<size_t> directories_beyond_max_depth = 0;
+        std::atomic<bool> deadline_exceeded = false;
+
+        std::mutex listed_directories_mutex;
+        std::vector<fs::path> listed_directories;
+
+        void push(const size_t index, Task task) {
+            pending.fetch_add(1, std::memory_order_relaxed);
+            {
+                const std::lock_guard lock(queues[index].mutex);
+                queues[index].tasks.push_back(std::move(task));
+            }
+            idle_condition.notify_one();
+        }
+
+        std::optional<Task> pop(const size_t index) {
+            // Own queue is processed from the back
+            {
+                auto& queue = queues[index];
+                const std::lock_guard lock(queue.mutex);
+                if(not queue.tasks.empty()) {
+                    auto task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                    return task;
+                }
+            }
+
+            // Steal from the front of other queues
+            for(size_t offset = 1; offset < queues.size(); ++offset) {
+                auto& queue = queues[(index + offset) % queues.size()];
+                const std::lock_guard lock(queue.mutex);
+                if(not queue.tasks.empty()) {
+                    auto task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    return task;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        void finish_one() {
+            if(pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                idle_condition.notify_all();
+            }
+        }
+
+        void stop() {
+            stopped = true;
+            idle_condition.notify_all();
+        }
+
+        void stop(const fs::path& path) {
+            {
+                const std::lock_guard lock(result_mutex);
+                if(not result) {
+                    result = path;
+                }
+            }
+            stop();
+        }
+
+        bool check_deadline() {
+            if(options.deadline && std::chrono::steady_clock::now() > *options.deadline) {
+                deadline_exceeded = true;
+                stop();
+                return false;
+            }
+            return true;
+        }
+
+        void work(const size_t index) {
+            while(not stopped) {
+                if(auto task = pop(index)) {
+                    if(check_deadline()) {
+                        scan(index, *task);
+                    }
+                    finish_one();
+                    continue;
+                }
+
+                if(pending.load(std::memory_order_acquire) == 0) {
+                    break;
+                }
+
+                // Another worker is still scanning and may produce more directories
+                std::unique_lock lock(idle_mutex);
+                idle_condition.wait_for(lock, std::chrono::milliseconds(1));
+            }
+
+            idle_condition.notify_all();
+        }
+
+        void scan(const size_t index, const Task& task) {
+            ++directories_visited;
+
+            // Counted locally to keep workers from contending on shared counters for every entry
+            size_t files = 0;
+            size_t excluded = 0;
+            size_t beyond_max_depth = 0;
+
+            if(scan_entries(index, task, files, excluded, beyond_max_depth) && options.collect_listed_directories) {
+                const std::lock_guard lock(listed_directories_mutex);
+                listed_directories.push_back(task.directory);
+            }
+
+            files_visited += files;
+            directories_excluded += excluded;
+            directories_beyond_max_depth += beyond_max_depth;
+        }
+
+        /**
+         * @return false if the scan stopped before the end of the listing
+         */
+        bool scan_entries(const size_t index, const Task& task, size_t& files, size_t& excluded, size_t& beyond_max_depth) {
+            std::error_code ec;
+            const auto follow_symlinks = (options.directory_options & fs::directory_options::follow_directory_symlink) !=
+                                         fs::directory_options::none;
+
+            size_t scanned = 0;
+            for(fs::directory_iterator it(task.directory, options.directory_options, ec), end;
+                not ec && it != end;
+                it.increment(ec)) {
+                if(stopped || (++scanned % DEADLINE_CHECK_INTERVAL == 0 && not check_deadline())) {
+                    return false;
+                }
+
+                const auto& entry = *it;
+
+                std::error_code status_ec;
+                if(entry.is_directory(status_ec)) {
+                    if(not follow_symlinks && entry.is_symlink(status_ec)) {
+                        continue;
+                    }
+
+                    if(options.max_depth >= 0 && task.depth >= options.max_depth) {
+                        ++beyond_max_depth;
+                    } else if(options.is_excluded && options.is_excluded(entry)) {
+                        ++excluded;
+                    } else {
+                        push(index, {entry.path(), task.depth + 1});
+                    }
+                    continue;
+                }
+
+                ++files;
+
+                if(predicate(entry)) {
+                    stop(entry.path());
+                    return false;
+                }
+            }
+
+            return not ec;
+        }
+    };
+}
+
+namespace directory_walker {
+    Result find_first(const fs::path& root, const Predicate& predicate, const Options& options) {
+        return Walker(predicate, options).run(root);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <vector>
+
+/**
+ * Parallel recursive directory search.
+ *
+ * Every directory is a task on a small work-stealing pool: workers pop their own
+ * most recently discovered directories first (depth-first, cache friendly) and steal
+ * the oldest directories from other workers when idle. The calling thread is
+ * always one of the workers, so a thread count of 1 performs the whole search inline
+ * without creating any threads. All workers stop as soon as a match is found.
+ */
+namespace directory_walker {
+    using Predicate = std::function<bool(const std::filesystem::directory_entry& entry)>;
+
+    struct Options {
+        // Total number of workers, including the calling thread
+        size_t thread_count = 1;
+        std::filesystem::directory_options directory_options = std::filesystem::directory_options::skip_permission_denied;
+        // Subdirectories deeper than this are not entered. The root has depth 0. Negative means unlimited.
+        int max_depth = -1;
+        // Invoked for every subdirectory, possibly from several threads at once. Excluded ones are not entered.
+        Predicate is_excluded{};
+        // The search gives up once this point in time has passed
+        std::optional<std::chrono::steady_clock::time_point> deadline{};
+        // Fills `Result::listed_directories`
+        bool collect_listed_directories = false;
+    };
+
+    struct Result {
+        std::optional<std::filesystem::path> path;
+        size_t directories_visited = 0;
+        size_t files_visited = 0;
+        size_t directories_excluded = 0;
+        size_t directories_beyond_max_depth = 0;
+        bool deadline_exceeded = false;
+        // Directories whose listing was scanned to the end, if `Options::collect_listed_directories` is set
+        std::vector<std::filesystem::path> listed_directories;
+    };
+
+    /**
+     * Errors from individual directories are ignored, like with
+     * `std::filesystem::directory_options::skip_permission_denied`.
+     *
+     * @param predicate Invoked for every non-directory entry, possibly from several threads at once.
+     * @return The first file for which the predicate returned true, if any. When several files match,
+     *         which one is found first depends on scheduling.
+     */
+    Result find_first(const std::filesystem::path& root, const Predicate& predicate, const Options& options);
+}
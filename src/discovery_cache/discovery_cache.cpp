@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "discovery_cache/discovery_cache.hpp"
+#include "utf8_path/utf8_path.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+    using namespace discovery_cache;
+
+    // Version 2 added entries without a module, version 3 the search limits of the key
+    constexpr auto HEADER = "koaloader-discovery-cache 3";
+
+    struct Stamp {
+        fs::path path;
+        uintmax_t size = 0;
+        int64_t modified = 0;
+
+        bool operator==(const Stamp&) const = default;
+    };
+
+    struct Record {
+        Entry entry;
+        std::vector<Stamp> stamps{};
+    };
+
+    bool same_path(const fs::path& a, const fs::path& b) {
+        return a.lexically_normal() == b.lexically_normal();
+    }
+
+    bool same_key(const Key& a, const Key& b) {
+        return same_path(a.executable_path, b.executable_path) &&
+               same_path(a.koaloader_directory, b.koaloader_directory) &&
+               same_path(a.starting_directory, b.starting_directory) &&
+               a.max_depth == b.max_depth &&
+               a.excluded_directories == b.excluded_directories &&
+               a.time_limit_ms == b.time_limit_ms;
+    }
+
+    /**
+     * @return Current state of a file or directory, or nothing if it cannot be accessed
+     */
+    std::optional<Stamp> make_stamp(const fs::path& path) {
+        std::error_code ec;
+
+        const auto status = fs::status(path, ec);
+        if(ec) {
+            return std::nullopt;
+        }
+
+        Stamp stamp{.path = path};
+
+        if(fs::is_regular_file(status)) {
+            stamp.size = fs::file_size(path, ec);
+            if(ec) {
+                return std::nullopt;
+            }
+        }
+
+        const auto modified = fs::last_write_time(path, ec);
+        if(ec) {
+            return std::nullopt;
+        }
+        stamp.modified = modified.time_since_epoch().count();
+
+        return stamp;
+    }
+
+    /**
+     * Line-based format, one field per line. Paths run to the end of the line.
+     *
+     * entry
+     * executable <path>
+     * koaloader <path>
+     * start <path>
+     * max_depth <depth>
+     * exclude <pattern> (once per excluded directory pattern)
+     * time_limit_ms <milliseconds>
+     * module <path> (only if a module was found)
+     * scan_ms <milliseconds>
+     * stamp <size> <modified> <path>
+     * end
+     */
+    std::vector<Record> read_records(const fs::path& cache_path) {
+        std::ifstream file(cache_path);
+        std::string line;
+
+        if(not std::getline(file, line) || line != HEADER) {
+            return {};
+        }
+
+        std::vector<Record> records;
+        std::optional<Record> current;
+
+        while(std::getline(file, line)) {
+            if(not line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+
+            const auto separator = line.find(' ');
+            const auto field = line.substr(0, separator);
+            const auto value = separator == std::string::npos ? std::string() : line.substr(separator + 1);
+
+            if(field == "entry") {
+                current.emplace();
+            } else if(not current) {
+                return {};
+            } else if(field == "executable") {
+                current->entry.key.executable_path = utf8_path::from_utf8(value);
+            } else if(field == "koaloader") {
+                current->entry.key.koaloader_directory = utf8_path::from_utf8(value);
+            } else if(field == "start") {
+                current->entry.key.starting_directory = utf8_path::from_utf8(value);
+            } else if(field == "max_depth") {
+                current->entry.key.max_depth = std::stoi(value);
+            } else if(field == "exclude") {
+                current->entry.key.excluded_directories.push_back(value);
+            } else if(field == "time_limit_ms") {
+                current->entry.key.time_limit_ms = static_cast<uint32_t>(std::stoul(value));
+            } else if(field == "module") {
+                current->entry.module_path = utf8_path::from_utf8(value);
+            } else if(field == "scan_ms") {
+                current->entry.scan_duration = std::chrono::milliseconds(std::stoll(value));
+            } else if(field == "stamp") {
+                std::istringstream stream(value);
+                Stamp stamp;
+                stream >> stamp.size >> stamp.modified;
+                stream.get();
+
+                std::string path;
+                std::getline(stream, path);
+                if(stream.fail() || path.empty()) {
+                    return {};
+                }
+
+                stamp.path = utf8_path::from_utf8(path);
+                current->entry.dependencies.push_back(stamp.path);
+                current->stamps.push_back(std::move(stamp));
+            } else if(field == "end") {
+                records.push_back(std::move(*current));
+                current.reset();
+            } else {
+                return {};
+            }
+        }
+
+        return records;
+    }
+
+    std::vector<Record> try_read_records(const fs::path& cache_path) {
+        try {
+            return read_records(cache_path);
+        } catch(const std::exception&) {
+            // Corrupted numbers are treated like a missing cache
+            return {};
+        }
+    }
+
+    bool is_valid(const Record& record) {
+        if(record.stamps.empty()) {
+            return false;
+        }
+
+        return std::ranges::all_of(record.stamps, [](const Stamp& stamp) {
+            return make_stamp(stamp.path) == stamp;
+        });
+    }
+}
+
+namespace discovery_cache {
+    std::optional<Entry> lookup(const fs::path& cache_path, const Key& key) {
+        for(auto& record : try_read_records(cache_path)) {
+            if(same_key(record.entry.key, key)) {
+                return is_valid(record) ? std::optional(std::move(record.entry)) : std::nullopt;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void store(const fs::path& cache_path, const Entry& entry) {
+        auto records = try_read_records(cache_path);
+        std::erase_if(records, [&](const Record& record) { return same_key(record.entry.key, entry.key); });
+
+        // The file is rewritten in place, which unlike creating or renaming it leaves the directory untouched
+        std::fstream file(cache_path, std::ios::in | std::ios::out | std::ios::app);
+        if(not file) {
+            throw std::runtime_error("Failed to open " + utf8_path::to_utf8(cache_path) + " for writing");
+        }
+        file.close();
+
+        Record record{.entry = entry};
+        for(const auto& dependency : entry.dependencies) {
+            const auto stamp = make_stamp(dependency);
+            if(not stamp) {
+                throw std::runtime_error("Failed to access " + utf8_path::to_utf8(dependency));
+            }
+            record.stamps.push_back(*stamp);
+        }
+        records.push_back(std::move(record));
+
+        file.open(cache_path, std::ios::out | std::ios::trunc);
+        file << HEADER << '\n';
+
+        for(const auto& [cached, stamps] : records) {
+            file << "entry\n"
+                 << "executable " << utf8_path::to_utf8(cached.key.executable_path) << '\n'
+                 << "koaloader " << utf8_path::to_utf8(cached.key.koaloader_directory) << '\n'
+                 << "start " << utf8_path::to_utf8(cached.key.starting_directory) << '\n'
+                 << "max_depth " << cached.key.max_depth << '\n';
+
+            for(const auto& pattern : cached.key.excluded_directories) {
+                file << "exclude " << pattern << '\n';
+            }
+
+            file << "time_limit_ms " << cached.key.time_limit_ms << '\n';
+
+            if(cached.module_path) {
+                file << "module " << utf8_path::to_utf8(*cached.module_path) << '\n';
+            }
+
+            file << "scan_ms " << cached.scan_duration.count() << '\n';
+
+            for(const auto& stamp : stamps) {
+                file << "stamp " << stamp.size << ' ' << stamp.modified << ' ' << utf8_path::to_utf8(stamp.path) << '\n';
+            }
+
+            file << "end\n";
+        }
+
+        if(not file.flush()) {
+            throw std::runtime_error("Failed to write " + utf8_path::to_utf8(cache_path));
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Persistent cache of auto_load discovery results.
+ *
+ * Each entry remembers which well-known module a search starting in a given
+ * directory resolved to for a given executable, if any, together with validity stamps
+ * (size and modification time) of the module itself and of every directory whose
+ * listing took priority over it. An entry without a module depends on every directory
+ * that the search listed instead. A lookup only has to stat those paths,
+ * instead of repeating the recursive search.
+ */
+namespace discovery_cache {
+    namespace fs = std::filesystem;
+
+    struct Key {
+        fs::path executable_path;
+        fs::path koaloader_directory;
+        fs::path starting_directory;
+        // Settings that limit the search in subdirectories
+        int max_depth = -1;
+        std::vector<std::string> excluded_directories{};
+        uint32_t time_limit_ms = 0;
+    };
+
+    struct Entry {
+        Key key;
+        // Nothing if the search did not find any module
+        std::optional<fs::path> module_path;
+        // Files and directories whose state determines the search result, including the module
+        std::vector<fs::path> dependencies;
+        // Duration of the full search that produced this entry
+        std::chrono::milliseconds scan_duration{};
+    };
+
+    /**
+     * Corrupted or missing cache files are treated as empty.
+     *
+     * @return The cached entry if it matches the key and none of its dependencies have changed
+     */
+    std::optional<Entry> lookup(const fs::path& cache_path, const Key& key);
+
+    /**
+     * Replaces any previous entry with the same key.
+     * Dependencies are stamped only after the cache file exists, since creating it
+     * modifies its directory, which is usually one of the dependencies.
+     *
+     * @throws std::runtime_error if the cache file cannot be written or a dependency is inaccessible
+     */
+    void store(const fs::path& cache_path, const Entry& entry);
+}
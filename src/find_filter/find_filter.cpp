@@ -0,0 +1,70 @@
+#include "find_filter/find_filter.hpp"
+
+namespace find_filter {
+    Enumeration::Enumeration(Source& source, const hide_matcher::Matcher& matcher) :
+        source(source), matcher(matcher) {}
+
+    State Enumeration::first() {
+        started_by_first = true;
+        current_state = State::EXAMINING;
+        return run();
+    }
+
+    State Enumeration::next() {
+        if(current_state == State::END || current_state == State::FAILED) {
+            return current_state;
+        }
+
+        advance();
+        return run();
+    }
+
+    State Enumeration::state() const {
+        return current_state;
+    }
+
+    size_t Enumeration::hidden() const {
+        return hidden_count;
+    }
+
+    uint32_t Enumeration::last_error() const {
+        switch(current_state) {
+        case State::END:
+            return started_by_first ? FILE_NOT_FOUND : NO_MORE_FILES;
+        case State::FAILED:
+            return source.error();
+        default:
+            return 0;
+        }
+    }
+
+    State Enumeration::run() {
+        while(current_state == State::EXAMINING) {
+            const auto hidden = hide_matcher::is_file_hidden(matcher, source.name());
+            source.examined(hidden);
+
+            if(hidden) {
+                hidden_count++;
+                advance();
+            } else {
+                current_state = State::FOUND;
+            }
+        }
+
+        return current_state;
+    }
+
+    void Enumeration::advance() {
+        switch(source.next()) {
+        case Advance::ENTRY:
+            current_state = State::EXAMINING;
+            break;
+        case Advance::END:
+            current_state = State::END;
+            break;
+        case Advance::FAILURE:
+            current_state = State::FAILED;
+            break;
+        }
+    }
+}
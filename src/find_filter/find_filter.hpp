@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "hide_matcher/hide_matcher.hpp"
+
+/**
+ * Filtering of directory enumerations for the `FindFirstFile` and `FindNextFile` hooks.
+ *
+ * Hidden entries are skipped by advancing the same find handle with the original
+ * `FindNextFileW`, so that a directory is opened exactly once and every entry is read
+ * exactly once, no matter how many of them are hidden. The find handle keeps the position
+ * of the enumeration between calls, so each hook call runs the state machine of `Enumeration`
+ * from the entry that the original function has just returned until a visible entry,
+ * the end of the directory, or an error.
+ */
+namespace find_filter {
+    /**
+     * Win32 error codes that the find functions report once an enumeration ends
+     */
+    constexpr uint32_t FILE_NOT_FOUND = 2;
+    constexpr uint32_t NO_MORE_FILES = 18;
+
+    /**
+     * Result of the original function after advancing a find handle
+     */
+    enum class Advance {
+        ENTRY,
+        // The original function reported that there are no more files
+        END,
+        // The original function failed for another reason, which is kept as the last error
+        FAILURE,
+    };
+
+    /**
+     * Entries of a single find handle, such as a handle opened by the original `FindFirstFileW`
+     */
+    class Source {
+    public:
+        virtual ~Source() = default;
+
+        /**
+         * Advances the handle to the next entry, like the original `FindNextFileW`
+         */
+        virtual Advance next() = 0;
+
+        /**
+         * @return Name of the entry that the handle is positioned at
+         */
+        [[nodiscard]] virtual std::u16string_view name() const = 0;
+
+        /**
+         * @return Last error of the original function, after `next` returned `Advance::FAILURE`
+         */
+        [[nodiscard]] virtual uint32_t error() const = 0;
+
+        /**
+         * Called for every entry that the enumeration examines, for logging and tracing
+         */
+        virtual void examined([[maybe_unused]] bool hidden) {}
+    };
+
+    enum class State {
+        // The current entry has not been matched yet
+        EXAMINING,
+        // The current entry is visible and can be returned to the caller
+        FOUND,
+        // All remaining entries are hidden. `FindFirstFile` must also close the handle.
+        END,
+        // The source failed
+        FAILED,
+    };
+
+    class Enumeration {
+    public:
+        Enumeration(Source& source, const hide_matcher::Matcher& matcher);
+
+        /**
+         * Starts from the entry returned by the original `FindFirstFileW`
+         */
+        State first();
+
+        /**
+         * Advances past the entry that was last returned to the caller
+         */
+        State next();
+
+        [[nodiscard]] State state() const;
+
+        /**
+         * @return Number of entries skipped because they are hidden
+         */
+        [[nodiscard]] size_t hidden() const;
+
+        /**
+         * @return Error that the hook must set after `END` or `FAILED`: `ERROR_FILE_NOT_FOUND`
+         * at the end of `first`, `ERROR_NO_MORE_FILES` at the end of `next`, or the error of the source
+         */
+        [[nodiscard]] uint32_t last_error() const;
+
+    private:
+        Source& source;
+        const hide_matcher::Matcher& matcher;
+        State current_state = State::EXAMINING;
+        size_t hidden_count = 0;
+        bool started_by_first = false;
+
+        State run();
+
+        void advance();
+    };
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <bit>
+
+#include "handle_table/handle_table.hpp"
+
+namespace handle_table {
+    HandleTable::HandleTable(const size_t capacity) :
+        slots(std::make_unique<std::atomic<uintptr_t>[]>(std::bit_ceil(std::max<size_t>(capacity, 2)))),
+        mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+        shift(64 - std::countr_zero(mask + 1)) {}
+
+    size_t HandleTable::home_slot(const uintptr_t handle) const {
+        // Fibonacci hashing spreads handle values, which are typically multiples of 4
+        return static_cast<size_t>(static_cast<uint64_t>(handle) * 0x9E3779B97F4A7C15ULL >> shift) & mask;
+    }
+
+    bool HandleTable::insert(const uintptr_t handle) {
+        if(handle == EMPTY || handle == TOMBSTONE) {
+            return false;
+        }
+
+        const auto home = home_slot(handle);
+
+        for(size_t probe = 0; probe <= mask; ++probe) {
+            auto& slot = slots[(home + probe) & mask];
+            auto current = slot.load(std::memory_order_relaxed);
+
+            if(current != EMPTY && current != TOMBSTONE) {
+                continue;
+            }
+
+            // Publish the probe distance before the key so that lookups never stop short of it
+            auto observed_max = max_probe.load(std::memory_order_relaxed);
+            while(observed_max < probe && not max_probe.compare_exchange_weak(observed_max, probe)) {}
+
+            if(slot.compare_exchange_strong(current, handle, std::memory_order_release)) {
+                count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool HandleTable::contains(const uintptr_t handle) const {
+        if(handle == EMPTY || handle == TOMBSTONE) {
+            return false;
+        }
+
+        const auto home = home_slot(handle);
+        const auto limit = max_probe.load(std::memory_order_acquire);
+
+        for(size_t probe = 0; probe <= limit; ++probe) {
+            const auto current = slots[(home + probe) & mask].load(std::memory_order_acquire);
+
+            if(current == handle) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool HandleTable::erase(const uintptr_t handle) {
+        if(handle == EMPTY || handle == TOMBSTONE) {
+            return false;
+        }
+
+        const auto home = home_slot(handle);
+        const auto limit = max_probe.load(std::memory_order_acquire);
+
+        for(size_t probe = 0; probe <= limit; ++probe) {
+            auto& slot = slots[(home + probe) & mask];
+            auto expected = handle;
+
+            if(slot.compare_exchange_strong(expected, TOMBSTONE, std::memory_order_acq_rel)) {
+                count.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    size_t HandleTable::capacity() const {
+        return mask + 1;
+    }
+
+    size_t HandleTable::size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    HandleSet::HandleSet(const size_t capacity) : table(capacity) {}
+
+    bool HandleSet::insert(const uintptr_t handle) {
+        if(table.insert(handle)) {
+            return true;
+        }
+
+        const std::lock_guard lock(overflow_mutex);
+        if(overflow.insert(handle).second) {
+            overflow_count.fetch_add(1, std::memory_order_release);
+        }
+        return false;
+    }
+
+    bool HandleSet::contains(const uintptr_t handle) const {
+        if(table.contains(handle)) {
+            return true;
+        }
+
+        if(overflow_count.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+
+        const std::lock_guard lock(overflow_mutex);
+        return overflow.contains(handle);
+    }
+
+    bool HandleSet::erase(const uintptr_t handle) {
+        if(table.erase(handle)) {
+            return true;
+        }
+
+        if(overflow_count.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+
+        const std::lock_guard lock(overflow_mutex);
+        if(overflow.erase(handle) == 0) {
+            return false;
+        }
+
+        overflow_count.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    size_t HandleSet::overflow_size() const {
+        return overflow_count.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+/**
+ * Fixed-capacity concurrent set of OS handles.
+ *
+ * Open addressing with linear probing over preallocated atomic slots.
+ * All operations are lock-free. Removed entries leave tombstones that are
+ * reused by later insertions, while lookups are bounded by the largest probe
+ * distance ever used by an insertion rather than by the number of tombstones.
+ * Keys must be unique among live entries, which holds for OS handles
+ * as long as an entry is removed before the handle is closed.
+ */
+namespace handle_table {
+    class HandleTable {
+    public:
+        /**
+         * @param capacity Number of slots. Rounded up to a power of two.
+         */
+        explicit HandleTable(size_t capacity);
+
+        /**
+         * @return false if the table is full
+         */
+        bool insert(uintptr_t handle);
+
+        [[nodiscard]] bool contains(uintptr_t handle) const;
+
+        /**
+         * @return false if the handle was not present
+         */
+        bool erase(uintptr_t handle);
+
+        [[nodiscard]] size_t capacity() const;
+
+        /**
+         * Approximate under concurrent modification
+         */
+        [[nodiscard]] size_t size() const;
+
+    private:
+        static constexpr uintptr_t EMPTY = 0;
+        static constexpr uintptr_t TOMBSTONE = UINTPTR_MAX;
+
+        std::unique_ptr<std::atomic<uintptr_t>[]> slots;
+        size_t mask;
+        int shift;
+        std::atomic<size_t> max_probe = 0;
+        std::atomic<size_t> count = 0;
+
+        [[nodiscard]] size_t home_slot(uintptr_t handle) const;
+    };
+
+    /**
+     * `HandleTable` that never rejects a handle. Handles that do not fit
+     * into the table go to a mutex-protected overflow set, which lookups
+     * only consult while it holds any handles.
+     */
+    class HandleSet {
+    public:
+        /**
+         * @param capacity Number of slots of the lock-free table
+         */
+        explicit HandleSet(size_t capacity);
+
+        /**
+         * @return false if the handle was stored in the overflow set
+         */
+        bool insert(uintptr_t handle);
+
+        [[nodiscard]] bool contains(uintptr_t handle) const;
+
+        /**
+         * @return false if the handle was not present
+         */
+        bool erase(uintptr_t handle);
+
+        /**
+         * Approximate under concurrent modification
+         */
+        [[nodiscard]] size_t overflow_size() const;
+
+    private:
+        HandleTable table;
+
+        mutable std::mutex overflow_mutex;
+        std::unordered_set<uintptr_t> overflow;
+        std::atomic<size_t> overflow_count = 0;
+    };
+}
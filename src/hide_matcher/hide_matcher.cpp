@@ -0,0 +1,1136 @@
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <stdexcept>
+
+#include "hide_matcher/hide_matcher.hpp"
+
+namespace {
+    constexpr uint32_t MAX_UNIT = 0xFFFF;
+    constexpr uint32_t UNBOUNDED = UINT32_MAX;
+    constexpr size_t MAX_NFA_STATES = 20'000;
+    constexpr size_t MAX_DFA_STATES = 4'096;
+
+    /**
+     * Thrown when a pattern uses a feature that the DFA cannot express.
+     * Such patterns are delegated to `std::regex`.
+     */
+    struct Unsupported final : std::exception {};
+
+    /**
+     * Thrown when subset construction exceeds `MAX_DFA_STATES`.
+     */
+    struct TooManyStates final : std::exception {};
+
+    // Inclusive ranges of UTF-16 code units
+    using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;
+
+    uint32_t fold_case(const uint32_t unit) {
+        return unit >= 'A' && unit <= 'Z' ? unit + ('a' - 'A') : unit;
+    }
+
+    /**
+     * Decodes UTF-8 into UTF-16 code units one unit at a time. Invalid bytes are passed
+     * through as-is, which keeps the behaviour sane for ANSI strings coming from the `A` APIs.
+     */
+    class Utf8Cursor {
+    public:
+        explicit Utf8Cursor(const std::string_view str) :
+            it(reinterpret_cast<const uint8_t*>(str.data())), end(it + str.size()) {}
+
+        bool next_code_point(uint32_t& code_point) {
+            if(it == end) {
+                return false;
+            }
+
+            const uint8_t lead = *it;
+            size_t length = 0;
+
+            if(lead < 0x80) {
+                length = 1;
+                code_point = lead;
+            } else if((lead & 0xE0) == 0xC0) {
+                length = 2;
+                code_point = lead & 0x1F;
+            } else if((lead & 0xF0) == 0xE0) {
+                length = 3;
+                code_point = lead & 0x0F;
+            } else if((lead & 0xF8) == 0xF0) {
+                length = 4;
+                code_point = lead & 0x07;
+            }
+
+            bool valid = length != 0 && static_cast<size_t>(end - it) >= length;
+            for(size_t i = 1; valid && i < length; ++i) {
+                valid = (it[i] & 0xC0) == 0x80;
+                code_point = code_point << 6 | (it[i] & 0x3F);
+            }
+
+            if(not valid) {
+                code_point = lead;
+                length = 1;
+            }
+
+            it += length;
+            return true;
+        }
+
+        bool next(uint32_t& unit) {
+            if(pending_low_surrogate) {
+                unit = pending_low_surrogate;
+                pending_low_surrogate = 0;
+                return true;
+            }
+
+            if(not next_code_point(unit)) {
+                return false;
+            }
+
+            if(unit > MAX_UNIT) {
+                const auto value = unit - 0x10000;
+                unit = 0xD800 + (value >> 10);
+                pending_low_surrogate = 0xDC00 + (value & 0x3FF);
+            }
+
+            return true;
+        }
+
+    private:
+        const uint8_t* it;
+        const uint8_t* end;
+        uint32_t pending_low_surrogate = 0;
+    };
+
+    /**
+     * Iterates UTF-16 code units of a wide string in place.
+     * 32-bit `wchar_t` strings (non-Windows) are split into surrogate pairs on the fly.
+     */
+    template<typename Unit>
+    class WideCursor {
+    public:
+        explicit WideCursor(const std::basic_string_view<Unit> str) : it(str.data()), end(it + str.size()) {}
+
+        bool next(uint32_t& unit) {
+            if(pending_low_surrogate) {
+                unit = pending_low_surrogate;
+                pending_low_surrogate = 0;
+                return true;
+            }
+
+            if(it == end) {
+                return false;
+            }
+
+            unit = static_cast<uint32_t>(*it++);
+
+            if constexpr(sizeof(Unit) > 2) {
+                if(unit > MAX_UNIT) {
+                    const auto value = unit - 0x10000;
+                    unit = 0xD800 + (value >> 10);
+                    pending_low_surrogate = 0xDC00 + (value & 0x3FF);
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        const Unit* it;
+        const Unit* end;
+        uint32_t pending_low_surrogate = 0;
+    };
+
+    template<typename Unit>
+    std::string to_utf8(const std::basic_string_view<Unit> str) {
+        std::string result;
+        result.reserve(str.size());
+
+        for(size_t i = 0; i < str.size(); ++i) {
+            auto code_point = static_cast<uint32_t>(str[i]);
+
+            if(code_point >= 0xD800 && code_point <= 0xDBFF && i + 1 < str.size() &&
+               str[i + 1] >= 0xDC00 && str[i + 1] <= 0xDFFF) {
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (str[i + 1] - 0xDC00);
+                ++i;
+            }
+
+            if(code_point < 0x80) {
+                result += static_cast<char>(code_point);
+            } else if(code_point < 0x800) {
+                result += static_cast<char>(0xC0 | code_point >> 6);
+                result += static_cast<char>(0x80 | (code_point & 0x3F));
+            } else if(code_point < 0x10000) {
+                result += static_cast<char>(0xE0 | code_point >> 12);
+                result += static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+                result += static_cast<char>(0x80 | (code_point & 0x3F));
+            } else {
+                result += static_cast<char>(0xF0 | code_point >> 18);
+                result += static_cast<char>(0x80 | (code_point >> 12 & 0x3F));
+                result += static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+                result += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+        }
+
+        return result;
+    }
+
+    Ranges normalize(Ranges ranges) {
+        std::ranges::sort(ranges);
+
+        Ranges result;
+        for(const auto& range : ranges) {
+            if(not result.empty() && range.first <= result.back().second + 1) {
+                result.back().second = std::max(result.back().second, range.second);
+            } else {
+                result.push_back(range);
+            }
+        }
+
+        return result;
+    }
+
+    Ranges negate(const Ranges& ranges) {
+        Ranges result;
+        uint32_t next = 0;
+
+        for(const auto& [lo, hi] : normalize(ranges)) {
+            if(lo > next) {
+                result.emplace_back(next, lo - 1);
+            }
+            next = hi + 1;
+        }
+
+        if(next <= MAX_UNIT) {
+            result.emplace_back(next, MAX_UNIT);
+        }
+
+        return result;
+    }
+
+    /**
+     * Makes the set case-insensitive for ASCII letters, mirroring `std::regex_constants::icase`.
+     */
+    Ranges close_case(Ranges ranges) {
+        const auto size = ranges.size();
+        for(size_t i = 0; i < size; ++i) {
+            const auto [lo, hi] = ranges[i];
+
+            const auto upper_lo = std::max<uint32_t>(lo, 'A');
+            const auto upper_hi = std::min<uint32_t>(hi, 'Z');
+            if(upper_lo <= upper_hi) {
+                ranges.emplace_back(fold_case(upper_lo), fold_case(upper_hi));
+            }
+
+            const auto lower_lo = std::max<uint32_t>(lo, 'a');
+            const auto lower_hi = std::min<uint32_t>(hi, 'z');
+            if(lower_lo <= lower_hi) {
+                ranges.emplace_back(lower_lo - ('a' - 'A'), lower_hi - ('a' - 'A'));
+            }
+        }
+
+        return normalize(std::move(ranges));
+    }
+
+    const Ranges DIGITS{{'0', '9'}};
+    const Ranges WORD{{'0', '9'}, {'A', 'Z'}, {'_', '_'}, {'a', 'z'}};
+    const Ranges SPACES{{'\t', '\r'}, {' ', ' '}};
+    const Ranges ANY{{0, MAX_UNIT}};
+    const Ranges NOT_LINE_TERMINATOR = negate({{'\n', '\n'}, {'\r', '\r'}, {0x2028, 0x2029}});
+
+    struct Node {
+        enum class Kind { EMPTY, SET, CONCAT, ALTERNATION, REPEAT };
+
+        Kind kind = Kind::EMPTY;
+        Ranges set{};
+        std::vector<Node> children{};
+        uint32_t min = 0;
+        uint32_t max = 0;
+
+        static Node of_set(Ranges ranges) {
+            return {.kind = Kind::SET, .set = close_case(std::move(ranges))};
+        }
+    };
+
+    /**
+     * Top-level alternative of a pattern together with its anchors.
+     */
+    struct Branch {
+        Node node;
+        bool anchored_begin = false;
+        bool anchored_end = false;
+    };
+
+    /**
+     * Recursive descent parser for the subset of the ECMAScript grammar that maps onto a DFA.
+     * The pattern is assumed to be already validated by `std::regex`.
+     */
+    class Parser {
+    public:
+        explicit Parser(const std::string_view pattern) {
+            Utf8Cursor cursor(pattern);
+            uint32_t code_point = 0;
+            while(cursor.next_code_point(code_point)) {
+                input.push_back(code_point);
+            }
+        }
+
+        std::vector<Branch> parse() {
+            std::vector<Branch> branches;
+
+            do {
+                Branch branch;
+                branch.anchored_begin = consume('^');
+                branch.node = parse_sequence(&branch.anchored_end);
+                branches.push_back(std::move(branch));
+            } while(consume('|'));
+
+            if(not at_end()) {
+                throw Unsupported();
+            }
+
+            return branches;
+        }
+
+    private:
+        std::u32string input;
+        size_t pos = 0;
+
+        [[nodiscard]] bool at_end() const {
+            return pos >= input.size();
+        }
+
+        [[nodiscard]] uint32_t peek(const size_t offset = 0) const {
+            return pos + offset < input.size() ? input[pos + offset] : 0;
+        }
+
+        bool consume(const uint32_t c) {
+            if(not at_end() && input[pos] == c) {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+
+        uint32_t next() {
+            if(at_end()) {
+                throw Unsupported();
+            }
+            return input[pos++];
+        }
+
+        Node parse_alternation() {
+            Node alternation{.kind = Node::Kind::ALTERNATION};
+
+            do {
+                alternation.children.push_back(parse_sequence(nullptr));
+            } while(consume('|'));
+
+            return alternation.children.size() == 1 ? std::move(alternation.children.front()) : alternation;
+        }
+
+        /**
+         * @param anchored_end Receives trailing `$` anchor. Anchors are only supported at top level.
+         */
+        Node parse_sequence(bool* anchored_end) {
+            Node sequence{.kind = Node::Kind::CONCAT};
+
+            while(not at_end() && peek() != '|' && peek() != ')') {
+                if(peek() == '$') {
+                    ++pos;
+                    if(anchored_end == nullptr || (not at_end() && peek() != '|')) {
+                        throw Unsupported();
+                    }
+                    *anchored_end = true;
+                    break;
+                }
+
+                auto atom = parse_atom();
+                parse_quantifier(atom);
+                sequence.children.push_back(std::move(atom));
+            }
+
+            return sequence;
+        }
+
+        void parse_quantifier(Node& atom) {
+            uint32_t min = 0;
+            uint32_t max = 0;
+
+            switch(peek()) {
+            case '*':
+                ++pos;
+                min = 0;
+                max = UNBOUNDED;
+                break;
+            case '+':
+                ++pos;
+                min = 1;
+                max = UNBOUNDED;
+                break;
+            case '?':
+                ++pos;
+                min = 0;
+                max = 1;
+                break;
+            case '{':
+                ++pos;
+                min = parse_number();
+                max = min;
+                if(consume(',')) {
+                    max = peek() == '}' ? UNBOUNDED : parse_number();
+                }
+                if(not consume('}') || max < min) {
+                    throw Unsupported();
+                }
+                break;
+            default:
+                return;
+            }
+
+            // Laziness does not affect whether a match exists
+            consume('?');
+
+            atom = Node{.kind = Node::Kind::REPEAT, .children = {std::move(atom)}, .min = min, .max = max};
+
+            // Nested quantifiers such as `a**` are rejected by std::regex, but be safe.
+            if(peek() == '*' || peek() == '+' || peek() == '?' || peek() == '{') {
+                throw Unsupported();
+            }
+        }
+
+        uint32_t parse_number() {
+            if(peek() < '0' || peek() > '9') {
+                throw Unsupported();
+            }
+
+            uint32_t number = 0;
+            while(peek() >= '0' && peek() <= '9') {
+                number = number * 10 + (next() - '0');
+                if(number > 1'000) {
+                    throw Unsupported();
+                }
+            }
+
+            return number;
+        }
+
+        Node parse_atom() {
+            const auto c = next();
+
+            switch(c) {
+            case '.':
+                return Node::of_set(NOT_LINE_TERMINATOR);
+            case '(': {
+                if(consume('?')) {
+                    if(not consume(':')) {
+                        // Lookaheads
+                        throw Unsupported();
+                    }
+                }
+                auto group = parse_alternation();
+                if(not consume(')')) {
+                    throw Unsupported();
+                }
+                return group;
+            }
+            case '[':
+                return Node::of_set(parse_class());
+            case '\\':
+                return parse_atom_escape();
+            case '^':
+            case '$':
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+            case ')':
+            case '|':
+                throw Unsupported();
+            default:
+                return literal(c);
+            }
+        }
+
+        static Node literal(const uint32_t code_point) {
+            if(code_point <= MAX_UNIT) {
+                return Node::of_set({{code_point, code_point}});
+            }
+
+            const auto value = code_point - 0x10000;
+            const uint32_t high = 0xD800 + (value >> 10);
+            const uint32_t low = 0xDC00 + (value & 0x3FF);
+
+            Node sequence{.kind = Node::Kind::CONCAT};
+            sequence.children.push_back(Node::of_set({{high, high}}));
+            sequence.children.push_back(Node::of_set({{low, low}}));
+            return sequence;
+        }
+
+        Node parse_atom_escape() {
+            const auto c = peek();
+
+            if(c == 'b' || c == 'B' || (c >= '1' && c <= '9')) {
+                // Word boundaries and backreferences
+                throw Unsupported();
+            }
+
+            Ranges ranges;
+            if(parse_class_escape(ranges)) {
+                return Node::of_set(std::move(ranges));
+            }
+
+            return literal(parse_character_escape());
+        }
+
+        /**
+         * Parses `\d`, `\w`, `\s` and their negations.
+         */
+        bool parse_class_escape(Ranges& ranges) {
+            const Ranges* base = nullptr;
+            switch(fold_case(peek())) {
+            case 'd':
+                base = &DIGITS;
+                break;
+            case 'w':
+                base = &WORD;
+                break;
+            case 's':
+                base = &SPACES;
+                break;
+            default:
+                return false;
+            }
+
+            const bool negated = peek() >= 'A' && peek() <= 'Z';
+            ++pos;
+
+            const auto set = negated ? negate(*base) : *base;
+            ranges.insert(ranges.end(), set.begin(), set.end());
+
+            return true;
+        }
+
+        uint32_t parse_hex(const size_t digits) {
+            uint32_t value = 0;
+
+            for(size_t i = 0; i < digits; ++i) {
+                const auto c = fold_case(next());
+                if(c >= '0' && c <= '9') {
+                    value = value * 16 + (c - '0');
+                } else if(c >= 'a' && c <= 'f') {
+                    value = value * 16 + (c - 'a' + 10);
+                } else {
+                    throw Unsupported();
+                }
+            }
+
+            return value;
+        }
+
+        uint32_t parse_character_escape() {
+            const auto c = next();
+
+            switch(c) {
+            case 't':
+                return '\t';
+            case 'n':
+                return '\n';
+            case 'v':
+                return '\v';
+            case 'f':
+                return '\f';
+            case 'r':
+                return '\r';
+            case '0':
+                return 0;
+            case 'x':
+                return parse_hex(2);
+            case 'u':
+                return parse_hex(4);
+            default:
+                if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+                    // Control escapes and other exotic sequences
+                    throw Unsupported();
+                }
+                return c;
+            }
+        }
+
+        Ranges parse_class() {
+            const bool negated = consume('^');
+
+            Ranges ranges;
+            while(not consume(']')) {
+                uint32_t lo = 0;
+                if(not parse_class_atom(ranges, lo)) {
+                    continue;
+                }
+
+                if(peek() == '-' && pos + 1 < input.size() && peek(1) != ']') {
+                    ++pos;
+
+                    uint32_t hi = 0;
+                    if(not parse_class_atom(ranges, hi) || hi < lo) {
+                        throw Unsupported();
+                    }
+                    ranges.emplace_back(lo, hi);
+                } else {
+                    ranges.emplace_back(lo, lo);
+                }
+            }
+
+            for(const auto& [lo, hi] : ranges) {
+                if(hi > MAX_UNIT) {
+                    // Supplementary characters in classes would require multi-unit alternatives
+                    throw Unsupported();
+                }
+            }
+
+            return negated ? negate(close_case(std::move(ranges))) : ranges;
+        }
+
+        /**
+         * @return false if the atom was a class escape that was added to `ranges` directly.
+         */
+        bool parse_class_atom(Ranges& ranges, uint32_t& code_point) {
+            const auto c = next();
+
+            if(c != '\\') {
+                code_point = c;
+                return true;
+            }
+
+            if(parse_class_escape(ranges)) {
+                return false;
+            }
+
+            if(consume('b')) {
+                code_point = '\b';
+                return true;
+            }
+
+            if(consume('-')) {
+                code_point = '-';
+                return true;
+            }
+
+            code_point = parse_character_escape();
+            return true;
+        }
+    };
+
+    struct NfaState {
+        std::vector<uint32_t> epsilon;
+        // Index into Nfa::sets, or -1 for pure epsilon states
+        int32_t set = -1;
+        uint32_t target = 0;
+        bool accept = false;
+        bool accept_at_end = false;
+    };
+
+    struct Nfa {
+        std::vector<NfaState> states;
+        std::vector<Ranges> sets;
+        std::vector<uint32_t> initial;
+
+        uint32_t add_state() {
+            if(states.size() >= MAX_NFA_STATES) {
+                throw Unsupported();
+            }
+            states.emplace_back();
+            return static_cast<uint32_t>(states.size() - 1);
+        }
+
+        uint32_t add_set(const Ranges& ranges) {
+            sets.push_back(ranges);
+            return static_cast<uint32_t>(sets.size() - 1);
+        }
+
+        /**
+         * Thompson construction
+         *
+         * @return pair of start and end state
+         */
+        std::pair<uint32_t, uint32_t> build(const Node& node) {
+            switch(node.kind) {
+            case Node::Kind::SET: {
+                const auto start = add_state();
+                const auto end = add_state();
+                states[start].set = static_cast<int32_t>(add_set(node.set));
+                states[start].target = end;
+                return {start, end};
+            }
+            case Node::Kind::CONCAT: {
+                const auto start = add_state();
+                auto end = start;
+                for(const auto& child : node.children) {
+                    const auto [child_start, child_end] = build(child);
+                    states[end].epsilon.push_back(child_start);
+                    end = child_end;
+                }
+                return {start, end};
+            }
+            case Node::Kind::ALTERNATION: {
+                const auto start = add_state();
+                const auto end = add_state();
+                for(const auto& child : node.children) {
+                    const auto [child_start, child_end] = build(child);
+                    states[start].epsilon.push_back(child_start);
+                    states[child_end].epsilon.push_back(end);
+                }
+                return {start, end};
+            }
+            case Node::Kind::REPEAT: {
+                const auto& child = node.children.front();
+                const auto start = add_state();
+                auto end = start;
+
+                for(uint32_t i = 0; i < node.min; ++i) {
+                    const auto [child_start, child_end] = build(child);
+                    states[end].epsilon.push_back(child_start);
+                    end = child_end;
+                }
+
+                if(node.max == UNBOUNDED) {
+                    const auto loop = add_state();
+                    const auto [child_start, child_end] = build(child);
+                    states[end].epsilon.push_back(loop);
+                    states[loop].epsilon.push_back(child_start);
+                    states[child_end].epsilon.push_back(loop);
+                    end = loop;
+                } else {
+                    const auto exit = add_state();
+                    for(uint32_t i = node.min; i < node.max; ++i) {
+                        const auto [child_start, child_end] = build(child);
+                        states[end].epsilon.push_back(child_start);
+                        states[end].epsilon.push_back(exit);
+                        end = child_end;
+                    }
+                    states[end].epsilon.push_back(exit);
+                    end = exit;
+                }
+
+                return {start, end};
+            }
+            case Node::Kind::EMPTY:
+            default: {
+                const auto start = add_state();
+                return {start, start};
+            }
+            }
+        }
+
+        /**
+         * Adds compiled branches of a single pattern to the automaton.
+         * Unanchored branches are reachable from a self-looping scan state,
+         * which turns full matching into `regex_search` semantics.
+         */
+        void add_pattern(const std::vector<Branch>& branches, std::optional<uint32_t>& scan_state) {
+            for(const auto& branch : branches) {
+                const auto [start, end] = build(branch.node);
+                states[end].accept = not branch.anchored_end;
+                states[end].accept_at_end = branch.anchored_end;
+
+                if(branch.anchored_begin) {
+                    initial.push_back(start);
+                } else {
+                    if(not scan_state) {
+                        scan_state = add_state();
+                        states[*scan_state].set = static_cast<int32_t>(add_set(ANY));
+                        states[*scan_state].target = *scan_state;
+                        initial.push_back(*scan_state);
+                    }
+                    states[*scan_state].epsilon.push_back(start);
+                }
+            }
+        }
+    };
+
+    class DfaBuilder {
+    public:
+        explicit DfaBuilder(const Nfa& nfa) : nfa(nfa) {}
+
+        hide_matcher::Matcher::Dfa build() {
+            compute_classes();
+
+            // Dead state
+            add_state({});
+            dfa.start_state = add_state(closure(nfa.initial));
+
+            for(size_t index = 1; index < state_sets.size(); ++index) {
+                const auto current = state_sets[index];
+
+                if(dfa.flags[index] & Dfa::MATCH) {
+                    // Matching is absorbing since we only care whether a match exists
+                    std::fill_n(dfa.transitions.begin() + index * dfa.class_count, dfa.class_count, index);
+                    continue;
+                }
+
+                for(uint32_t class_id = 0; class_id < dfa.class_count; ++class_id) {
+                    std::vector<uint32_t> targets;
+                    for(const auto state : current) {
+                        const auto& nfa_state = nfa.states[state];
+                        if(nfa_state.set >= 0 && set_classes[nfa_state.set][class_id]) {
+                            targets.push_back(nfa_state.target);
+                        }
+                    }
+
+                    const auto target = add_state(closure(targets));
+                    dfa.transitions[index * dfa.class_count + class_id] = target;
+                }
+            }
+
+            return dfa;
+        }
+
+    private:
+        using Dfa = hide_matcher::Matcher::Dfa;
+
+        const Nfa& nfa;
+        Dfa dfa;
+        std::vector<std::vector<bool>> set_classes;
+        std::vector<std::vector<uint32_t>> state_sets;
+        std::map<std::vector<uint32_t>, uint16_t> state_ids;
+
+        /**
+         * Partitions the code unit space into classes of units
+         * that are indistinguishable by every set in the automaton.
+         */
+        void compute_classes() {
+            std::vector<uint32_t> bounds{0};
+            for(const auto& set : nfa.sets) {
+                for(const auto& [lo, hi] : set) {
+                    bounds.push_back(lo);
+                    bounds.push_back(hi + 1);
+                }
+            }
+            std::erase_if(bounds, [](const uint32_t bound) { return bound > MAX_UNIT; });
+            std::ranges::sort(bounds);
+            bounds.erase(std::ranges::unique(bounds).begin(), bounds.end());
+
+            std::map<std::vector<bool>, uint16_t> signatures;
+            std::vector<uint16_t> interval_classes;
+
+            for(const auto bound : bounds) {
+                std::vector<bool> signature(nfa.sets.size());
+                for(size_t set_id = 0; set_id < nfa.sets.size(); ++set_id) {
+                    signature[set_id] = std::ranges::any_of(nfa.sets[set_id], [&](const auto& range) {
+                        return range.first <= bound && bound <= range.second;
+                    });
+                }
+
+                const auto [it, inserted] = signatures.try_emplace(
+                    std::move(signature), static_cast<uint16_t>(signatures.size())
+                );
+                interval_classes.push_back(it->second);
+            }
+
+            dfa.class_count = static_cast<uint32_t>(signatures.size());
+
+            set_classes.assign(nfa.sets.size(), std::vector<bool>(dfa.class_count));
+            for(const auto& [signature, class_id] : signatures) {
+                for(size_t set_id = 0; set_id < signature.size(); ++set_id) {
+                    set_classes[set_id][class_id] = signature[set_id];
+                }
+            }
+
+            for(size_t i = 0; i < bounds.size(); ++i) {
+                const auto lo = bounds[i];
+                const auto hi = i + 1 < bounds.size() ? bounds[i + 1] : MAX_UNIT + 1;
+
+                for(auto unit = lo; unit < std::min<uint32_t>(hi, 128); ++unit) {
+                    dfa.ascii_classes[unit] = interval_classes[i];
+                }
+
+                if(hi > 128) {
+                    dfa.boundaries.push_back(std::max<uint32_t>(lo, 128));
+                    dfa.boundary_classes.push_back(interval_classes[i]);
+                }
+            }
+        }
+
+        std::vector<uint32_t> closure(const std::vector<uint32_t>& states) const {
+            std::vector<bool> visited(nfa.states.size());
+            std::vector<uint32_t> stack(states);
+            std::vector<uint32_t> result;
+
+            while(not stack.empty()) {
+                const auto state = stack.back();
+                stack.pop_back();
+
+                if(visited[state]) {
+                    continue;
+                }
+                visited[state] = true;
+
+                const auto& nfa_state = nfa.states[state];
+                // Pure epsilon states do not affect transitions or acceptance
+                if(nfa_state.set >= 0 || nfa_state.accept || nfa_state.accept_at_end) {
+                    result.push_back(state);
+                }
+
+                stack.insert(stack.end(), nfa_state.epsilon.begin(), nfa_state.epsilon.end());
+            }
+
+            std::ranges::sort(result);
+            return result;
+        }
+
+        uint16_t add_state(std::vector<uint32_t> states) {
+            if(const auto it = state_ids.find(states); it != state_ids.end()) {
+                return it->second;
+            }
+
+            if(state_sets.size() >= MAX_DFA_STATES) {
+                throw TooManyStates();
+            }
+
+            uint8_t flags = 0;
+            for(const auto state : states) {
+                if(nfa.states[state].accept) {
+                    flags |= Dfa::MATCH;
+                }
+                if(nfa.states[state].accept_at_end) {
+                    flags |= Dfa::MATCH_AT_END;
+                }
+            }
+
+            const auto id = static_cast<uint16_t>(state_sets.size());
+            state_ids.emplace(states, id);
+            state_sets.push_back(std::move(states));
+            dfa.flags.push_back(flags);
+            dfa.transitions.resize(state_sets.size() * dfa.class_count, Dfa::DEAD_STATE);
+
+            return id;
+        }
+    };
+
+    hide_matcher::Matcher::Dfa build_dfa(const std::vector<const std::vector<Branch>*>& patterns) {
+        Nfa nfa;
+        std::optional<uint32_t> scan_state;
+
+        for(const auto* branches : patterns) {
+            nfa.add_pattern(*branches, scan_state);
+        }
+
+        return DfaBuilder(nfa).build();
+    }
+}
+
+namespace hide_matcher {
+    uint16_t Matcher::Dfa::class_of(const uint32_t unit) const {
+        if(unit < ascii_classes.size()) {
+            return ascii_classes[unit];
+        }
+
+        const auto it = std::ranges::upper_bound(boundaries, unit);
+        return boundary_classes[it - boundaries.begin() - 1];
+    }
+
+    Matcher::Matcher(const std::set<std::string>& patterns) : patterns(patterns.size()) {
+        struct Compiled {
+            std::string pattern;
+            std::regex regex;
+            std::vector<Branch> branches{};
+        };
+
+        std::string errors;
+        std::vector<Compiled> compiled;
+
+        for(const auto& pattern : patterns) {
+            try {
+                // std::regex remains the authority on what a valid pattern is
+                compiled.push_back({.pattern = pattern, .regex = std::regex(pattern, std::regex_constants::icase)});
+            } catch(const std::regex_error& e) {
+                errors += "\n  \"" + pattern + "\": " + e.what();
+                continue;
+            }
+
+            try {
+                compiled.back().branches = Parser(pattern).parse();
+            } catch(const Unsupported&) {
+                fallbacks.push_back(compiled.back().regex);
+                fallback_patterns.push_back(pattern);
+                compiled.pop_back();
+            }
+        }
+
+        if(not errors.empty()) {
+            throw std::invalid_argument("Invalid hide_files patterns:" + errors);
+        }
+
+        if(compiled.empty()) {
+            return;
+        }
+
+        std::vector<const std::vector<Branch>*> all;
+        for(const auto& entry : compiled) {
+            all.push_back(&entry.branches);
+        }
+
+        try {
+            dfas.push_back(build_dfa(all));
+            return;
+        } catch(const Unsupported&) {
+        } catch(const TooManyStates&) {}
+
+        // The combined automaton is too large. Compile each pattern separately instead.
+        for(const auto& entry : compiled) {
+            try {
+                dfas.push_back(build_dfa({&entry.branches}));
+            } catch(const Unsupported&) {
+                fallbacks.push_back(entry.regex);
+                fallback_patterns.push_back(entry.pattern);
+            } catch(const TooManyStates&) {
+                fallbacks.push_back(entry.regex);
+                fallback_patterns.push_back(entry.pattern);
+            }
+        }
+    }
+
+    template<typename Cursor>
+    bool Matcher::run_dfas(const Cursor& input) const {
+        for(const auto& dfa : dfas) {
+            auto cursor = input;
+            auto state = dfa.start_state;
+            uint32_t unit = 0;
+
+            while(not(dfa.flags[state] & Dfa::MATCH) && state != Dfa::DEAD_STATE && cursor.next(unit)) {
+                state = dfa.transitions[state * dfa.class_count + dfa.class_of(fold_case(unit))];
+            }
+
+            if(dfa.flags[state] & Dfa::MATCH) {
+                return true;
+            }
+
+            // Input was fully consumed unless the automaton died early
+            if(dfa.flags[state] & Dfa::MATCH_AT_END && not cursor.next(unit)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool Matcher::matches(const std::string_view file_name) const {
+        if(run_dfas(Utf8Cursor(file_name))) {
+            return true;
+        }
+
+        return std::ranges::any_of(fallbacks, [&](const std::regex& regex) {
+            return std::regex_search(file_name.begin(), file_name.end(), regex);
+        });
+    }
+
+    template<typename Unit>
+    bool Matcher::matches_wide(const std::basic_string_view<Unit> file_name) const {
+        if(run_dfas(WideCursor(file_name))) {
+            return true;
+        }
+
+        if(fallbacks.empty()) {
+            return false;
+        }
+
+        // Only patterns that the DFA cannot express pay for the conversion
+        const auto utf8 = to_utf8(file_name);
+        return std::ranges::any_of(fallbacks, [&](const std::regex& regex) {
+            return std::regex_search(utf8, regex);
+        });
+    }
+
+    bool Matcher::matches(const std::u16string_view file_name) const {
+        return matches_wide(file_name);
+    }
+
+    bool Matcher::matches(const std::wstring_view file_name) const {
+        return matches_wide(file_name);
+    }
+
+    bool Matcher::empty() const {
+        return patterns == 0;
+    }
+
+    size_t Matcher::pattern_count() const {
+        return patterns;
+    }
+
+    size_t Matcher::fallback_count() const {
+        return fallbacks.size();
+    }
+
+    size_t Matcher::dfa_state_count() const {
+        size_t count = 0;
+        for(const auto& dfa : dfas) {
+            count += dfa.flags.size();
+        }
+        return count;
+    }
+
+    void Matcher::save(config_snapshot::Writer& writer) const {
+        writer.write<uint64_t>(patterns);
+
+        writer.write<uint64_t>(dfas.size());
+        for(const auto& dfa : dfas) {
+            writer.write(dfa.start_state);
+            writer.write(dfa.class_count);
+            writer.write(dfa.ascii_classes);
+            writer.write_vector(dfa.boundaries);
+            writer.write_vector(dfa.boundary_classes);
+            writer.write_vector(dfa.transitions);
+            writer.write_vector(dfa.flags);
+        }
+
+        writer.write<uint64_t>(fallback_patterns.size());
+        for(const auto& pattern : fallback_patterns) {
+            writer.write_string(pattern);
+        }
+    }
+
+    Matcher Matcher::load(config_snapshot::Reader& reader) {
+        Matcher matcher;
+        matcher.patterns = reader.read<uint64_t>();
+
+        const auto dfa_count = reader.read<uint64_t>();
+        for(uint64_t i = 0; i < dfa_count; ++i) {
+            Dfa dfa;
+            dfa.start_state = reader.read<uint16_t>();
+            dfa.class_count = reader.read<uint32_t>();
+            dfa.ascii_classes = reader.read<std::array<uint16_t, 128>>();
+            dfa.boundaries = reader.read_vector<uint32_t>();
+            dfa.boundary_classes = reader.read_vector<uint16_t>();
+            dfa.transitions = reader.read_vector<uint16_t>();
+            dfa.flags = reader.read_vector<uint8_t>();
+
+            // Matching trusts the automaton completely, so an inconsistent one must never be used
+            const auto state_count = dfa.flags.size();
+            const auto is_valid_class = [&](const uint16_t c) { return c < dfa.class_count; };
+            const auto is_valid_state = [&](const uint16_t state) { return state < state_count; };
+
+            if(
+                dfa.class_count == 0 ||
+                dfa.transitions.size() != state_count * dfa.class_count ||
+                not is_valid_state(dfa.start_state) ||
+                dfa.boundaries.size() != dfa.boundary_classes.size() ||
+                dfa.boundaries.empty() || dfa.boundaries.front() > dfa.ascii_classes.size() ||
+                not std::ranges::is_sorted(dfa.boundaries) ||
+                not std::ranges::all_of(dfa.ascii_classes, is_valid_class) ||
+                not std::ranges::all_of(dfa.boundary_classes, is_valid_class) ||
+                not std::ranges::all_of(dfa.transitions, is_valid_state)
+            ) {
+                throw std::runtime_error("Inconsistent hide matcher automaton");
+            }
+
+            matcher.dfas.push_back(std::move(dfa));
+        }
+
+        const auto fallback_count = reader.read<uint64_t>();
+        for(uint64_t i = 0; i < fallback_count; ++i) {
+            auto pattern = reader.read_string();
+            matcher.fallbacks.emplace_back(pattern, std::regex_constants::icase);
+            matcher.fallback_patterns.push_back(std::move(pattern));
+        }
+
+        return matcher;
+    }
+}
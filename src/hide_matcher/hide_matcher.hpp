@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <regex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config_snapshot/config_snapshot.hpp"
+
+/**
+ * Compiled matcher for the `hide_files` patterns.
+ *
+ * All patterns are compiled once into a single DFA over UTF-16 code units,
+ * so that deciding whether a file is hidden takes exactly one pass over
+ * the file name regardless of the number of configured patterns.
+ * The matcher follows the semantics of `std::regex_search` with
+ * `std::regex_constants::icase` (ECMAScript grammar, ASCII case folding),
+ * except that it runs on UTF-16 code units instead of bytes. Patterns and UTF-8 file names
+ * are decoded first, so `.`, `{n}` and negated classes consume a whole non-ASCII character
+ * below U+10000 rather than one byte of it. Bytes that are not valid UTF-8,
+ * such as ANSI names from the `A` APIs, are decoded as Latin-1.
+ * Patterns that use features a DFA cannot express (backreferences,
+ * lookarounds, word boundaries) fall back to a `std::regex` compiled once,
+ * which still runs on UTF-8 bytes.
+ * Matching itself allocates nothing unless such fallbacks are present.
+ */
+namespace hide_matcher {
+    class Matcher {
+    public:
+        /**
+         * Creates a matcher that does not match anything.
+         */
+        Matcher() = default;
+
+        /**
+         * @throws std::invalid_argument listing every pattern that is not a valid regular expression
+         */
+        explicit Matcher(const std::set<std::string>& patterns);
+
+        /**
+         * @param file_name UTF-8 encoded file name or path
+         */
+        [[nodiscard]] bool matches(std::string_view file_name) const;
+
+        /**
+         * Matches directly on the code units without any heap allocations,
+         * unless some patterns had to fall back to `std::regex`.
+         *
+         * @param file_name UTF-16 encoded file name or path
+         */
+        [[nodiscard]] bool matches(std::u16string_view file_name) const;
+
+        /**
+         * @param file_name Wide file name or path, such as `LPCWSTR` or `WIN32_FIND_DATAW::cFileName`
+         */
+        [[nodiscard]] bool matches(std::wstring_view file_name) const;
+
+        [[nodiscard]] bool empty() const;
+
+        [[nodiscard]] size_t pattern_count() const;
+
+        [[nodiscard]] size_t fallback_count() const;
+
+        [[nodiscard]] size_t dfa_state_count() const;
+
+        /**
+         * Appends the compiled automata and the patterns that fall back to `std::regex`
+         */
+        void save(config_snapshot::Writer& writer) const;
+
+        /**
+         * Restores a matcher saved by `save` without compiling the patterns again,
+         * apart from those that fall back to `std::regex`
+         *
+         * @throws std::runtime_error if the data is truncated or inconsistent
+         */
+        static Matcher load(config_snapshot::Reader& reader);
+
+        /**
+         * Deterministic automaton for a group of patterns.
+         * Transitions are indexed by state and by the equivalence class of an input unit.
+         */
+        struct Dfa {
+            static constexpr uint16_t DEAD_STATE = 0;
+            static constexpr uint8_t MATCH = 1;
+            static constexpr uint8_t MATCH_AT_END = 2;
+
+            uint16_t start_state = DEAD_STATE;
+            uint32_t class_count = 0;
+            std::array<uint16_t, 128> ascii_classes{};
+            // Sorted lower bounds of classes for non-ASCII units
+            std::vector<uint32_t> boundaries;
+            std::vector<uint16_t> boundary_classes;
+            std::vector<uint16_t> transitions;
+            std::vector<uint8_t> flags;
+
+            [[nodiscard]] uint16_t class_of(uint32_t unit) const;
+        };
+
+    private:
+        std::vector<Dfa> dfas;
+        std::vector<std::regex> fallbacks;
+        // Sources of the fallbacks, for saving the matcher
+        std::vector<std::string> fallback_patterns;
+        size_t patterns = 0;
+
+        template<typename Cursor>
+        [[nodiscard]] bool run_dfas(const Cursor& input) const;
+
+        template<typename Unit>
+        [[nodiscard]] bool matches_wide(std::basic_string_view<Unit> file_name) const;
+    };
+
+    /**
+     * Hiding decision of the file API hooks, which is shared with the hook replay
+     * so that both decide the same way
+     *
+     * @param file_name Any file name or path that `Matcher::matches` accepts
+     */
+    template<typename String>
+    [[nodiscard]] bool is_file_hidden(const Matcher& matcher, const String& file_name) {
+        return not matcher.empty() && matcher.matches(file_name);
+    }
+}
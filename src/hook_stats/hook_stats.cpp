@@ -0,0 +1,171 @@
+#include <bit>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include "hook_stats/hook_stats.hpp"
+
+namespace {
+    using namespace hook_stats;
+
+    uint64_t to_nanoseconds(const Clock::duration duration) {
+        const auto count = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        return count > 0 ? static_cast<uint64_t>(count) : 0;
+    }
+
+    void add_relaxed(std::atomic<uint64_t>& counter, const uint64_t value) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void write_duration(std::ostream& stream, const uint64_t nanoseconds) {
+        if(nanoseconds < 10'000) {
+            stream << nanoseconds << " ns";
+        } else if(nanoseconds < 10'000'000) {
+            stream << nanoseconds / 1'000 << " us";
+        } else {
+            stream << nanoseconds / 1'000'000 << " ms";
+        }
+    }
+}
+
+namespace hook_stats {
+    size_t Histogram::bucket_of(const uint64_t nanoseconds) {
+        if(nanoseconds < 2) {
+            return 0;
+        }
+
+        return std::min<size_t>(std::bit_width(nanoseconds) - 1, BUCKET_COUNT - 1);
+    }
+
+    void Histogram::record(const Clock::duration duration) {
+        add_relaxed(buckets[bucket_of(to_nanoseconds(duration))], 1);
+    }
+
+    Histogram::Buckets Histogram::snapshot() const {
+        Buckets result{};
+        for(size_t i = 0; i < BUCKET_COUNT; ++i) {
+            result[i] = buckets[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    uint64_t Histogram::percentile(const Buckets& buckets, const double fraction) {
+        uint64_t total = 0;
+        for(const auto count : buckets) {
+            total += count;
+        }
+
+        if(total == 0) {
+            return 0;
+        }
+
+        const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total))));
+
+        uint64_t seen = 0;
+        for(size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += buckets[i];
+            if(seen >= rank) {
+                return uint64_t{2} << i;
+            }
+        }
+
+        return uint64_t{2} << (BUCKET_COUNT - 1);
+    }
+
+    HookStats::HookStats(std::string name) : hook_name(std::move(name)) {}
+
+    void HookStats::record(const Clock::duration own_time, const Clock::duration original_time, const bool hidden) {
+        add_relaxed(call_count, 1);
+        if(hidden) {
+            add_relaxed(hidden_count, 1);
+        }
+
+        add_relaxed(own_nanoseconds, to_nanoseconds(own_time));
+        add_relaxed(original_nanoseconds, to_nanoseconds(original_time));
+        own_histogram.record(own_time);
+        original_histogram.record(original_time);
+    }
+
+    const std::string& HookStats::name() const {
+        return hook_name;
+    }
+
+    uint64_t HookStats::calls() const {
+        return call_count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t HookStats::hidden() const {
+        return hidden_count.load(std::memory_order_relaxed);
+    }
+
+    const Histogram& HookStats::own_time() const {
+        return own_histogram;
+    }
+
+    const Histogram& HookStats::original_time() const {
+        return original_histogram;
+    }
+
+    std::string HookStats::report() const {
+        const auto call_total = calls();
+        if(call_total == 0) {
+            return {};
+        }
+
+        const auto own = own_histogram.snapshot();
+        const auto original = original_histogram.snapshot();
+
+        std::ostringstream line;
+        line << hook_name << ": " << call_total << " calls, " << hidden() << " hidden | own: total ";
+        write_duration(line, own_nanoseconds.load(std::memory_order_relaxed));
+        line << ", p50 < ";
+        write_duration(line, Histogram::percentile(own, 0.5));
+        line << ", p99 < ";
+        write_duration(line, Histogram::percentile(own, 0.99));
+        line << " | original: total ";
+        write_duration(line, original_nanoseconds.load(std::memory_order_relaxed));
+        line << ", p50 < ";
+        write_duration(line, Histogram::percentile(original, 0.5));
+        line << ", p99 < ";
+        write_duration(line, Histogram::percentile(original, 0.99));
+
+        return line.str();
+    }
+
+    HookStats& Registry::add(std::string name) {
+        const std::lock_guard lock(mutex);
+        return hooks.emplace_back(std::move(name));
+    }
+
+    std::vector<std::string> Registry::report() const {
+        const std::lock_guard lock(mutex);
+
+        std::vector<std::string> lines;
+        for(const auto& hook : hooks) {
+            if(auto line = hook.report(); not line.empty()) {
+                lines.push_back(std::move(line));
+            }
+        }
+
+        return lines;
+    }
+
+    Registry& registry() {
+        static Registry registry;
+        return registry;
+    }
+
+    CallTimer::CallTimer(HookStats& stats, const bool enabled) :
+        stats(stats), enabled(enabled), start(enabled ? Clock::now() : Clock::time_point{}) {}
+
+    CallTimer::~CallTimer() {
+        if(enabled) {
+            const auto total_time = Clock::now() - start;
+            stats.record(total_time - original_time, original_time, hidden);
+        }
+    }
+
+    void CallTimer::set_hidden(const bool hidden) {
+        this->hidden = this->hidden || hidden;
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Call statistics of API hooks.
+ *
+ * Every hook counts its calls and the calls in which it hid a file,
+ * and keeps log-scale histograms of the time spent in the hook itself
+ * and in the original function. All counters are relaxed atomics, and the
+ * statistics of each hook occupy their own cache lines, so that hooks
+ * called concurrently on different threads do not slow each other down.
+ */
+namespace hook_stats {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Histogram of durations with power-of-two buckets.
+     * Bucket 0 counts durations below 2 ns, and bucket `i` counts durations in [2^i, 2^(i+1)) ns.
+     */
+    class Histogram {
+    public:
+        static constexpr size_t BUCKET_COUNT = 40;
+
+        using Buckets = std::array<uint64_t, BUCKET_COUNT>;
+
+        void record(Clock::duration duration);
+
+        [[nodiscard]] Buckets snapshot() const;
+
+        /**
+         * @param fraction Between 0 and 1, e.g. 0.99 for the 99th percentile
+         * @return Upper bound in nanoseconds of the bucket that contains the percentile, or 0 if empty
+         */
+        [[nodiscard]] static uint64_t percentile(const Buckets& buckets, double fraction);
+
+        [[nodiscard]] static size_t bucket_of(uint64_t nanoseconds);
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    };
+
+    class alignas(64) HookStats {
+    public:
+        explicit HookStats(std::string name);
+
+        void record(Clock::duration own_time, Clock::duration original_time, bool hidden);
+
+        [[nodiscard]] const std::string& name() const;
+
+        [[nodiscard]] uint64_t calls() const;
+
+        [[nodiscard]] uint64_t hidden() const;
+
+        [[nodiscard]] const Histogram& own_time() const;
+
+        [[nodiscard]] const Histogram& original_time() const;
+
+        /**
+         * @return Single line with counters, totals and percentiles, or nothing if the hook was never called
+         */
+        [[nodiscard]] std::string report() const;
+
+    private:
+        std::string hook_name;
+        alignas(64) std::atomic<uint64_t> call_count = 0;
+        std::atomic<uint64_t> hidden_count = 0;
+        std::atomic<uint64_t> own_nanoseconds = 0;
+        std::atomic<uint64_t> original_nanoseconds = 0;
+        Histogram own_histogram;
+        Histogram original_histogram;
+    };
+
+    /**
+     * Owns the statistics of all hooks. Registered statistics are never moved.
+     */
+    class Registry {
+    public:
+        HookStats& add(std::string name);
+
+        /**
+         * @return Report lines of all hooks that were called, in registration order
+         */
+        [[nodiscard]] std::vector<std::string> report() const;
+
+    private:
+        mutable std::mutex mutex;
+        std::deque<HookStats> hooks;
+    };
+
+    Registry& registry();
+
+    /**
+     * Measures a single hook call and attributes time spent in the original function separately.
+     * Does nothing unless enabled, apart from calling the original function.
+     */
+    class CallTimer {
+    public:
+        CallTimer(HookStats& stats, bool enabled);
+
+        ~CallTimer();
+
+        CallTimer(const CallTimer&) = delete;
+
+        CallTimer& operator=(const CallTimer&) = delete;
+
+        template<typename Function>
+        auto call_original(const Function& function) {
+            if(not enabled) {
+                return function();
+            }
+
+            const auto original_start = Clock::now();
+            auto result = function();
+            original_time += Clock::now() - original_start;
+
+            return result;
+        }
+
+        void set_hidden(bool hidden);
+
+    private:
+        HookStats& stats;
+        bool enabled;
+        bool hidden = false;
+        Clock::time_point start;
+        Clock::duration original_time{};
+    };
+}
@@ -0,0 +1,389 @@
+#include <array>
+#include <sstream>
+#include <stdexcept>
+
+#include "hook_trace/hook_trace.hpp"
+#include "utf8_path/utf8_path.hpp"
+
+namespace {
+    using namespace hook_trace;
+
+    constexpr std::string_view MAGIC = "koaloader-hook-trace";
+    constexpr uint32_t FORMAT_VERSION = 1;
+
+    constexpr uint8_t HIDDEN_FLAG = 0x80;
+
+    constexpr std::array<std::string_view, API_COUNT> API_NAMES{
+        "FindFirstFileW",
+        "FindFirstFileExW",
+        "FindNextFileW",
+        "FindClose",
+        "GetFileAttributesA",
+        "GetFileAttributesW",
+        "GetFileAttributesExA",
+        "GetFileAttributesExW",
+        "CreateFileA",
+        "CreateFileW",
+    };
+
+    constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+    void append_varint(std::string& buffer, uint64_t value) {
+        while(value >= 0x80) {
+            buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    /**
+     * Maps small negative values, such as `INVALID_HANDLE_VALUE`, to small varints
+     */
+    uint64_t zigzag_encode(const int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t zigzag_decode(const uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    /**
+     * Calls `visit` with every code point of the string, where unpaired surrogates are code points of their own
+     */
+    template<typename Visitor>
+    void for_each_code_point(const std::u16string_view str, const Visitor& visit) {
+        for(size_t i = 0; i < str.size(); ++i) {
+            const char32_t unit = str[i];
+
+            if(unit >= 0xD800 && unit < 0xDC00 && i + 1 < str.size() && str[i + 1] >= 0xDC00 && str[i + 1] < 0xE000) {
+                visit(0x10000 + ((unit - 0xD800) << 10) + (str[i + 1] - 0xDC00));
+                ++i;
+            } else {
+                visit(unit);
+            }
+        }
+    }
+
+    size_t utf8_length(const char32_t code_point) {
+        return code_point < 0x80 ? 1 : code_point < 0x800 ? 2 : code_point < 0x10000 ? 3 : 4;
+    }
+
+    void append_utf8(std::string& buffer, const char32_t code_point) {
+        switch(utf8_length(code_point)) {
+        case 1:
+            buffer.push_back(static_cast<char>(code_point));
+            break;
+        case 2:
+            buffer.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+            buffer.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            break;
+        case 3:
+            buffer.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+            buffer.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            buffer.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            break;
+        default:
+            buffer.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+            buffer.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+            buffer.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            buffer.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            break;
+        }
+    }
+
+    void append_string(std::string& buffer, const std::string_view str) {
+        append_varint(buffer, str.size());
+        buffer.append(str);
+    }
+
+    /**
+     * Encodes straight into the buffer, so that recording a wide path does not allocate
+     */
+    void append_string(std::string& buffer, const std::u16string_view str) {
+        size_t length = 0;
+        for_each_code_point(str, [&](const char32_t code_point) { length += utf8_length(code_point); });
+
+        append_varint(buffer, length);
+        for_each_code_point(str, [&](const char32_t code_point) { append_utf8(buffer, code_point); });
+    }
+
+    class Reader {
+    public:
+        explicit Reader(const std::string_view data) : data(data) {}
+
+        uint64_t read_varint() {
+            uint64_t value = 0;
+
+            for(auto shift = 0; shift < 64; shift += 7) {
+                const auto byte = static_cast<uint8_t>(*take(1));
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+                if(not(byte & 0x80)) {
+                    return value;
+                }
+            }
+
+            throw std::runtime_error("Corrupted hook trace");
+        }
+
+        std::string_view read_bytes(const size_t size) {
+            return {take(size), size};
+        }
+
+        std::string_view read_string() {
+            const auto size = read_varint();
+            if(size > data.size()) {
+                throw std::runtime_error("Truncated hook trace");
+            }
+            return read_bytes(size);
+        }
+
+        [[nodiscard]] bool empty() const {
+            return data.empty();
+        }
+
+    private:
+        std::string_view data;
+
+        const char* take(const size_t size) {
+            if(size > data.size()) {
+                throw std::runtime_error("Truncated hook trace");
+            }
+
+            const auto* const result = data.data();
+            data.remove_prefix(size);
+            return result;
+        }
+    };
+
+    /**
+     * @return Length of the UTF-8 sequence at the start of `str`, or 0 if it is invalid
+     */
+    size_t decode_utf8(const std::string_view str, char32_t& code_point) {
+        const auto lead = static_cast<uint8_t>(str[0]);
+
+        size_t length;
+        if(lead < 0x80) {
+            code_point = lead;
+            return 1;
+        } else if(lead >= 0xC2 && lead < 0xE0) {
+            length = 2;
+            code_point = lead & 0x1F;
+        } else if(lead >= 0xE0 && lead < 0xF0) {
+            length = 3;
+            code_point = lead & 0x0F;
+        } else if(lead >= 0xF0 && lead < 0xF5) {
+            length = 4;
+            code_point = lead & 0x07;
+        } else {
+            return 0;
+        }
+
+        if(str.size() < length) {
+            return 0;
+        }
+
+        for(size_t i = 1; i < length; ++i) {
+            const auto unit = static_cast<uint8_t>(str[i]);
+            if((unit & 0xC0) != 0x80) {
+                return 0;
+            }
+            code_point = (code_point << 6) | (unit & 0x3F);
+        }
+
+        // Overlong sequences and values beyond Unicode
+        if(code_point < (length == 3 ? 0x800u : length == 4 ? 0x10000u : 0x80u) || code_point > 0x10FFFF) {
+            return 0;
+        }
+
+        return length;
+    }
+}
+
+namespace hook_trace {
+    std::string_view api_name(const Api api) {
+        return API_NAMES[static_cast<size_t>(api)];
+    }
+
+    bool is_narrow(const Api api) {
+        return api == Api::GetFileAttributesA || api == Api::GetFileAttributesExA || api == Api::CreateFileA;
+    }
+
+    Recorder::Recorder(const std::filesystem::path& path) :
+        file(path, std::ios::binary | std::ios::trunc), origin(Clock::now()) {
+        if(not file) {
+            throw std::runtime_error("Failed to open " + utf8_path::to_utf8(path) + " for writing");
+        }
+
+        buffer.reserve(BUFFER_SIZE);
+        append_string(buffer, MAGIC);
+        append_varint(buffer, FORMAT_VERSION);
+    }
+
+    Recorder::~Recorder() {
+        const std::lock_guard lock(mutex);
+        write_buffer();
+    }
+
+    void Recorder::record(
+        const Api api,
+        const bool hidden,
+        const uint64_t handle,
+        const int64_t result,
+        const std::string_view path
+    ) {
+        const std::lock_guard lock(mutex);
+
+        append_fields(api, hidden, handle, result);
+        append_string(buffer, path);
+        append_string(buffer, std::string_view());
+
+        if(buffer.size() >= BUFFER_SIZE) {
+            write_buffer();
+        }
+    }
+
+    void Recorder::record(
+        const Api api,
+        const bool hidden,
+        const uint64_t handle,
+        const int64_t result,
+        const std::u16string_view path,
+        const std::u16string_view file_name
+    ) {
+        const std::lock_guard lock(mutex);
+
+        append_fields(api, hidden, handle, result);
+        append_string(buffer, path);
+        append_string(buffer, file_name);
+
+        if(buffer.size() >= BUFFER_SIZE) {
+            write_buffer();
+        }
+    }
+
+    void Recorder::flush() {
+        const std::lock_guard lock(mutex);
+
+        write_buffer();
+        file.flush();
+
+        if(not file) {
+            throw std::runtime_error("Failed to write hook trace");
+        }
+    }
+
+    uint64_t Recorder::count() const {
+        const std::lock_guard lock(mutex);
+        return record_count;
+    }
+
+    /**
+     * Layout of a record:
+     *
+     * API with the hidden flag in the highest bit, timestamp delta, handle, zigzag-encoded result, path, file name
+     */
+    void Recorder::append_fields(const Api api, const bool hidden, const uint64_t handle, const int64_t result) {
+        // Taken under the mutex, so that timestamps never decrease
+        const auto timestamp_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count()
+        );
+
+        buffer.push_back(static_cast<char>(static_cast<uint8_t>(api) | (hidden ? HIDDEN_FLAG : 0)));
+        append_varint(buffer, timestamp_ns - previous_timestamp_ns);
+        append_varint(buffer, handle);
+        append_varint(buffer, zigzag_encode(result));
+
+        previous_timestamp_ns = timestamp_ns;
+        record_count++;
+    }
+
+    /**
+     * Errors leave the stream in a failed state, which `flush` reports
+     */
+    void Recorder::write_buffer() {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    std::vector<Record> parse(const std::string_view data) {
+        Reader reader(data);
+
+        if(reader.read_string() != MAGIC) {
+            throw std::runtime_error("Not a hook trace");
+        }
+
+        if(const auto version = reader.read_varint(); version != FORMAT_VERSION) {
+            throw std::runtime_error("Unsupported hook trace version " + std::to_string(version));
+        }
+
+        std::vector<Record> records;
+        uint64_t timestamp_ns = 0;
+
+        while(not reader.empty()) {
+            const auto flags = static_cast<uint8_t>(reader.read_bytes(1)[0]);
+            const auto api = static_cast<uint8_t>(flags & ~HIDDEN_FLAG);
+            if(api >= API_COUNT) {
+                throw std::runtime_error("Corrupted hook trace");
+            }
+
+            timestamp_ns += reader.read_varint();
+
+            auto& record = records.emplace_back();
+            record.api = static_cast<Api>(api);
+            record.hidden = flags & HIDDEN_FLAG;
+            record.timestamp_ns = timestamp_ns;
+            record.handle = reader.read_varint();
+            record.result = zigzag_decode(reader.read_varint());
+            record.path = reader.read_string();
+            record.file_name = reader.read_string();
+        }
+
+        return records;
+    }
+
+    std::vector<Record> load(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        if(not file) {
+            throw std::runtime_error("Failed to open " + utf8_path::to_utf8(path));
+        }
+
+        std::ostringstream contents;
+        contents << file.rdbuf();
+
+        return parse(std::move(contents).str());
+    }
+
+    std::string to_utf8(const std::u16string_view str) {
+        std::string result;
+        result.reserve(str.size());
+        for_each_code_point(str, [&](const char32_t code_point) { append_utf8(result, code_point); });
+        return result;
+    }
+
+    std::u16string to_utf16(std::string_view str) {
+        std::u16string result;
+        result.reserve(str.size());
+
+        while(not str.empty()) {
+            char32_t code_point = 0;
+            auto length = decode_utf8(str, code_point);
+
+            if(length == 0) {
+                code_point = REPLACEMENT_CHARACTER;
+                length = 1;
+            }
+
+            if(code_point >= 0x10000) {
+                result.push_back(static_cast<char16_t>(0xD800 + ((code_point - 0x10000) >> 10)));
+                result.push_back(static_cast<char16_t>(0xDC00 + ((code_point - 0x10000) & 0x3FF)));
+            } else {
+                result.push_back(static_cast<char16_t>(code_point));
+            }
+
+            str.remove_prefix(length);
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Compact binary trace of file API hook calls.
+ *
+ * Every hook call that reaches the hiding logic is recorded with the function,
+ * the hiding decision, the time since the start of the trace, the find handle,
+ * the return value and the paths involved, so that the file access pattern
+ * of a real session can be replayed offline against any `hide_files` config.
+ *
+ * A trace starts with the magic string and the format version, followed by records.
+ * All integers are LEB128 varints and timestamps are deltas to the previous record,
+ * which keeps a typical record within a few bytes beyond its path.
+ * Paths are stored in UTF-8. Unpaired surrogates of UTF-16 paths are encoded like
+ * regular code points (WTF-8), so that every path survives a round trip unchanged.
+ */
+namespace hook_trace {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Hooked functions. Values are stored in traces and must not be reordered.
+     */
+    enum class Api : uint8_t {
+        FindFirstFileW,
+        FindFirstFileExW,
+        FindNextFileW,
+        FindClose,
+        GetFileAttributesA,
+        GetFileAttributesW,
+        GetFileAttributesExA,
+        GetFileAttributesExW,
+        CreateFileA,
+        CreateFileW,
+    };
+
+    constexpr size_t API_COUNT = 10;
+
+    [[nodiscard]] std::string_view api_name(Api api);
+
+    /**
+     * @return true for the functions that take narrow (ANSI) paths
+     */
+    [[nodiscard]] bool is_narrow(Api api);
+
+    struct Record {
+        Api api = Api::FindFirstFileW;
+        // Whether the hook hid the file
+        bool hidden = false;
+        // Time since the start of the trace
+        uint64_t timestamp_ns = 0;
+        // Find handle passed to `FindNextFileW` and `FindClose`
+        uint64_t handle = 0;
+        // Return value of the original function, or of the hook if it did not call the original
+        int64_t result = 0;
+        // Query or path passed to the function
+        std::string path{};
+        // Name of the entry found by the enumeration functions
+        std::string file_name{};
+
+        bool operator==(const Record&) const = default;
+    };
+
+    /**
+     * Appends records to a trace file.
+     * Records are buffered in memory and written in large chunks, and can be added
+     * from any number of threads, which are serialized by a mutex.
+     */
+    class Recorder {
+    public:
+        /**
+         * Creates the file, replacing any previous trace
+         *
+         * @throws std::runtime_error if the file cannot be created
+         */
+        explicit Recorder(const std::filesystem::path& path);
+
+        /**
+         * Writes all buffered records, ignoring errors
+         */
+        ~Recorder();
+
+        Recorder(const Recorder&) = delete;
+
+        Recorder& operator=(const Recorder&) = delete;
+
+        /**
+         * @param path Narrow path, as passed to the ANSI functions
+         */
+        void record(Api api, bool hidden, uint64_t handle, int64_t result, std::string_view path);
+
+        void record(
+            Api api,
+            bool hidden,
+            uint64_t handle,
+            int64_t result,
+            std::u16string_view path,
+            std::u16string_view file_name = {}
+        );
+
+        /**
+         * Writes all buffered records
+         *
+         * @throws std::runtime_error if the file could not be written
+         */
+        void flush();
+
+        [[nodiscard]] uint64_t count() const;
+
+    private:
+        static constexpr size_t BUFFER_SIZE = 256 * 1024;
+
+        mutable std::mutex mutex;
+        std::ofstream file;
+        std::string buffer;
+        Clock::time_point origin;
+        uint64_t previous_timestamp_ns = 0;
+        uint64_t record_count = 0;
+
+        /**
+         * Must be called with the mutex held
+         */
+        void append_fields(Api api, bool hidden, uint64_t handle, int64_t result);
+
+        void write_buffer();
+    };
+
+    /**
+     * @throws std::runtime_error if the data is not a trace, or is truncated or corrupted
+     */
+    std::vector<Record> parse(std::string_view data);
+
+    /**
+     * @throws std::runtime_error if the file cannot be read or is not a valid trace
+     */
+    std::vector<Record> load(const std::filesystem::path& path);
+
+    std::string to_utf8(std::u16string_view str);
+
+    /**
+     * Inverse of `to_utf8`. Invalid sequences are replaced by U+FFFD.
+     */
+    std::u16string to_utf16(std::string_view str);
+}
@@ -1,4 +1,9 @@
-#include <set>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <thread>
 
 #include <koalabox/config.hpp>
 #include <koalabox/globals.hpp>
@@ -6,70 +11,143 @@
 #include <koalabox/logger.hpp>
 #include <koalabox/path.hpp>
 #include <koalabox/platform.hpp>
-#include <koalabox/str.hpp>
 #include <koalabox/util.hpp>
 
 #include "build_config.h"
 
 #include "koaloader/koaloader.hpp"
 
+#include "config_snapshot/config_snapshot.hpp"
+#include "directory_walker/directory_walker.hpp"
+#include "discovery_cache/discovery_cache.hpp"
+#include "hide_matcher/hide_matcher.hpp"
 #include "patcher/patcher.hpp"
+#include "read_ahead/read_ahead.hpp"
+#include "startup_trace/startup_trace.hpp"
+#include "target_rules/target_rules.hpp"
+#include "well_known_modules/well_known_modules.hpp"
+#include "wildcard/wildcard.hpp"
 #include "win_api/file_api.hpp"
 
 namespace {
     namespace kb = koalabox;
     namespace fs = std::filesystem;
 
+    constexpr auto CACHE_FILE_NAME = "Koaloader.cache";
+    constexpr auto PATCH_CACHE_FILE_NAME = "Koaloader.patches.cache";
+    constexpr auto TRACE_FILE_NAME = "Koaloader.trace.json";
+    constexpr auto HOOK_TRACE_FILE_NAME = "Koaloader.hooks.trace";
+
+    constexpr auto DISCOVERY_DIRECTORY_OPTIONS =
+        fs::directory_options::follow_directory_symlink |
+        fs::directory_options::skip_permission_denied;
+
     fs::path self_directory;
 
     bool loaded = false;
 
-    bool is_loaded_by_target() {
-        if(koaloader::config.targets.empty()) {
-            return true;
+    std::atomic<bool> loader_lock_held = false;
+
+    /**
+     * Compiled from `koaloader::config.hide_files`, or restored from the config snapshot
+     */
+    hide_matcher::Matcher hide_files_matcher;
+
+    struct TargetSelection {
+        bool targeted = false;
+        // Index into `koaloader::config.profiles` of the profile that was applied
+        std::optional<size_t> profile;
+    };
+
+    TargetSelection target_selection;
+
+    /**
+     * How the config was obtained, for logging once the logger is initialized
+     */
+    struct ConfigSource {
+        bool from_snapshot = false;
+        bool snapshot_stored = false;
+        std::chrono::microseconds duration{};
+    };
+
+    /**
+     * Maps each file and prefetches all views with a single `PrefetchVirtualMemory` call,
+     * which issues the reads concurrently and does not wait for them.
+     * Views stay mapped until the reader is destroyed, so that the prefetched pages
+     * remain cached until the modules have been loaded.
+     */
+    class PrefetchReader : public read_ahead::Reader {
+    public:
+        ~PrefetchReader() override {
+            for(const auto& range : ranges) {
+                UnmapViewOfFile(range.VirtualAddress);
+            }
         }
 
-        static const auto executable_path = kb::lib::get_fs_path(nullptr);
-        static const auto executable_name = kb::path::to_str(executable_path.filename());
+        uint64_t add(const fs::path& path) override {
+            auto* const file = CreateFileW(
+                path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+            );
+            if(file == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error(std::format("CreateFileW error: {}", GetLastError()));
+            }
+
+            LARGE_INTEGER size{};
+            if(not GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+                CloseHandle(file);
+                return 0;
+            }
 
-        bool target_found = false;
-        for(const auto& target : koaloader::config.targets) {
-            if(kb::str::eq(target, executable_name)) {
-                LOG_DEBUG("Target found: '{}'", target);
-                target_found = true;
-                break;
+            auto* const mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if(not mapping) {
+                throw std::runtime_error(std::format("CreateFileMappingW error: {}", GetLastError()));
             }
+
+            // The view keeps the mapping alive
+            auto* const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if(not view) {
+                throw std::runtime_error(std::format("MapViewOfFile error: {}", GetLastError()));
+            }
+
+            ranges.push_back({view, static_cast<SIZE_T>(size.QuadPart)});
+
+            return static_cast<uint64_t>(size.QuadPart);
         }
 
-        return target_found;
-    }
+        void start() override {
+            if(ranges.empty()) {
+                return;
+            }
 
-    std::set<std::string> generate_well_known_modules() {
-        const std::set<std::string> well_known_names{
-            "Unlocker",
-            "Lyptus",
-            "ScreamAPI",
-            "scream_api",
-            "SmokeAPI",
-            "smoke_api",
-            "UplayR1Unlocker",
-            "UplayR2Unlocker",
-            "KoaloaderA",
-            "KoaloaderB",
-            "KoaloaderC",
-        };
+            // Available since Windows 8
+            static const auto prefetch_virtual_memory = reinterpret_cast<decltype(&PrefetchVirtualMemory)>(
+                GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory")
+            );
 
-        std::set<std::string> well_known_modules;
+            if(not prefetch_virtual_memory) {
+                throw std::runtime_error("PrefetchVirtualMemory is not available");
+            }
 
-        for(const auto& name : well_known_names) {
-            well_known_modules.insert(name + ".dll");
-            well_known_modules.insert(std::format("{}{}.dll", name, kb::platform::bitness));
+            if(not prefetch_virtual_memory(GetCurrentProcess(), ranges.size(), ranges.data(), 0)) {
+                throw std::runtime_error(std::format("PrefetchVirtualMemory error: {}", GetLastError()));
+            }
         }
 
-        return well_known_modules;
-    }
+    private:
+        std::vector<WIN32_MEMORY_RANGE_ENTRY> ranges;
+    };
+
+    /**
+     * Holds the prefetched views of configured modules until they are loaded
+     */
+    std::unique_ptr<PrefetchReader> module_reader;
 
     void inject_module(const fs::path& path, const bool required) {
+        const startup_trace::Scope trace_scope("load " + kb::path::to_str(path.filename()), "module");
+
         try {
             kb::lib::load_or_throw(path);
 
@@ -89,87 +167,284 @@ namespace {
         }
     }
 
+    bool is_well_known_module(const fs::directory_entry& entry) {
+        // Checking the name first avoids any allocations and stat calls for the vast majority of files
+        if(not well_known_modules::CURRENT.contains_file_name_of(std::basic_string_view<fs::path::value_type>(entry.path().native()))) {
+            return false;
+        }
+
+        // Skip directories
+        if(entry.is_directory()) {
+            return false;
+        }
+
+        LOG_TRACE(R"(Found well-known module: "{}")", kb::path::to_str(entry.path()));
+
+        return true;
+    }
+
     /**
-     * Since `directory_iterator` and `recursive_directory_iterator`
-     * don't share a common interface, we have to use these dirty tricks
-     * to keep the code DRY.
+     * @return The first well-known module in the listing of the directory, without descending into subdirectories
      */
-    enum class ControlOperation { NO_OP, CONTINUE_OP, RETURN_OP };
-
-#define PROCESS_CONTROL_OPERATION(RESULT)                                                          \
-    switch (RESULT) {                                                                              \
-        case ControlOperation::CONTINUE_OP:                                                        \
-            continue;                                                                              \
-        case ControlOperation::RETURN_OP:                                                          \
-            return;                                                                                \
-        case ControlOperation::NO_OP: {                                                            \
-        };                                                                                         \
+    std::optional<fs::path> find_well_known_module_in(const fs::path& directory) {
+        for(const auto& entry : fs::directory_iterator(directory, DISCOVERY_DIRECTORY_OPTIONS)) {
+            if(is_well_known_module(entry)) {
+                return entry.path();
+            }
+        }
+
+        return std::nullopt;
     }
 
-    ControlOperation process_file(const std::filesystem::directory_entry& entry) {
-        LOG_TRACE(R"(Processing file: "{}")", kb::path::to_str(entry.path()));
+    struct Discovery {
+        std::optional<fs::path> module_path;
+        // Directories whose listing takes priority over subdirectories
+        std::vector<fs::path> searched_directories;
+        // Subdirectories that were listed completely, which a search without result depends on as well
+        std::vector<fs::path> walked_directories;
+        bool deadline_exceeded = false;
+    };
+
+    Discovery find_well_known_module(const fs::path& starting_directory) {
+        Discovery discovery;
+
+        // First try searching in parent directories
+        LOG_DEBUG("Searching in parent directories");
+
+        auto current = starting_directory;
+        fs::path previous;
+        do {
+            discovery.searched_directories.push_back(current);
+
+            if(auto module_path = find_well_known_module_in(current)) {
+                discovery.module_path = std::move(module_path);
+                return discovery;
+            }
+
+            previous = current;
+            current = current.parent_path();
+        } while(not equivalent(current, previous));
 
-        // Skip directories
-        if(entry.is_directory()) {
-            return ControlOperation::CONTINUE_OP;
+        // Then recursively go over all files in current working directory
+        const auto& config = koaloader::config;
+
+        directory_walker::Options options{
+            .thread_count = koaloader::get_worker_thread_count(4),
+            .directory_options = DISCOVERY_DIRECTORY_OPTIONS,
+            .max_depth = config.auto_load_max_depth,
+            .collect_listed_directories = true,
+        };
+
+        if(not config.auto_load_excluded_directories.empty()) {
+            options.is_excluded = [&](const fs::directory_entry& entry) {
+                const auto& name = entry.path().filename().native();
+                return std::ranges::any_of(config.auto_load_excluded_directories, [&](const std::string& pattern) {
+                    return wildcard::matches(pattern, std::basic_string_view<fs::path::value_type>(name));
+                });
+            };
+        }
+
+        if(config.auto_load_time_limit_ms > 0) {
+            options.deadline = std::chrono::steady_clock::now() +
+                               std::chrono::milliseconds(config.auto_load_time_limit_ms);
         }
 
-        const auto& path = entry.path();
+        LOG_DEBUG("Searching in subdirectories using {} thread(s)", options.thread_count);
 
-        // Skip files without filename
-        if(not path.has_filename()) {
-            return ControlOperation::CONTINUE_OP;
+        auto result = directory_walker::find_first(starting_directory, is_well_known_module, options);
+
+        LOG_INFO(
+            "Searched {} directories and {} files ({} excluded directories, {} directories beyond max depth)",
+            result.directories_visited, result.files_visited,
+            result.directories_excluded, result.directories_beyond_max_depth
+        );
+
+        if(result.deadline_exceeded) {
+            LOG_WARN(
+                "Search in subdirectories stopped after exceeding the time limit of {} ms. "
+                "Consider configuring 'auto_load_excluded_directories' or 'auto_load_max_depth'.",
+                config.auto_load_time_limit_ms
+            );
         }
 
-        // Skip non-DLLs
-        if(not kb::str::eq(path.extension().string(), ".dll")) {
-            return ControlOperation::CONTINUE_OP;
+        discovery.module_path = std::move(result.path);
+        discovery.walked_directories = std::move(result.listed_directories);
+        discovery.deadline_exceeded = result.deadline_exceeded;
+
+        return discovery;
+    }
+
+    /**
+     * Mirrors the search in parent directories of `find_well_known_module`.
+     * A search without result has also walked the subdirectories of the starting directory.
+     *
+     * @return Whether a search that resolved to the module listed the Koaloader directory
+     */
+    bool lists_self_directory(const fs::path& starting_directory, const std::optional<fs::path>& module_path) {
+        if(not module_path) {
+            const auto [mismatch, _] = std::mismatch(
+                starting_directory.begin(), starting_directory.end(), self_directory.begin(), self_directory.end()
+            );
+            if(mismatch == starting_directory.end()) {
+                return true;
+            }
         }
 
-        const auto filename = path.filename().string();
+        auto current = starting_directory;
+        fs::path previous;
+        do {
+            if(current == self_directory) {
+                return true;
+            }
 
-        const static auto well_known_modules = generate_well_known_modules();
+            if(module_path && module_path->parent_path() == current) {
+                return false;
+            }
 
-        for(const auto& dll : well_known_modules) {
-            if(kb::str::eq(filename, dll)) {
-                inject_module(path, true);
+            previous = current;
+            current = current.parent_path();
+        } while(current != previous);
 
-                return ControlOperation::RETURN_OP;
+        return false;
+    }
+
+    /**
+     * Koaloader creates its cache, snapshot and trace files in its own directory, which changes
+     * the modification time of the directory. Hence the Koaloader directory is validated
+     * by listing it again instead of by its stamp, which is still a single directory listing
+     * rather than the full search.
+     *
+     * @return Whether the listing of the Koaloader directory still leads to the cached result
+     */
+    bool is_self_directory_unchanged(const discovery_cache::Entry& entry) {
+        if(not lists_self_directory(entry.key.starting_directory, entry.module_path)) {
+            return true;
+        }
+
+        const auto& module_path = entry.module_path;
+        const auto expected = module_path && module_path->parent_path() == self_directory
+                                  ? module_path
+                                  : std::nullopt;
+
+        try {
+            return find_well_known_module_in(self_directory) == expected;
+        } catch(const std::exception& e) {
+            LOG_WARN("Failed to list the Koaloader directory: {}", e.what());
+            return false;
+        }
+    }
+
+    /**
+     * Consults the discovery cache before falling back to the full search.
+     * A cache entry stays valid while the module and every directory searched
+     * before the subdirectories keep their size and modification time,
+     * except for the Koaloader directory, which is validated by `is_self_directory_unchanged`.
+     * Searches that found nothing are cached as well, with the stamps of every directory that
+     * they listed, since a module may appear in any of them. Searches cut short by
+     * the time limit are not cached at all.
+     */
+    std::optional<fs::path> find_well_known_module_cached(const fs::path& starting_directory) {
+        const startup_trace::Scope trace_scope("auto_load discovery", "phase");
+
+        const auto cache_path = self_directory / CACHE_FILE_NAME;
+        const discovery_cache::Key key{
+            .executable_path = kb::lib::get_fs_path(nullptr),
+            .koaloader_directory = self_directory,
+            .starting_directory = starting_directory,
+            .max_depth = koaloader::config.auto_load_max_depth,
+            .excluded_directories = koaloader::config.auto_load_excluded_directories,
+            .time_limit_ms = koaloader::config.auto_load_time_limit_ms,
+        };
+
+        const auto lookup_start = std::chrono::steady_clock::now();
+        if(const auto entry = discovery_cache::lookup(cache_path, key); entry && is_self_directory_unchanged(*entry)) {
+            const auto lookup_time = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - lookup_start
+            );
+
+            if(entry->module_path) {
+                LOG_INFO(
+                    R"(Discovery cache hit: "{}" (validated in {} us, saved ~{} ms))",
+                    kb::path::to_str(*entry->module_path), lookup_time.count(), entry->scan_duration.count()
+                );
+            } else {
+                LOG_INFO(
+                    "Discovery cache hit: no well-known module (validated in {} us, saved ~{} ms)",
+                    lookup_time.count(), entry->scan_duration.count()
+                );
+            }
+
+            return entry->module_path;
+        }
+
+        LOG_DEBUG("Discovery cache miss. Performing full search.");
+
+        const auto scan_start = std::chrono::steady_clock::now();
+        auto discovery = find_well_known_module(starting_directory);
+        const auto& module_path = discovery.module_path;
+        const auto scan_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - scan_start
+        );
+
+        LOG_DEBUG("Full search took {} ms", scan_duration.count());
+
+        if(discovery.deadline_exceeded) {
+            LOG_DEBUG("Search was incomplete. Not updating discovery cache.");
+            return module_path;
+        }
+
+        try {
+            discovery_cache::Entry entry{.key = key, .module_path = module_path, .scan_duration = scan_duration};
+            entry.dependencies = std::move(discovery.searched_directories);
+            if(module_path) {
+                entry.dependencies.push_back(*module_path);
+            } else {
+                // The starting directory is both searched and walked
+                std::erase(discovery.walked_directories, starting_directory);
+                entry.dependencies.insert(
+                    entry.dependencies.end(), discovery.walked_directories.begin(), discovery.walked_directories.end()
+                );
             }
+            std::erase(entry.dependencies, self_directory);
+
+            discovery_cache::store(cache_path, entry);
+        } catch(const std::exception& e) {
+            LOG_WARN("Failed to update discovery cache: {}", e.what());
         }
 
-        return ControlOperation::NO_OP;
+        return module_path;
     }
 
-    void inject_modules(const fs::path& starting_directory) {
-        LOG_DEBUG(R"(Beginning search in "{}")", kb::path::to_str(starting_directory));
+    void report_startup_trace() {
+        const auto& trace = startup_trace::global();
 
-        if(koaloader::config.auto_load) {
-            LOG_INFO("Entering auto-loading mode");
+        LOG_INFO("Startup timings:");
+        for(const auto& line : trace.summary()) {
+            LOG_INFO("  {}", line);
+        }
 
-            static constexpr fs::directory_options dir_options =
-                fs::directory_options::follow_directory_symlink |
-                fs::directory_options::skip_permission_denied;
+        if(koaloader::config.trace_startup) {
+            const auto trace_path = self_directory / TRACE_FILE_NAME;
 
-            // First try searching in parent directories
-            LOG_DEBUG("Searching in parent directories");
+            try {
+                trace.write_chrome_json(trace_path);
+                LOG_INFO(R"(Startup trace written to "{}")", kb::path::to_str(trace_path));
+            } catch(const std::exception& e) {
+                LOG_WARN("Failed to write startup trace: {}", e.what());
+            }
+        }
+    }
 
-            auto current = starting_directory;
-            fs::path previous;
-            do {
-                for(const auto& entry : fs::directory_iterator(current, dir_options)) {
-                    PROCESS_CONTROL_OPERATION(process_file(entry))
-                }
+    void inject_modules(const fs::path& starting_directory) {
+        const startup_trace::Scope trace_scope("inject modules", "phase");
 
-                previous = current;
-                current = current.parent_path();
-            } while(not equivalent(current, previous));
+        LOG_DEBUG(R"(Beginning search in "{}")", kb::path::to_str(starting_directory));
 
-            // Then recursively go over all files in current working directory
-            LOG_DEBUG("Searching in subdirectories");
+        if(koaloader::config.auto_load) {
+            LOG_INFO("Entering auto-loading mode");
 
-            for(const auto& entry : fs::recursive_directory_iterator(starting_directory, dir_options)) {
-                PROCESS_CONTROL_OPERATION(process_file(entry))
+            if(const auto module_path = find_well_known_module_cached(starting_directory)) {
+                inject_module(*module_path, true);
             }
         } else {
             for(const auto& module : koaloader::config.modules) {
@@ -197,25 +472,353 @@ namespace {
             }
         }
     }
+
+    /**
+     * Starts reading all configured modules from disk at once, in every location they may be loaded from.
+     * The ordered loads that follow then find the modules in the page cache.
+     */
+    void read_ahead_modules() {
+        const auto& config = koaloader::config;
+
+        if(not config.enabled || not target_selection.targeted || config.auto_load || config.modules.empty()) {
+            return;
+        }
+
+        const startup_trace::Scope trace_scope("read ahead modules", "phase");
+
+        std::vector<fs::path> candidates;
+        for(const auto& module : config.modules) {
+            const auto path = kb::path::from_str(module.path);
+
+            if(path.is_absolute()) {
+                candidates.push_back(path);
+            } else {
+                candidates.push_back(absolute(path));
+                candidates.push_back(self_directory / path);
+            }
+        }
+
+        module_reader = std::make_unique<PrefetchReader>();
+        const auto summary = read_ahead::start_all(*module_reader, candidates);
+
+        for(const auto& result : summary.results) {
+            if(result.error) {
+                LOG_WARN(R"(Failed to read ahead "{}": {})", kb::path::to_str(result.path), *result.error);
+            }
+        }
+
+        if(summary.error) {
+            LOG_WARN("Failed to read ahead modules: {}", *summary.error);
+        } else {
+            LOG_DEBUG(
+                "Started read-ahead of {} module(s) ({} KiB)",
+                summary.results.size(), summary.total_size / 1024
+            );
+        }
+    }
+
+    const std::string& get_executable_name() {
+        static const auto executable_name = kb::path::to_str(kb::lib::get_fs_path(nullptr).filename());
+        return executable_name;
+    }
+
+    /**
+     * The snapshot holds the config as resolved for a single executable,
+     * so every executable that loads Koaloader gets its own.
+     */
+    fs::path get_snapshot_path() {
+        return self_directory / kb::path::from_str(std::format("Koaloader.{}.snapshot", get_executable_name()));
+    }
+
+    /**
+     * Decides whether the executable is a target, and applies the overrides of the first profile that targets it.
+     * Only the selected profile's patterns are compiled afterward.
+     */
+    TargetSelection select_target(koaloader::Config& config) {
+        const startup_trace::Scope trace_scope("match targets", "phase");
+
+        // Profiles take priority over the top-level targets, which form the last rule
+        std::vector<std::vector<std::string>> patterns_per_rule;
+        for(const auto& profile : config.profiles) {
+            patterns_per_rule.push_back(profile.targets);
+        }
+        patterns_per_rule.push_back(config.targets);
+
+        const target_rules::Rules rules(patterns_per_rule);
+        const auto rule = rules.find(get_executable_name());
+
+        if(not rule) {
+            return {.targeted = config.targets.empty()};
+        }
+
+        if(*rule == config.profiles.size()) {
+            return {.targeted = true};
+        }
+
+        const auto& profile = config.profiles[*rule];
+
+        if(profile.modules) {
+            config.modules = *profile.modules;
+        }
+        if(profile.hide_files) {
+            config.hide_files = *profile.hide_files;
+        }
+        if(profile.string_patches) {
+            config.string_patches = *profile.string_patches;
+        }
+
+        return {.targeted = true, .profile = *rule};
+    }
+
+    /**
+     * The config is stored as CBOR through its JSON conversions, so that every field of `koaloader::Config`
+     * is part of the snapshot without listing it here. Compiled patch signatures are not stored,
+     * since the patch cache already spares rescanning the sections of a known executable build.
+     */
+    std::string make_snapshot(
+        const koaloader::Config& config,
+        const TargetSelection& selection,
+        const hide_matcher::Matcher& matcher
+    ) {
+        config_snapshot::Writer writer;
+
+        writer.write(selection.targeted);
+        writer.write<int64_t>(selection.profile ? static_cast<int64_t>(*selection.profile) : -1);
+        writer.write_vector(nlohmann::json::to_cbor(nlohmann::json(config)));
+
+        matcher.save(writer);
+
+        return writer.data();
+    }
+
+    /**
+     * @throws std::runtime_error if the snapshot is truncated
+     * @throws nlohmann::json::exception if the stored config is malformed
+     */
+    void read_snapshot(
+        const std::string_view snapshot,
+        koaloader::Config& config,
+        TargetSelection& selection,
+        hide_matcher::Matcher& matcher
+    ) {
+        config_snapshot::Reader reader(snapshot);
+
+        selection.targeted = reader.read<bool>();
+        if(const auto profile = reader.read<int64_t>(); profile >= 0) {
+            selection.profile = static_cast<size_t>(profile);
+        }
+
+        config = nlohmann::json::from_cbor(reader.read_vector<uint8_t>()).get<koaloader::Config>();
+
+        matcher = hide_matcher::Matcher::load(reader);
+    }
+
+    std::string get_build_id() {
+        return std::format(
+            "{} {}{} {}-bit {}", PROJECT_NAME, PROJECT_VERSION, VERSION_SUFFIX, kb::platform::bitness, __TIMESTAMP__
+        );
+    }
+
+    /**
+     * Restores the config and the hide matcher from the snapshot if it matches the config file.
+     * Otherwise parses the config, compiles the matcher and stores a new snapshot if enabled.
+     */
+    ConfigSource load_config() {
+        const auto start = std::chrono::steady_clock::now();
+        const auto elapsed = [&] {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        };
+
+        auto& config = koaloader::config;
+
+        const auto snapshot_path = get_snapshot_path();
+        const auto build_id = get_build_id();
+
+        // Taken before parsing, so that an edit made in the meantime outdates the snapshot
+        const auto stamp = config_snapshot::get_stamp(kb::paths::get_config_path());
+
+        if(stamp) {
+            if(const auto snapshot = config_snapshot::load(snapshot_path, *stamp, build_id)) {
+                try {
+                    read_snapshot(*snapshot, config, target_selection, hide_files_matcher);
+                    return {.from_snapshot = true, .duration = elapsed()};
+                } catch(const std::exception&) {
+                    config = {};
+                    target_selection = {};
+                }
+            }
+        }
+
+        config = kb::config::parse<koaloader::Config>();
+        koaloader::validate_config(config);
+
+        target_selection = select_target(config);
+
+        {
+            const startup_trace::Scope trace_scope("compile hide patterns", "phase");
+
+            hide_files_matcher = hide_matcher::Matcher(config.hide_files);
+        }
+
+        ConfigSource source{.duration = elapsed()};
+
+        std::error_code ec;
+        if(not config.config_snapshot) {
+            fs::remove(snapshot_path, ec);
+        } else if(stamp) {
+            try {
+                config_snapshot::store(snapshot_path, *stamp, build_id, make_snapshot(config, target_selection, hide_files_matcher));
+                source.snapshot_stored = true;
+            } catch(const std::exception&) {
+                // Reported once the logger is initialized
+            }
+        }
+
+        return source;
+    }
+
+    void load_modules() {
+        const auto& config = koaloader::config;
+
+        if(config.enabled) {
+            if(target_selection.targeted) {
+                inject_modules(self_directory);
+
+                if(not loaded) {
+                    inject_modules(std::filesystem::absolute("."));
+                }
+            } else {
+                LOG_DEBUG("Not loaded by target process. Skipping injections.");
+            }
+        } else {
+            LOG_DEBUG("Koaloader is not enabled in config");
+        }
+
+        module_reader.reset();
+    }
+
+    void hide_files() {
+        const startup_trace::Scope trace_scope("hide files", "phase");
+
+        if(koaloader::config.hook_trace) {
+            file_api::record_hook_trace(self_directory / HOOK_TRACE_FILE_NAME);
+        }
+
+        file_api::hide_files(std::move(hide_files_matcher));
+    }
+
+    void patch_strings() {
+        const startup_trace::Scope trace_scope("patch strings", "phase");
+
+        patcher::patch_strings(self_directory / PATCH_CACHE_FILE_NAME);
+    }
+
+    /**
+     * Runs on a dedicated thread, which starts only once the loader lock has been released
+     */
+    void run_deferred_init() {
+        try {
+            std::optional<startup_trace::Scope> deferred_scope(std::in_place, "deferred init", "phase");
+
+            load_modules();
+            patch_strings();
+
+            deferred_scope.reset();
+            report_startup_trace();
+
+            LOG_INFO("Deferred initialization complete");
+        } catch(const std::exception& e) {
+            kb::util::panic(std::format("Deferred initialization error: {}", e.what()));
+        }
+    }
 }
 
 namespace koaloader {
     Config config{};
 
+    void validate_config(const Config& config) {
+        if(config.auto_load_max_depth < -1) {
+            throw std::invalid_argument("'auto_load_max_depth' must be -1 (unlimited) or greater");
+        }
+
+        for(const auto& pattern : config.auto_load_excluded_directories) {
+            if(pattern.empty()) {
+                throw std::invalid_argument("'auto_load_excluded_directories' must not contain empty patterns");
+            }
+        }
+
+        const auto is_empty = [](const std::string& target) { return target.empty(); };
+
+        if(std::ranges::any_of(config.targets, is_empty)) {
+            throw std::invalid_argument("'targets' must not contain empty names");
+        }
+
+        for(const auto& profile : config.profiles) {
+            if(profile.targets.empty() || std::ranges::any_of(profile.targets, is_empty)) {
+                throw std::invalid_argument("Every profile must have non-empty 'targets'");
+            }
+        }
+
+        if(config.init_mode != "eager" && config.init_mode != "deferred") {
+            throw std::invalid_argument("'init_mode' must be either 'eager' or 'deferred'");
+        }
+    }
+
+    bool is_loader_lock_held() {
+        return loader_lock_held;
+    }
+
+    size_t get_worker_thread_count(const size_t max_threads) {
+        if(is_loader_lock_held()) {
+            return 1;
+        }
+
+        return std::clamp<size_t>(std::thread::hardware_concurrency(), 1, std::max<size_t>(max_threads, 1));
+    }
+
     void init(const HMODULE self_module) {
+        // Called from DllMain
+        loader_lock_held = true;
+
+        const auto init_start = std::chrono::steady_clock::now();
+
         try {
+            std::optional<startup_trace::Scope> init_scope(std::in_place, "init", "phase");
+
             kb::globals::init_globals(self_module, PROJECT_NAME);
 
             self_directory = kb::lib::get_fs_path(self_module).parent_path();
 
-            config = kb::config::parse<Config>();
+            ConfigSource config_source;
+            {
+                const startup_trace::Scope trace_scope("load config", "phase");
+
+                config_source = load_config();
+            }
 
             if(config.logging) {
+                const startup_trace::Scope trace_scope("init logger", "phase");
+
                 kb::logger::init_file_logger(kb::paths::get_log_path());
             }
 
             LOG_INFO("{} v{}{} | Built at '{}'", PROJECT_NAME, PROJECT_VERSION, VERSION_SUFFIX, __TIMESTAMP__);
-            LOG_DEBUG("Parsed config:\n{}", nlohmann::ordered_json(config).dump(2));
+            LOG_INFO(
+                "{} config in {:.3f} ms{}",
+                config_source.from_snapshot ? "Loaded snapshot of" : "Parsed",
+                config_source.duration.count() / 1000.0,
+                config_source.snapshot_stored ? " and stored its snapshot" : ""
+            );
+            if(config.config_snapshot && not config_source.from_snapshot && not config_source.snapshot_stored) {
+                LOG_WARN("Failed to store config snapshot");
+            }
+            LOG_DEBUG("Config:\n{}", nlohmann::ordered_json(config).dump(2));
+
+            if(target_selection.profile) {
+                LOG_INFO("Applied profile #{} for '{}'", *target_selection.profile, get_executable_name());
+            } else if(target_selection.targeted) {
+                LOG_DEBUG("Target found: '{}'", get_executable_name());
+            }
 
             const auto exe_path = kb::lib::get_fs_path(nullptr);
 
@@ -230,31 +833,51 @@ namespace koaloader {
             );
             LOG_DEBUG(R"(Koaloader directory: "{}")", kb::path::to_str(self_directory));
 
-            if(config.enabled) {
-                if(is_loaded_by_target()) {
-                    inject_modules(self_directory);
+            read_ahead_modules();
 
-                    if(not loaded) {
-                        inject_modules(std::filesystem::absolute("."));
-                    }
-                } else {
-                    LOG_DEBUG("Not loaded by target process. Skipping injections.");
-                }
+            const auto deferred = config.init_mode == "deferred";
+
+            if(deferred) {
+                // Hooks must be in place before the game touches any files
+                hide_files();
+
+                std::thread(run_deferred_init).detach();
             } else {
-                LOG_DEBUG("Koaloader is not enabled in config");
+                load_modules();
+                hide_files();
+                patch_strings();
             }
 
-            file_api::hide_files();
+            init_scope.reset();
 
-            patcher::patch_strings();
+            LOG_INFO(
+                "Spent {:.3f} ms under the loader lock ({} initialization)",
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - init_start).count(),
+                config.init_mode
+            );
+
+            if(deferred) {
+                LOG_INFO("Loading modules and patching strings on a separate thread");
+            } else {
+                report_startup_trace();
 
-            LOG_INFO("Initialization complete");
+                LOG_INFO("Initialization complete");
+            }
         } catch(const std::exception& e) {
             kb::util::panic(std::format("Initialization error: {}", e.what()));
         }
+
+        loader_lock_held = false;
     }
 
     void shutdown() {
+        if(config.hook_stats) {
+            file_api::report_hook_stats();
+        }
+
+        file_api::stop_hook_trace();
+        file_api::stop_hook_log();
+
         LOG_INFO("Shutdown complete");
     }
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <optional>
 #include <set>
 #include <string>
 
@@ -17,26 +19,108 @@ namespace koaloader {
         std::string section;
         std::string pattern;
         std::string replacement;
+        /**
+         * One of `auto`, `literal`, `signature` or `regex`
+         */
+        std::string type = "auto";
 
-        NLOHMANN_DEFINE_TYPE_INTRUSIVE(Patch, section, pattern, replacement)
+        NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Patch, section, pattern, replacement, type)
+    };
+
+    /**
+     * Overrides of the top-level config for executables that match the targets of the profile
+     */
+    struct Profile {
+        std::vector<std::string> targets;
+        std::optional<std::vector<Module>> modules;
+        std::optional<std::set<std::string>> hide_files;
+        std::optional<std::vector<Patch>> string_patches;
+
+        // Absent overrides must remain distinguishable from empty ones, which the macros cannot express
+        template<typename BasicJsonType>
+        friend void to_json(BasicJsonType& json, const Profile& profile) {
+            json["targets"] = profile.targets;
+
+            if(profile.modules) {
+                json["modules"] = *profile.modules;
+            }
+            if(profile.hide_files) {
+                json["hide_files"] = *profile.hide_files;
+            }
+            if(profile.string_patches) {
+                json["string_patches"] = *profile.string_patches;
+            }
+        }
+
+        template<typename BasicJsonType>
+        friend void from_json(const BasicJsonType& json, Profile& profile) {
+            json.at("targets").get_to(profile.targets);
+
+            if(json.contains("modules")) {
+                profile.modules = json.at("modules").template get<std::vector<Module>>();
+            }
+            if(json.contains("hide_files")) {
+                profile.hide_files = json.at("hide_files").template get<std::set<std::string>>();
+            }
+            if(json.contains("string_patches")) {
+                profile.string_patches = json.at("string_patches").template get<std::vector<Patch>>();
+            }
+        }
     };
 
     struct Config {
         bool logging = false;
+        bool async_logging = false;
+        bool trace_startup = false;
+        bool hook_stats = false;
+        uint32_t hook_stats_interval_s = 0;
+        bool hook_trace = false;
         bool enabled = true;
+        /**
+         * Either `eager` or `deferred`
+         */
+        std::string init_mode = "eager";
+        bool config_snapshot = false;
         bool auto_load = true;
+        int auto_load_max_depth = -1;
+        std::vector<std::string> auto_load_excluded_directories;
+        uint32_t auto_load_time_limit_ms = 0;
         std::vector<std::string> targets;
         std::vector<Module> modules;
         std::set<std::string> hide_files;
         std::vector<Patch> string_patches;
+        std::vector<Profile> profiles;
 
         NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(
-            Config, logging, enabled, auto_load, targets, modules, hide_files, string_patches
+            Config, logging, async_logging, trace_startup, hook_stats, hook_stats_interval_s, hook_trace, enabled,
+            init_mode, config_snapshot, auto_load, auto_load_max_depth, auto_load_excluded_directories, auto_load_time_limit_ms,
+            targets, modules, hide_files, string_patches, profiles
         )
     };
 
     extern Config config;
 
+    /**
+     * Checks constraints that the JSON schema cannot express to the parser
+     *
+     * @throws std::invalid_argument
+     */
+    void validate_config(const Config& config);
+
+    /**
+     * @return true while Koaloader code executes inside DllMain
+     */
+    bool is_loader_lock_held();
+
+    /**
+     * Threads created under the loader lock cannot start until it is released,
+     * so work that waits for helper threads must run on the calling thread alone in that case.
+     *
+     * @param max_threads Upper bound for the caller's workload
+     * @return Number of threads, including the calling one, that parallel work may use
+     */
+    size_t get_worker_thread_count(size_t max_threads);
+
     void init(HMODULE self_module);
 
     void shutdown();
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+#include "patch_batch/patch_batch.hpp"
+
+namespace patch_batch {
+    Batch::Batch(const size_t page_size) : page_size(page_size) {
+        if(not std::has_single_bit(page_size)) {
+            throw std::invalid_argument("Page size must be a power of two");
+        }
+    }
+
+    void Batch::add(const uintptr_t address, const std::string_view bytes) {
+        writes.push_back({address, std::string(bytes)});
+    }
+
+    size_t Batch::size() const {
+        return writes.size();
+    }
+
+    std::vector<Range> Batch::ranges() const {
+        std::vector<Range> pages;
+        for(const auto& write : writes) {
+            if(write.bytes.empty()) {
+                continue;
+            }
+
+            const auto begin = write.address & ~(page_size - 1);
+            const auto end = (write.address + write.bytes.size() + page_size - 1) & ~(page_size - 1);
+            pages.push_back({begin, end - begin});
+        }
+
+        std::ranges::sort(pages, {}, &Range::address);
+
+        std::vector<Range> merged;
+        for(const auto& range : pages) {
+            if(not merged.empty() && range.address <= merged.back().address + merged.back().size) {
+                auto& last = merged.back();
+                last.size = std::max(last.address + last.size, range.address + range.size) - last.address;
+            } else {
+                merged.push_back(range);
+            }
+        }
+
+        return merged;
+    }
+
+    ApplyResult Batch::apply(MemoryProtector& protector) const {
+        ApplyResult result;
+        auto& errors = result.write_errors;
+        errors.resize(writes.size());
+
+        const auto merged_ranges = ranges();
+
+        std::vector<std::optional<Protection>> protections(merged_ranges.size());
+        for(size_t i = 0; i < merged_ranges.size(); ++i) {
+            try {
+                protections[i] = protector.unprotect(merged_ranges[i]);
+            } catch(const std::exception& e) {
+                const auto& range = merged_ranges[i];
+                for(size_t w = 0; w < writes.size(); ++w) {
+                    if(writes[w].address >= range.address && writes[w].address < range.address + range.size) {
+                        errors[w] = e.what();
+                    }
+                }
+            }
+        }
+
+        for(size_t w = 0; w < writes.size(); ++w) {
+            if(not errors[w] && not writes[w].bytes.empty()) {
+                const auto& write = writes[w];
+                std::memcpy(reinterpret_cast<void*>(write.address), write.bytes.data(), write.bytes.size());
+            }
+        }
+
+        for(size_t i = 0; i < merged_ranges.size(); ++i) {
+            if(protections[i]) {
+                // Writes have already been applied, so a failure to restore is not attributed to them
+                try {
+                    protector.restore(merged_ranges[i], *protections[i]);
+                } catch(const std::exception& e) {
+                    result.restore_errors.emplace_back(e.what());
+                }
+            }
+        }
+
+        return result;
+    }
+}
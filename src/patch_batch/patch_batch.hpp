@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Batched application of memory patches.
+ *
+ * Pending writes are collected first and their pages merged into contiguous ranges,
+ * so that protection is changed once per range rather than once per write,
+ * and a page hit by several writes is made writable only once.
+ * Each merged range is restored to the protection it had before, as reported
+ * for the whole range, so a batch should only cover memory with uniform
+ * protection, such as a single section.
+ */
+namespace patch_batch {
+    /**
+     * Opaque protection value, such as `PAGE_READONLY` or `PROT_READ`
+     */
+    using Protection = uint64_t;
+
+    struct Range {
+        uintptr_t address = 0;
+        size_t size = 0;
+
+        bool operator==(const Range&) const = default;
+    };
+
+    /**
+     * Platform-specific protection change, such as `VirtualProtect` or `mprotect`
+     */
+    class MemoryProtector {
+    public:
+        virtual ~MemoryProtector() = default;
+
+        /**
+         * Makes a page-aligned range writable
+         *
+         * @return Previous protection of the range
+         * @throws std::runtime_error
+         */
+        virtual Protection unprotect(const Range& range) = 0;
+
+        /**
+         * @throws std::runtime_error
+         */
+        virtual void restore(const Range& range, Protection protection) = 0;
+    };
+
+    struct ApplyResult {
+        // Error message for each write that was skipped, in the order writes were added
+        std::vector<std::optional<std::string>> write_errors;
+        // Ranges that were written but could not be restored to their previous protection
+        std::vector<std::string> restore_errors;
+    };
+
+    class Batch {
+    public:
+        /**
+         * @param page_size Must be a power of two
+         */
+        explicit Batch(size_t page_size);
+
+        /**
+         * Writes are applied in the order they were added, so later writes win where they overlap
+         */
+        void add(uintptr_t address, std::string_view bytes);
+
+        [[nodiscard]] size_t size() const;
+
+        /**
+         * @return Page-aligned ranges covering all writes, sorted and with adjacent pages merged
+         */
+        [[nodiscard]] std::vector<Range> ranges() const;
+
+        /**
+         * Writes to ranges whose protection cannot be changed are skipped
+         */
+        [[nodiscard]] ApplyResult apply(MemoryProtector& protector) const;
+
+    private:
+        struct Write {
+            uintptr_t address;
+            std::string bytes;
+        };
+
+        size_t page_size;
+        std::vector<Write> writes;
+    };
+}
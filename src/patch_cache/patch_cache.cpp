@@ -0,0 +1,165 @@
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "patch_cache/patch_cache.hpp"
+#include "utf8_path/utf8_path.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+    using namespace patch_cache;
+
+    // Version 2 added occurrences of repeated patterns
+    constexpr auto HEADER = "koaloader-patch-cache 2";
+
+    struct Record {
+        Identity identity;
+        Offsets offsets;
+    };
+
+    /**
+     * Patterns may contain any bytes, including line breaks, so they are stored as hex
+     */
+    std::string to_hex(const std::string& str) {
+        constexpr auto DIGITS = "0123456789abcdef";
+
+        std::string hex;
+        hex.reserve(str.size() * 2);
+        for(const auto c : str) {
+            hex += DIGITS[static_cast<uint8_t>(c) >> 4];
+            hex += DIGITS[static_cast<uint8_t>(c) & 0xF];
+        }
+
+        // Keeps empty fields parsable
+        return hex.empty() ? "-" : hex;
+    }
+
+    std::string from_hex(const std::string& hex) {
+        if(hex == "-") {
+            return {};
+        }
+
+        if(hex.size() % 2 != 0) {
+            throw std::invalid_argument("Odd number of hex digits");
+        }
+
+        std::string str;
+        str.reserve(hex.size() / 2);
+        for(size_t i = 0; i < hex.size(); i += 2) {
+            str += static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16));
+        }
+
+        return str;
+    }
+
+    /**
+     * Line-based format:
+     *
+     * exe <timestamp> <size_of_image> <checksum>
+     * patch <offset> <occurrence> <section hex> <type hex> <pattern hex>
+     * end
+     */
+    std::vector<Record> read_records(const fs::path& cache_path) {
+        std::ifstream file(cache_path);
+        std::string line;
+
+        if(not std::getline(file, line) || line != HEADER) {
+            return {};
+        }
+
+        std::vector<Record> records;
+        std::optional<Record> current;
+
+        while(std::getline(file, line)) {
+            if(not line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+
+            std::istringstream stream(line);
+            std::string field;
+            stream >> field;
+
+            if(field == "exe") {
+                current.emplace();
+                stream >> current->identity.timestamp >> current->identity.size_of_image >> current->identity.checksum;
+            } else if(not current) {
+                return {};
+            } else if(field == "patch") {
+                size_t offset = 0;
+                size_t occurrence = 0;
+                std::string section;
+                std::string type;
+                std::string pattern;
+                stream >> offset >> occurrence >> section >> type >> pattern;
+
+                if(stream) {
+                    current->offsets[{from_hex(section), from_hex(type), from_hex(pattern), occurrence}] = offset;
+                }
+            } else if(field == "end") {
+                records.push_back(std::move(*current));
+                current.reset();
+                continue;
+            } else {
+                return {};
+            }
+
+            if(stream.fail()) {
+                return {};
+            }
+        }
+
+        return records;
+    }
+
+    std::vector<Record> try_read_records(const fs::path& cache_path) {
+        try {
+            return read_records(cache_path);
+        } catch(const std::exception&) {
+            // Corrupted numbers or hex strings are treated like a missing cache
+            return {};
+        }
+    }
+}
+
+namespace patch_cache {
+    Offsets lookup(const fs::path& cache_path, const Identity& identity) {
+        for(auto& record : try_read_records(cache_path)) {
+            if(record.identity == identity) {
+                return std::move(record.offsets);
+            }
+        }
+
+        return {};
+    }
+
+    void store(const fs::path& cache_path, const Identity& identity, const Offsets& offsets) {
+        auto records = try_read_records(cache_path);
+        std::erase_if(records, [&](const Record& record) { return record.identity == identity; });
+        records.push_back({identity, offsets});
+
+        std::ofstream file(cache_path, std::ios::out | std::ios::trunc);
+        if(not file) {
+            throw std::runtime_error("Failed to open " + utf8_path::to_utf8(cache_path) + " for writing");
+        }
+
+        file << HEADER << '\n';
+
+        for(const auto& record : records) {
+            file << "exe " << record.identity.timestamp << ' ' << record.identity.size_of_image << ' '
+                 << record.identity.checksum << '\n';
+
+            for(const auto& [key, offset] : record.offsets) {
+                file << "patch " << offset << ' ' << key.occurrence << ' ' << to_hex(key.section) << ' '
+                     << to_hex(key.type) << ' ' << to_hex(key.pattern) << '\n';
+            }
+
+            file << "end\n";
+        }
+
+        if(not file.flush()) {
+            throw std::runtime_error("Failed to write " + utf8_path::to_utf8(cache_path));
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+
+/**
+ * Persistent cache of string patch offsets.
+ *
+ * Offsets are remembered per executable identity, taken from its PE headers,
+ * so that a warm launch of an unchanged executable only has to verify
+ * a few bytes at each cached offset instead of scanning whole sections.
+ */
+namespace patch_cache {
+    namespace fs = std::filesystem;
+
+    struct Identity {
+        uint32_t timestamp = 0;
+        uint32_t size_of_image = 0;
+        uint32_t checksum = 0;
+
+        bool operator==(const Identity&) const = default;
+    };
+
+    struct PatchKey {
+        std::string section;
+        std::string type;
+        std::string pattern;
+        // Tells apart patches that repeat the same pattern, which resolve to successive matches
+        size_t occurrence = 0;
+
+        auto operator<=>(const PatchKey&) const = default;
+    };
+
+    /**
+     * Offsets of the match of each patch, relative to the start of its section
+     */
+    using Offsets = std::map<PatchKey, size_t>;
+
+    /**
+     * Corrupted or missing cache files are treated as empty.
+     */
+    Offsets lookup(const fs::path& cache_path, const Identity& identity);
+
+    /**
+     * Replaces any previous offsets of the same executable.
+     *
+     * @throws std::runtime_error if the cache file cannot be written
+     */
+    void store(const fs::path& cache_path, const Identity& identity, const Offsets& offsets);
+}
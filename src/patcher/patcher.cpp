@@ -1,66 +1,383 @@
+#include <algorithm>
+#include <format>
+#include <map>
+#include <optional>
+#include <ranges>
 #include <regex>
+#include <stdexcept>
+#include <vector>
 
-#include <polyhook2/MemProtector.hpp>
+#include <polyhook2/MemAccessor.hpp>
 
 #include "koalabox/lib.hpp"
 #include "koalabox/logger.hpp"
 #include "koalabox/patcher.hpp"
 
+#include "byte_scanner/byte_scanner.hpp"
+#include "patch_batch/patch_batch.hpp"
+#include "patch_cache/patch_cache.hpp"
 #include "patcher/patcher.hpp"
 #include "koaloader/koaloader.hpp"
+#include "startup_trace/startup_trace.hpp"
 
 namespace {
     namespace kb = koalabox;
 
-    void patch_string(koaloader::Patch patch) {
-        try {
-            auto* const current_process_handle = kb::lib::get_exe_handle();
-            const auto section = kb::lib::get_section_or_throw(current_process_handle, patch.section);
+    struct PatchResult {
+        std::optional<size_t> offset;
+        std::optional<std::string> error;
+        bool cached = false;
+    };
 
-            const std::string_view section_str_view(static_cast<char*>(section.start_address), section.size);
-            const std::regex regex_pattern(patch.pattern);
+    bool has_regex_syntax(const std::string_view pattern) {
+        return pattern.find_first_of(R"(\^$.|?*+()[]{})") != std::string_view::npos;
+    }
+
+    /**
+     * @return Signature of the patch, or nothing if the patch is a regular expression
+     */
+    std::optional<byte_scanner::Signature> get_signature(const koaloader::Patch& patch) {
+        auto type = patch.type;
+
+        // Patterns without any regex syntax match exactly the same bytes as a literal
+        if(type == "auto") {
+            type = has_regex_syntax(patch.pattern) ? "regex" : "literal";
+        }
+
+        if(type == "literal") {
+            return byte_scanner::Signature::literal(patch.pattern);
+        }
+
+        if(type == "signature") {
+            return byte_scanner::Signature::parse(patch.pattern);
+        }
+
+        if(type == "regex") {
+            return std::nullopt;
+        }
+
+        throw std::invalid_argument("Unknown pattern type: " + patch.type);
+    }
+
+    /**
+     * Patches that repeat the same pattern in a section are told apart by their occurrence
+     *
+     * @return Cache key of every patch in the config
+     */
+    std::vector<patch_cache::PatchKey> get_cache_keys(const std::vector<koaloader::Patch>& patches) {
+        std::map<patch_cache::PatchKey, size_t> occurrences;
+        std::vector<patch_cache::PatchKey> keys;
 
+        for(const auto& patch : patches) {
+            patch_cache::PatchKey key{patch.section, patch.type, patch.pattern};
+            key.occurrence = occurrences[key]++;
+            keys.push_back(std::move(key));
+        }
+
+        return keys;
+    }
+
+    /**
+     * The executable identity is read from its PE headers, which are mapped with the image
+     */
+    patch_cache::Identity get_exe_identity(HMODULE exe_handle) {
+        const auto* const base = reinterpret_cast<const uint8_t*>(exe_handle);
+        const auto* const dos_header = reinterpret_cast<const IMAGE_DOS_HEADER*>(base);
+        const auto* const nt_headers = reinterpret_cast<const IMAGE_NT_HEADERS*>(base + dos_header->e_lfanew);
+
+        return {
+            .timestamp = nt_headers->FileHeader.TimeDateStamp,
+            .size_of_image = nt_headers->OptionalHeader.SizeOfImage,
+            .checksum = nt_headers->OptionalHeader.CheckSum,
+        };
+    }
+
+    /**
+     * Guards against executables that share an identity despite different contents
+     *
+     * @return true if the patch still matches at the cached offset
+     */
+    bool verify_cached_offset(
+        const koaloader::Patch& patch,
+        const std::optional<byte_scanner::Signature>& signature,
+        const std::string_view section,
+        const size_t offset
+    ) {
+        if(signature) {
+            return signature->matches_at(section, offset);
+        }
+
+        if(offset > section.size()) {
+            return false;
+        }
+
+        const std::regex regex_pattern(patch.pattern);
+        std::match_results<std::string_view::const_iterator> m;
+        return std::regex_search(
+            section.begin() + static_cast<ptrdiff_t>(offset), section.end(), m, regex_pattern,
+            std::regex_constants::match_continuous
+        );
+    }
+
+    /**
+     * Repeated patches resolve to successive matches that do not overlap,
+     * like `byte_scanner::SignatureSet` does for repeated signatures
+     *
+     * @param patch_indices Indices of patches that share the same regular expression
+     */
+    void find_regex(
+        const std::vector<size_t>& patch_indices,
+        const std::string_view section,
+        std::vector<PatchResult>& results
+    ) {
+        const auto& pattern = koaloader::config.string_patches[patch_indices.front()].pattern;
+        LOG_DEBUG(R"({} -> Searching "{}" using std::regex)", __func__, pattern);
+
+        const std::regex regex_pattern(pattern);
+
+        auto begin = section.begin();
+        for(const auto index : patch_indices) {
             std::match_results<std::string_view::const_iterator> m;
-            if(std::regex_search(section_str_view.begin(), section_str_view.end(), m, regex_pattern)) {
-                char* match_start = static_cast<char*>(section.start_address) + m.position(0);
-                LOG_INFO(
+            if(not std::regex_search(begin, section.end(), m, regex_pattern)) {
+                return;
+            }
+
+            const auto match_start = m[0].first;
+            results[index].offset = static_cast<size_t>(match_start - section.begin());
+
+            // Empty matches still advance, so that the next patch cannot resolve to the same offset
+            begin = m[0].second == match_start && match_start != section.end() ? match_start + 1 : m[0].second;
+        }
+    }
+
+    /**
+     * Changes protection via PolyHook, which wraps `VirtualProtect`
+     */
+    class PolyHookProtector : public patch_batch::MemoryProtector {
+    public:
+        patch_batch::Protection unprotect(const patch_batch::Range& range) override {
+            bool status = false;
+            const auto previous = accessor.mem_protect(range.address, range.size, PLH::ProtFlag::RWX, status);
+
+            if(not status) {
+                throw std::runtime_error(
+                    std::format("Failed to unprotect {} bytes at {:#x}", range.size, range.address)
+                );
+            }
+
+            return static_cast<patch_batch::Protection>(previous);
+        }
+
+        void restore(const patch_batch::Range& range, const patch_batch::Protection protection) override {
+            bool status = false;
+            accessor.mem_protect(range.address, range.size, static_cast<PLH::ProtFlag>(protection), status);
+
+            if(not status) {
+                throw std::runtime_error(std::format("Failed to restore protection of {:#x}", range.address));
+            }
+        }
+
+    private:
+        PLH::MemAccessor accessor;
+    };
+
+    size_t get_page_size() {
+        SYSTEM_INFO system_info{};
+        GetSystemInfo(&system_info);
+        return system_info.dwPageSize;
+    }
+
+    /**
+     * Verifies cached offsets and finds all remaining patches of a section in a single pass over it.
+     * Only then applies them in a batch, so that a patch never matches bytes written by another patch.
+     *
+     * Patches that repeat the same pattern form a group, whose offsets are only taken
+     * from the cache together, since every one of them depends on the match of the previous one.
+     *
+     * @param patch_indices Indices of patches in the config that target the section
+     */
+    void patch_section(
+        HMODULE exe_handle,
+        const std::string& section_name,
+        const std::vector<size_t>& patch_indices,
+        const std::vector<patch_cache::PatchKey>& cache_keys,
+        const patch_cache::Offsets& cached_offsets,
+        std::vector<PatchResult>& results
+    ) {
+        const auto& patches = koaloader::config.string_patches;
+
+        const auto section = kb::lib::get_section_or_throw(exe_handle, section_name);
+        const std::string_view section_view(static_cast<char*>(section.start_address), section.size);
+
+        // Groups of patches with the same pattern, in the order of their occurrences
+        std::map<patch_cache::PatchKey, std::vector<size_t>> groups;
+        for(const auto index : patch_indices) {
+            auto key = cache_keys[index];
+            key.occurrence = 0;
+            groups[key].push_back(index);
+        }
+
+        std::vector<byte_scanner::Signature> signatures;
+        std::vector<size_t> signature_patch_indices;
+        std::vector<std::vector<size_t>> regex_groups;
+
+        for(const auto& group : groups | std::views::values) {
+            try {
+                const auto signature = get_signature(patches[group.front()]);
+
+                const auto all_cached = std::ranges::all_of(group, [&](const size_t index) {
+                    const auto cached = cached_offsets.find(cache_keys[index]);
+                    return cached != cached_offsets.end() &&
+                           verify_cached_offset(patches[index], signature, section_view, cached->second);
+                });
+
+                if(all_cached) {
+                    for(const auto index : group) {
+                        results[index].offset = cached_offsets.at(cache_keys[index]);
+                        results[index].cached = true;
+                    }
+                } else if(signature) {
+                    for(const auto index : group) {
+                        signatures.push_back(*signature);
+                        signature_patch_indices.push_back(index);
+                    }
+                } else {
+                    regex_groups.push_back(group);
+                }
+            } catch(const std::exception& e) {
+                for(const auto index : group) {
+                    results[index].error = e.what();
+                }
+            }
+        }
+
+        if(not signatures.empty()) {
+            const startup_trace::Scope trace_scope(std::format("scan section {}", section_name), "patch");
+
+            const byte_scanner::SignatureSet signature_set(std::move(signatures));
+            const auto offsets = signature_set.find_all_parallel(section_view, koaloader::get_worker_thread_count(16));
+
+            for(size_t i = 0; i < offsets.size(); ++i) {
+                results[signature_patch_indices[i]].offset = offsets[i];
+            }
+        }
+
+        for(const auto& group : regex_groups) {
+            const startup_trace::Scope trace_scope(std::format("regex patch #{}", group.front()), "patch");
+
+            try {
+                find_regex(group, section_view, results);
+            } catch(const std::exception& e) {
+                for(const auto index : group) {
+                    results[index].error = e.what();
+                }
+            }
+        }
+
+        // Apply all matches at once, changing protection once per range of pages
+        static const auto page_size = get_page_size();
+        patch_batch::Batch batch(page_size);
+        std::vector<size_t> batch_patch_indices;
+
+        for(const auto index : patch_indices) {
+            if(const auto& offset = results[index].offset) {
+                const auto& patch = patches[index];
+                auto* const match_start = static_cast<char*>(section.start_address) + *offset;
+
+                LOG_DEBUG(
                     R"({} -> Patching "{}" found at {:#x})",
                     __func__, patch.pattern, reinterpret_cast<uintptr_t>(match_start)
                 );
 
-                // Enable writing to the memory section
-                static auto accessor = PLH::MemAccessor();
-                const PLH::MemoryProtector protector(
-                    reinterpret_cast<uint64_t>(match_start),
-                    patch.replacement.size(),
-                    PLH::ProtFlag::RWX,
-                    accessor,
-                    true
-                );
+                batch.add(reinterpret_cast<uintptr_t>(match_start), patch.replacement);
+                batch_patch_indices.push_back(index);
+            }
+        }
 
-                std::memcpy(match_start, patch.replacement.c_str(), patch.replacement.size());
-            } else {
-                LOG_WARN(
-                    R"({} -> Pattern "{}" not found in section "{}")",
-                    __func__, patch.pattern, patch.section
-                );
+        const startup_trace::Scope trace_scope(std::format("apply patches to {}", section_name), "patch");
+
+        PolyHookProtector protector;
+        const auto batch_result = batch.apply(protector);
+
+        LOG_DEBUG(
+            R"({} -> Applied {} patches to section "{}" using {} protection change(s))",
+            __func__, batch.size(), section_name, batch.ranges().size()
+        );
+
+        for(size_t i = 0; i < batch_patch_indices.size(); ++i) {
+            if(const auto& error = batch_result.write_errors[i]) {
+                results[batch_patch_indices[i]].error = *error;
             }
-        } catch(const std::exception& e) {
-            LOG_ERROR("{} -> Error: {}", __func__, e.what());
+        }
+
+        for(const auto& error : batch_result.restore_errors) {
+            LOG_WARN(R"({} -> Section "{}": {})", __func__, section_name, error);
         }
     }
 }
 
 namespace patcher {
-    void patch_strings() {
-        if(koaloader::config.string_patches.empty()) {
+    void patch_strings(const std::filesystem::path& cache_path) {
+        const auto& patches = koaloader::config.string_patches;
+
+        if(patches.empty()) {
             return;
         }
 
-        LOG_INFO("Patching strings...");
+        LOG_INFO("Patching strings using {} byte scanner...", byte_scanner::to_string(byte_scanner::best_isa()));
+
+        // Group patches by section, preserving their order within each section
+        std::map<std::string, std::vector<size_t>> patches_by_section;
+        for(size_t i = 0; i < patches.size(); ++i) {
+            patches_by_section[patches[i].section].push_back(i);
+        }
+
+        std::vector<PatchResult> results(patches.size());
+        const auto cache_keys = get_cache_keys(patches);
+
+        auto* const exe_handle = kb::lib::get_exe_handle();
+        const auto identity = get_exe_identity(exe_handle);
+        const auto cached_offsets = patch_cache::lookup(cache_path, identity);
+
+        for(const auto& [section_name, patch_indices] : patches_by_section) {
+            try {
+                patch_section(exe_handle, section_name, patch_indices, cache_keys, cached_offsets, results);
+            } catch(const std::exception& e) {
+                for(const auto index : patch_indices) {
+                    results[index].error = e.what();
+                }
+            }
+        }
+
+        for(size_t i = 0; i < patches.size(); ++i) {
+            const auto& patch = patches[i];
+            const auto& result = results[i];
+
+            if(result.error) {
+                LOG_ERROR(R"(Patch #{} "{}" failed: {})", i, patch.pattern, *result.error);
+            } else if(result.offset) {
+                LOG_INFO(
+                    R"(Patch #{} "{}" applied at offset {:#x} of section "{}"{})",
+                    i, patch.pattern, *result.offset, patch.section, result.cached ? " (cached)" : ""
+                );
+            } else {
+                LOG_WARN(R"(Patch #{} "{}" not found in section "{}")", i, patch.pattern, patch.section);
+            }
+        }
+
+        patch_cache::Offsets found_offsets;
+        for(size_t i = 0; i < patches.size(); ++i) {
+            if(results[i].offset) {
+                found_offsets[cache_keys[i]] = *results[i].offset;
+            }
+        }
 
-        for(const auto& patch : koaloader::config.string_patches) {
-            patch_string(patch);
+        if(found_offsets != cached_offsets) {
+            try {
+                patch_cache::store(cache_path, identity, found_offsets);
+            } catch(const std::exception& e) {
+                LOG_WARN("Failed to update patch cache: {}", e.what());
+            }
         }
 
         LOG_INFO("Patching strings complete");
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <filesystem>
+
 namespace patcher {
-    void patch_strings();
+    /**
+     * @param cache_path File that remembers patch offsets between launches of the same executable
+     */
+    void patch_strings(const std::filesystem::path& cache_path);
 }
@@ -0,0 +1,46 @@
+#include <set>
+#include <system_error>
+
+#include "read_ahead/read_ahead.hpp"
+
+namespace read_ahead {
+    namespace fs = std::filesystem;
+
+    Summary start_all(Reader& reader, const std::vector<fs::path>& candidates) {
+        Summary summary;
+        std::set<fs::path> seen;
+
+        for(const auto& candidate : candidates) {
+            std::error_code error;
+            if(not fs::is_regular_file(candidate, error)) {
+                continue;
+            }
+
+            auto path = fs::weakly_canonical(candidate, error);
+            if(error) {
+                path = candidate;
+            }
+
+            if(not seen.insert(path).second) {
+                continue;
+            }
+
+            auto& result = summary.results.emplace_back(Result{.path = path});
+
+            try {
+                result.size = reader.add(path);
+                summary.total_size += result.size;
+            } catch(const std::exception& e) {
+                result.error = e.what();
+            }
+        }
+
+        try {
+            reader.start();
+        } catch(const std::exception& e) {
+            summary.error = e.what();
+        }
+
+        return summary;
+    }
+}
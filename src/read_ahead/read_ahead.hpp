@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Read-ahead of files that are about to be loaded.
+ *
+ * The OS is asked to read every file into its page cache at once,
+ * without waiting for any of the reads, so that the latency of the disk
+ * overlaps across files instead of adding up when they are loaded one by one.
+ * No threads are involved, which keeps read-ahead usable under the loader lock.
+ */
+namespace read_ahead {
+    /**
+     * Platform-specific read-ahead, such as `PrefetchVirtualMemory` or `posix_fadvise`
+     */
+    class Reader {
+    public:
+        virtual ~Reader() = default;
+
+        /**
+         * Queues read-ahead of an entire file. The reader may already issue the read at this point.
+         *
+         * @return Size of the file in bytes
+         * @throws std::runtime_error
+         */
+        virtual uint64_t add(const std::filesystem::path& path) = 0;
+
+        /**
+         * Issues every queued read-ahead that has not been issued yet, without waiting for completion
+         *
+         * @throws std::runtime_error
+         */
+        virtual void start() = 0;
+    };
+
+    struct Result {
+        std::filesystem::path path;
+        uint64_t size = 0;
+        std::optional<std::string> error{};
+    };
+
+    struct Summary {
+        // One result per distinct existing file, in the order of the candidates
+        std::vector<Result> results;
+        uint64_t total_size = 0;
+        // Set if the reader failed to issue the queued reads
+        std::optional<std::string> error;
+    };
+
+    /**
+     * Starts read-ahead of every candidate that is an existing regular file.
+     * Missing files are skipped silently, since candidates may include alternative locations
+     * of the same module. Duplicates are read only once.
+     */
+    Summary start_all(Reader& reader, const std::vector<std::filesystem::path>& candidates);
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "startup_trace/startup_trace.hpp"
+
+namespace {
+    using namespace startup_trace;
+
+    std::atomic<uint32_t> next_thread_id = 0;
+    thread_local const uint32_t current_thread_id = next_thread_id++;
+    thread_local uint32_t current_depth = 0;
+
+    double to_microseconds(const Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    void write_json_string(std::ostream& stream, const std::string& str) {
+        stream << '"';
+        for(const auto c : str) {
+            switch(c) {
+            case '"':
+                stream << "\\\"";
+                break;
+            case '\\':
+                stream << "\\\\";
+                break;
+            case '\n':
+                stream << "\\n";
+                break;
+            case '\r':
+                stream << "\\r";
+                break;
+            case '\t':
+                stream << "\\t";
+                break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20) {
+                    stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                           << std::dec << std::setfill(' ');
+                } else {
+                    stream << c;
+                }
+            }
+        }
+        stream << '"';
+    }
+}
+
+namespace startup_trace {
+    Trace::Trace() : origin(Clock::now()) {}
+
+    void Trace::record(Event event) {
+        const std::lock_guard lock(mutex);
+        recorded_events.push_back(std::move(event));
+    }
+
+    std::vector<Event> Trace::events() const {
+        auto events = [&] {
+            const std::lock_guard lock(mutex);
+            return recorded_events;
+        }();
+
+        // Scopes are recorded when they end, so enclosing scopes come after the scopes they contain
+        std::ranges::stable_sort(events, [](const Event& a, const Event& b) {
+            return a.start != b.start ? a.start < b.start : a.depth < b.depth;
+        });
+
+        return events;
+    }
+
+    std::vector<std::string> Trace::summary() const {
+        std::vector<std::string> lines;
+
+        for(const auto& event : events()) {
+            std::ostringstream line;
+            line << std::string(event.depth * 2, ' ') << event.name << ": " << std::fixed << std::setprecision(3)
+                 << to_microseconds(event.duration) / 1000 << " ms";
+
+            if(event.thread_id != 0) {
+                line << " [thread " << event.thread_id << ']';
+            }
+
+            lines.push_back(line.str());
+        }
+
+        return lines;
+    }
+
+    std::string Trace::to_chrome_json() const {
+        std::ostringstream json;
+        json << std::fixed << std::setprecision(3);
+        json << R"({"displayTimeUnit":"ms","traceEvents":[)";
+
+        bool first = true;
+        for(const auto& event : events()) {
+            json << (first ? "\n" : ",\n");
+            first = false;
+
+            json << R"({"name":)";
+            write_json_string(json, event.name);
+            json << R"(,"cat":)";
+            write_json_string(json, event.category);
+            json << R"(,"ph":"X","ts":)" << to_microseconds(event.start - origin)
+                 << R"(,"dur":)" << to_microseconds(event.duration)
+                 << R"(,"pid":1,"tid":)" << event.thread_id << '}';
+        }
+
+        json << "\n]}\n";
+
+        return json.str();
+    }
+
+    void Trace::write_chrome_json(const std::filesystem::path& path) const {
+        std::ofstream file(path, std::ios::out | std::ios::trunc);
+        if(not file) {
+            throw std::runtime_error("Failed to open trace file for writing");
+        }
+
+        file << to_chrome_json();
+
+        if(not file.flush()) {
+            throw std::runtime_error("Failed to write trace file");
+        }
+    }
+
+    Trace& global() {
+        static Trace trace;
+        return trace;
+    }
+
+    Scope::Scope(std::string name, std::string category, Trace& trace) :
+        trace(trace),
+        event{
+            .name = std::move(name),
+            .category = std::move(category),
+            .start = Clock::now(),
+            .thread_id = current_thread_id,
+            .depth = current_depth++,
+        } {}
+
+    Scope::~Scope() {
+        event.duration = Clock::now() - event.start;
+        --current_depth;
+
+        trace.record(std::move(event));
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Lightweight tracing of startup phases.
+ *
+ * Scopes record their duration with a monotonic clock into a trace,
+ * which can be summarized in the log or exported in the Chrome trace event format
+ * that `chrome://tracing` and https://ui.perfetto.dev can open.
+ */
+namespace startup_trace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        std::string name;
+        std::string category;
+        Clock::time_point start;
+        Clock::duration duration{};
+        // Small sequential number of the recording thread
+        uint32_t thread_id = 0;
+        // Number of enclosing scopes on the recording thread
+        uint32_t depth = 0;
+    };
+
+    class Trace {
+    public:
+        Trace();
+
+        void record(Event event);
+
+        /**
+         * @return All recorded events, ordered by start time
+         */
+        [[nodiscard]] std::vector<Event> events() const;
+
+        /**
+         * @return One line per event with its duration, indented by depth
+         */
+        [[nodiscard]] std::vector<std::string> summary() const;
+
+        [[nodiscard]] std::string to_chrome_json() const;
+
+        /**
+         * @throws std::runtime_error if the file cannot be written
+         */
+        void write_chrome_json(const std::filesystem::path& path) const;
+
+    private:
+        mutable std::mutex mutex;
+        Clock::time_point origin;
+        std::vector<Event> recorded_events;
+    };
+
+    /**
+     * @return The trace of the current process
+     */
+    Trace& global();
+
+    /**
+     * Records an event spanning its lifetime
+     */
+    class Scope {
+    public:
+        Scope(std::string name, std::string category, Trace& trace = global());
+
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Trace& trace;
+        Event event;
+    };
+}
@@ -0,0 +1,56 @@
+#include "target_rules/target_rules.hpp"
+#include "wildcard/wildcard.hpp"
+
+namespace {
+    std::string fold_case(const std::string_view name) {
+        std::string folded(name);
+        for(auto& c : folded) {
+            c = static_cast<char>(wildcard::fold_case(static_cast<unsigned char>(c)));
+        }
+        return folded;
+    }
+}
+
+namespace target_rules {
+    Rules::Rules(const std::vector<std::vector<std::string>>& patterns_per_rule) {
+        for(size_t rule = 0; rule < patterns_per_rule.size(); ++rule) {
+            for(const auto& pattern : patterns_per_rule[rule]) {
+                if(wildcard::is_literal(pattern)) {
+                    // Keeps the first rule if a name is listed by several rules
+                    exact_names.try_emplace(fold_case(pattern), rule);
+                } else {
+                    wildcards.push_back({pattern, rule});
+                }
+            }
+        }
+    }
+
+    std::optional<size_t> Rules::find(const std::string_view executable_name) const {
+        std::optional<size_t> result;
+
+        if(const auto it = exact_names.find(fold_case(executable_name)); it != exact_names.end()) {
+            result = it->second;
+        }
+
+        // Only wildcards of rules with a higher priority than an exact match can change the result
+        for(const auto& [pattern, rule] : wildcards) {
+            if(result && rule >= *result) {
+                break;
+            }
+
+            if(wildcard::matches(pattern, executable_name)) {
+                return rule;
+            }
+        }
+
+        return result;
+    }
+
+    size_t Rules::exact_count() const {
+        return exact_names.size();
+    }
+
+    size_t Rules::wildcard_count() const {
+        return wildcards.size();
+    }
+}
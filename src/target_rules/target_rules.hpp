@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Compiled rules that select a target by executable name.
+ *
+ * Each rule has a list of name patterns, which may contain `*` and `?` wildcards.
+ * Plain names go into a hash table of case-folded names, so that they are decided
+ * with a single lookup, and only the few patterns with wildcards are matched one by one.
+ * When several rules match, the one that was given first wins.
+ */
+namespace target_rules {
+    class Rules {
+    public:
+        Rules() = default;
+
+        /**
+         * @param patterns_per_rule Name patterns of each rule, in order of priority
+         */
+        explicit Rules(const std::vector<std::vector<std::string>>& patterns_per_rule);
+
+        /**
+         * @param executable_name UTF-8 file name of the executable, such as `Game.exe`
+         * @return Index of the first rule with a pattern that matches the name
+         */
+        [[nodiscard]] std::optional<size_t> find(std::string_view executable_name) const;
+
+        [[nodiscard]] size_t exact_count() const;
+
+        [[nodiscard]] size_t wildcard_count() const;
+
+    private:
+        struct Wildcard {
+            std::string pattern;
+            size_t rule = 0;
+        };
+
+        // Case-folded names mapped to the first rule that lists them
+        std::unordered_map<std::string, size_t> exact_names;
+        // Sorted by rule
+        std::vector<Wildcard> wildcards;
+    };
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/**
+ * Conversions between paths and UTF-8 strings, for cache files and error messages.
+ * Unlike `std::filesystem::path::string`, they do not depend on the code page of the process.
+ */
+namespace utf8_path {
+    inline std::string to_utf8(const std::filesystem::path& path) {
+        const auto u8 = path.u8string();
+        return {u8.begin(), u8.end()};
+    }
+
+    inline std::filesystem::path from_utf8(const std::string_view str) {
+        return std::u8string(str.begin(), str.end());
+    }
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Compile-time set of well-known module file names used by auto_load.
+ *
+ * Names are stored case-folded in a small open-addressing table that is built
+ * by a constexpr constructor, so a lookup is a length and extension check,
+ * one hash over the file name and usually a single comparison.
+ * Lookups work on any character type and never allocate.
+ */
+namespace well_known_modules {
+    inline constexpr std::array<std::string_view, 11> BASE_NAMES{
+        "Unlocker",
+        "Lyptus",
+        "ScreamAPI",
+        "scream_api",
+        "SmokeAPI",
+        "smoke_api",
+        "UplayR1Unlocker",
+        "UplayR2Unlocker",
+        "KoaloaderA",
+        "KoaloaderB",
+        "KoaloaderC",
+    };
+
+    inline constexpr std::string_view EXTENSION = ".dll";
+
+    template<typename Char>
+    constexpr uint32_t fold_case(const Char c) {
+        const auto unit = static_cast<uint32_t>(c);
+        return unit >= 'A' && unit <= 'Z' ? unit + ('a' - 'A') : unit;
+    }
+
+    /**
+     * FNV-1a over case-folded code units
+     */
+    template<typename Char>
+    constexpr uint32_t hash(const std::basic_string_view<Char> str) {
+        uint32_t value = 2166136261u;
+        for(const auto c : str) {
+            value = (value ^ fold_case(c)) * 16777619u;
+        }
+        return value;
+    }
+
+    class Set {
+    public:
+        static constexpr size_t MAX_NAME_LENGTH = 32;
+        static constexpr size_t CAPACITY = 64;
+
+        /**
+         * @param bitness Suffix of the bitness-specific variants, e.g. `SmokeAPI64.dll`
+         */
+        explicit constexpr Set(const int bitness) {
+            const char suffix[] = {static_cast<char>('0' + bitness / 10), static_cast<char>('0' + bitness % 10)};
+
+            for(const auto base_name : BASE_NAMES) {
+                add(base_name, {});
+                add(base_name, {suffix, 2});
+            }
+        }
+
+        /**
+         * @param file_name File name without directories
+         */
+        template<typename Char>
+        [[nodiscard]] constexpr bool contains(const std::basic_string_view<Char> file_name) const {
+            if(file_name.size() < min_length || file_name.size() > max_length || not has_extension(file_name)) {
+                return false;
+            }
+
+            const auto stem = file_name.substr(0, file_name.size() - EXTENSION.size());
+            for(auto slot = hash(stem) % CAPACITY;; slot = (slot + 1) % CAPACITY) {
+                const auto& entry = entries[slot];
+
+                if(entry.length == 0) {
+                    return false;
+                }
+
+                if(entry.length == stem.size() && equals(entry, stem)) {
+                    return true;
+                }
+            }
+        }
+
+        /**
+         * Rejects on the extension before looking for the file name,
+         * so most paths are dismissed after inspecting their last few characters.
+         *
+         * @param path Full path, using either `/` or `\` as separators
+         */
+        template<typename Char>
+        [[nodiscard]] constexpr bool contains_file_name_of(const std::basic_string_view<Char> path) const {
+            if(path.size() < min_length || not has_extension(path)) {
+                return false;
+            }
+
+            // Names longer than the longest module are rejected without scanning further
+            const auto limit = std::min(path.size(), max_length + 1);
+            size_t length = EXTENSION.size();
+            while(length < limit && path[path.size() - length - 1] != '/' && path[path.size() - length - 1] != '\\') {
+                ++length;
+            }
+
+            return contains(path.substr(path.size() - length));
+        }
+
+        [[nodiscard]] constexpr size_t size() const {
+            return count;
+        }
+
+    private:
+        struct Entry {
+            std::array<char, MAX_NAME_LENGTH> name{};
+            size_t length = 0;
+        };
+
+        std::array<Entry, CAPACITY> entries{};
+        size_t count = 0;
+        size_t min_length = SIZE_MAX;
+        size_t max_length = 0;
+
+        template<typename Char>
+        static constexpr bool has_extension(const std::basic_string_view<Char> file_name) {
+            const auto extension = file_name.substr(file_name.size() - EXTENSION.size());
+            for(size_t i = 0; i < EXTENSION.size(); ++i) {
+                if(fold_case(extension[i]) != static_cast<uint32_t>(EXTENSION[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<typename Char>
+        static constexpr bool equals(const Entry& entry, const std::basic_string_view<Char> stem) {
+            for(size_t i = 0; i < stem.size(); ++i) {
+                if(fold_case(stem[i]) != static_cast<uint32_t>(entry.name[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr void add(const std::string_view base_name, const std::string_view suffix) {
+            Entry entry;
+            for(const auto c : base_name) {
+                entry.name[entry.length++] = static_cast<char>(fold_case(c));
+            }
+            for(const auto c : suffix) {
+                entry.name[entry.length++] = c;
+            }
+
+            const std::string_view stem(entry.name.data(), entry.length);
+            auto slot = hash(stem) % CAPACITY;
+            while(entries[slot].length != 0) {
+                slot = (slot + 1) % CAPACITY;
+            }
+
+            entries[slot] = entry;
+            ++count;
+            min_length = std::min(min_length, entry.length + EXTENSION.size());
+            max_length = std::max(max_length, entry.length + EXTENSION.size());
+        }
+    };
+
+    /**
+     * Well-known modules for the bitness of the current process
+     */
+    inline constexpr Set CURRENT{static_cast<int>(sizeof(void*) * 8)};
+
+    static_assert(CURRENT.size() == BASE_NAMES.size() * 2);
+    static_assert(CURRENT.contains(std::string_view("SMOKEAPI.dll")));
+    static_assert(not CURRENT.contains(std::string_view("SmokeAPI.exe")));
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Case-insensitive wildcard matching, where `*` matches any sequence
+ * of characters and `?` matches exactly one character.
+ * Case folding is limited to ASCII, like the rest of Koaloader's name matching.
+ */
+namespace wildcard {
+    template<typename Char>
+    constexpr uint32_t fold_case(const Char c) {
+        const auto unit = static_cast<uint32_t>(c);
+        return unit >= 'A' && unit <= 'Z' ? unit + ('a' - 'A') : unit;
+    }
+
+    /**
+     * Iterative matcher with single-star backtracking, linear in practice and never recursive.
+     *
+     * @param pattern UTF-8 or ASCII pattern. Non-ASCII pattern characters are compared by code unit.
+     */
+    template<typename Char>
+    constexpr bool matches(const std::string_view pattern, const std::basic_string_view<Char> text) {
+        size_t p = 0;
+        size_t t = 0;
+        size_t star = std::string_view::npos;
+        size_t star_text = 0;
+
+        while(t < text.size()) {
+            if(p < pattern.size() && pattern[p] == '*') {
+                star = p++;
+                star_text = t;
+            } else if(
+                p < pattern.size() &&
+                (pattern[p] == '?' || fold_case(static_cast<unsigned char>(pattern[p])) == fold_case(text[t]))
+            ) {
+                ++p;
+                ++t;
+            } else if(star != std::string_view::npos) {
+                p = star + 1;
+                t = ++star_text;
+            } else {
+                return false;
+            }
+        }
+
+        while(p < pattern.size() && pattern[p] == '*') {
+            ++p;
+        }
+
+        return p == pattern.size();
+    }
+
+    /**
+     * @return true if the pattern contains no wildcards and can be compared as a plain name
+     */
+    constexpr bool is_literal(const std::string_view pattern) {
+        return pattern.find_first_of("*?") == std::string_view::npos;
+    }
+
+    static_assert(matches("*.git", std::string_view("repo.GIT")));
+    static_assert(matches("shader?cache*", std::string_view("ShaderXCache_v2")));
+    static_assert(not matches("__pycache__", std::string_view("__pycache")));
+}
@@ -1,4 +1,8 @@
-#include <regex>
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <memory>
+#include <thread>
 
 #include <koalabox/config.hpp>
 #include <koalabox/hook.hpp>
@@ -8,69 +12,258 @@
 
 #include "file_api.hpp"
 
+#include "async_log/async_log.hpp"
+#include "find_filter/find_filter.hpp"
+#include "handle_table/handle_table.hpp"
+#include "hide_matcher/hide_matcher.hpp"
+#include "hook_stats/hook_stats.hpp"
+#include "hook_trace/hook_trace.hpp"
 #include "koaloader/koaloader.hpp"
+#include "startup_trace/startup_trace.hpp"
 
 namespace {
     namespace kb = koalabox;
 
     /**
-     * @return map where key is file handle, and value is the initial search string
+     * Find handles opened through the hooked FindFirstFile functions.
+     * Shared by all threads that enumerate directories.
      */
     auto& get_tracked_file_handles() {
-        static std::map<HANDLE, std::string> handles;
+        static handle_table::HandleSet handles(4096);
         return handles;
     }
 
-    bool is_file_hidden(const std::string& filename) {
-        for(const auto& pattern : koaloader::config.hide_files) {
-            // TODO: Cache regex patterns
-            if(std::regex_search(filename, std::regex(pattern, std::regex_constants::icase))) {
-                return true;
-            }
+    void track_file_handle(const HANDLE handle) {
+        if(not get_tracked_file_handles().insert(reinterpret_cast<uintptr_t>(handle))) {
+            LOG_DEBUG(
+                "Find handle table is full. Tracking handle {} in the overflow set.",
+                reinterpret_cast<uintptr_t>(handle)
+            );
         }
+    }
 
-        return false;
+    bool is_tracked_file_handle(const HANDLE handle) {
+        return get_tracked_file_handles().contains(reinterpret_cast<uintptr_t>(handle));
+    }
+
+    /**
+     * Number of records buffered by the asynchronous hook log, roughly 2 MiB
+     */
+    constexpr size_t HOOK_LOG_CAPACITY = 4096;
+
+    /**
+     * Set before any hooks are installed if `async_logging` is enabled
+     */
+    std::unique_ptr<async_log::Log> hook_log;
+
+    /**
+     * Set before any hooks are installed if `hook_trace` is enabled
+     */
+    std::unique_ptr<hook_trace::Recorder> trace_recorder;
+
+    /**
+     * Compiled from `koaloader::config.hide_files` and set before any hooks are installed
+     */
+    hide_matcher::Matcher matcher;
+
+    bool is_file_hidden(const std::string_view file_name) {
+        return hide_matcher::is_file_hidden(matcher, file_name);
+    }
+
+    bool is_file_hidden(const std::wstring_view file_name) {
+        return hide_matcher::is_file_hidden(matcher, file_name);
+    }
+
+    std::u16string_view to_u16(const LPCWSTR str) {
+        return reinterpret_cast<const char16_t*>(str);
+    }
+
+    /**
+     * Recording may write the trace file, which must not change the last error seen by the caller of the hook
+     */
+    template<typename... Args>
+    void trace_hook(const hook_trace::Api api, const Args&... args) {
+        if(trace_recorder) {
+            const auto last_error = GetLastError();
+            trace_recorder->record(api, args...);
+            SetLastError(last_error);
+        }
+    }
+
+    /**
+     * The thread is detached, since it cannot be joined from DllMain during shutdown
+     */
+    void start_hook_stats_reporter(const uint32_t interval_s) {
+        std::thread(
+            [interval_s] {
+                while(true) {
+                    std::this_thread::sleep_for(std::chrono::seconds(interval_s));
+                    file_api::report_hook_stats();
+                }
+            }
+        ).detach();
     }
 }
 
 #define ORIGINAL(FUNC) kb::hook::get_hooked_function(#FUNC, FUNC)
 
-HANDLE WINAPI $FindFirstFileW(
-    const LPCWSTR lpFileName,
-    const LPWIN32_FIND_DATAW lpFindFileData
-) {
-    while(true) {
-        auto* const handle = ORIGINAL(FindFirstFileW)(lpFileName, lpFindFileData);
-        if(handle == INVALID_HANDLE_VALUE) {
-            return handle;
+/**
+ * Hooks run on the game's I/O threads, so paths are converted to UTF-8
+ * only when a log line is actually going to be written.
+ * With `async_logging`, lines are formatted on the stack and copied into the hook log buffer,
+ * which its writer thread drains into the log file. Formatting stays outside of a lambda,
+ * since the arguments refer to the `__func__` of the hook.
+ */
+#define LOG_HOOK(...)                                                                              \
+    do {                                                                                           \
+        if(koaloader::config.logging) {                                                            \
+            if(hook_log) {                                                                         \
+                char text[async_log::Log::RECORD_SIZE];                                            \
+                const auto formatted = std::format_to_n(text, sizeof(text), __VA_ARGS__);          \
+                hook_log->push({text, std::min<size_t>(formatted.size, sizeof(text))});            \
+            } else {                                                                               \
+                LOG_DEBUG(__VA_ARGS__);                                                            \
+            }                                                                                      \
+        }                                                                                          \
+    } while(false)
+
+/**
+ * Measures the enclosing hook if `hook_stats` is enabled.
+ * Calls of the original function must go through `timer.call_original`.
+ */
+#define HOOK_TIMER(FUNC)                                                                           \
+    static auto& FUNC##_stats = hook_stats::registry().add(#FUNC);                                 \
+    hook_stats::CallTimer timer(FUNC##_stats, koaloader::config.hook_stats)
+
+namespace {
+    /**
+     * Entries of a find handle, which is advanced with the original `FindNextFileW`.
+     * Every examined entry is logged and traced as a call of the original function that returned it.
+     */
+    class FindHandleSource final : public find_filter::Source {
+    public:
+        /**
+         * @param api Function that returned the current entry
+         * @param query Query of `FindFirstFile`, or nullptr for `FindNextFileW`
+         */
+        FindHandleSource(
+            hook_stats::CallTimer& timer,
+            const char* const hook_name,
+            const hook_trace::Api api,
+            const LPCWSTR query,
+            const HANDLE handle,
+            WIN32_FIND_DATAW& data
+        ) : timer(timer), hook_name(hook_name), api(api), query(query), handle(handle), data(data) {}
+
+        find_filter::Advance next() override {
+            const auto success = timer.call_original([&] {
+                return ORIGINAL(FindNextFileW)(handle, &data);
+            });
+            api = hook_trace::Api::FindNextFileW;
+
+            if(success) {
+                return find_filter::Advance::ENTRY;
+            }
+
+            last_error = GetLastError();
+            trace_hook(api, false, reinterpret_cast<uintptr_t>(handle), FALSE, u"");
+
+            return last_error == ERROR_NO_MORE_FILES ? find_filter::Advance::END : find_filter::Advance::FAILURE;
+        }
+
+        [[nodiscard]] std::u16string_view name() const override {
+            return to_u16(data.cFileName);
         }
 
-        auto base_path = kb::str::to_str(lpFileName);
-        if(base_path.ends_with("*")) {
-            base_path = base_path.substr(0, base_path.length() - 1);
+        void examined(const bool hidden) override {
+            if(api == hook_trace::Api::FindNextFileW) {
+                trace_hook(api, hidden, reinterpret_cast<uintptr_t>(handle), TRUE, u"", name());
+
+                LOG_HOOK(
+                    R"({} -> handle: {}, filename: "{}", hiding: {})",
+                    hook_name,
+                    reinterpret_cast<uintptr_t>(handle),
+                    kb::str::to_str(data.cFileName),
+                    hidden
+                );
+            } else {
+                trace_hook(api, hidden, 0, reinterpret_cast<intptr_t>(handle), to_u16(query), name());
+
+                LOG_HOOK(
+                    R"({} -> query: "{}", handle: {}, filename: "{}", hiding: {})",
+                    hook_name,
+                    kb::str::to_str(query),
+                    reinterpret_cast<uintptr_t>(handle),
+                    kb::str::to_str(data.cFileName),
+                    hidden
+                );
+            }
         }
-        get_tracked_file_handles()[handle] = base_path;
 
-        const auto hiding = is_file_hidden(kb::str::to_str(lpFindFileData->cFileName));
+        [[nodiscard]] uint32_t error() const override {
+            return last_error;
+        }
 
-        LOG_DEBUG(
-            R"({} -> query: "{}", handle: {}, filename: "{}", hiding: {})",
-            __func__,
-            kb::str::to_str(lpFileName),
-            reinterpret_cast<uintptr_t>(handle),
-            kb::str::to_str(lpFindFileData->cFileName),
-            hiding
-        );
+    private:
+        hook_stats::CallTimer& timer;
+        const char* hook_name;
+        hook_trace::Api api;
+        LPCWSTR query;
+        HANDLE handle;
+        WIN32_FIND_DATAW& data;
+        DWORD last_error = ERROR_SUCCESS;
+    };
+
+    /**
+     * Skips hidden entries at the start of a directory on the handle opened by the original function.
+     * If every entry is hidden, the handle is closed and the caller sees a query without matches.
+     * The close is traced like any other, so that traces do not keep such enumerations open.
+     */
+    HANDLE filter_first_entry(
+        hook_stats::CallTimer& timer,
+        const char* const hook_name,
+        const hook_trace::Api api,
+        const LPCWSTR query,
+        const HANDLE handle,
+        WIN32_FIND_DATAW& data
+    ) {
+        if(handle == INVALID_HANDLE_VALUE) {
+            trace_hook(api, false, 0, -1, to_u16(query));
+            return handle;
+        }
+
+        FindHandleSource source(timer, hook_name, api, query, handle, data);
+        find_filter::Enumeration enumeration(source, matcher);
 
-        if(hiding) {
-            SetLastError(ERROR_NO_MORE_FILES); // Is this necessary?
-            continue;
+        const auto state = enumeration.first();
+        timer.set_hidden(enumeration.hidden() > 0);
+
+        if(state == find_filter::State::FOUND) {
+            track_file_handle(handle);
+            return handle;
         }
 
-        return handle;
+        const auto closed = timer.call_original([&] { return ORIGINAL(FindClose)(handle); });
+        trace_hook(hook_trace::Api::FindClose, false, reinterpret_cast<uintptr_t>(handle), closed, u"");
+
+        SetLastError(enumeration.last_error());
+        return INVALID_HANDLE_VALUE;
     }
 }
 
+HANDLE WINAPI $FindFirstFileW(
+    const LPCWSTR lpFileName,
+    const LPWIN32_FIND_DATAW lpFindFileData
+) {
+    HOOK_TIMER(FindFirstFileW);
+
+    auto* const handle = timer.call_original([&] {
+        return ORIGINAL(FindFirstFileW)(lpFileName, lpFindFileData);
+    });
+
+    return filter_first_entry(timer, __func__, hook_trace::Api::FindFirstFileW, lpFileName, handle, *lpFindFileData);
+}
+
 HANDLE WINAPI $FindFirstFileExW(
     const LPCWSTR lpFileName,
     const FINDEX_INFO_LEVELS fInfoLevelId,
@@ -79,8 +272,10 @@ HANDLE WINAPI $FindFirstFileExW(
     const LPVOID lpSearchFilter,
     const DWORD dwAdditionalFlags
 ) {
-    while(true) {
-        auto* const handle = ORIGINAL(FindFirstFileExW)(
+    HOOK_TIMER(FindFirstFileExW);
+
+    auto* const handle = timer.call_original([&] {
+        return ORIGINAL(FindFirstFileExW)(
             lpFileName,
             fInfoLevelId,
             lpFindFileData,
@@ -88,74 +283,56 @@ HANDLE WINAPI $FindFirstFileExW(
             lpSearchFilter,
             dwAdditionalFlags
         );
+    });
 
-        if(handle == INVALID_HANDLE_VALUE) {
-            return handle;
-        }
-
-        auto base_path = kb::str::to_str(lpFileName);
-        if(base_path.ends_with("*")) {
-            base_path = base_path.substr(0, base_path.length() - 1);
-        }
-        get_tracked_file_handles()[handle] = base_path;
-
-        const auto hiding = is_file_hidden(kb::str::to_str(lpFindFileData->cFileName));
-
-        LOG_DEBUG(
-            "{} -> query: {}, handle: {}, filename: \"{}\", hiding: {}",
-            __func__,
-            kb::str::to_str(lpFileName),
-            reinterpret_cast<uintptr_t>(handle),
-            kb::str::to_str(lpFindFileData->cFileName),
-            hiding
-        );
-
-        if(hiding) {
-            SetLastError(ERROR_NO_MORE_FILES); // Is this necessary?
-            continue;
-        }
-
-        return handle;
-    }
+    return filter_first_entry(timer, __func__, hook_trace::Api::FindFirstFileExW, lpFileName, handle, *lpFindFileData);
 }
 
+/**
+ * Hidden entries are skipped on the same handle, and once all remaining entries turn out to be hidden,
+ * the caller sees the end of the directory just like after the last visible entry.
+ */
 BOOL WINAPI $FindNextFileW(
     HANDLE hFindFile,
     const LPWIN32_FIND_DATAW lpFindFileData
 ) {
-    while(true) {
-        const auto success = ORIGINAL(FindNextFileW)(hFindFile, lpFindFileData);
+    HOOK_TIMER(FindNextFileW);
 
-        if(success && get_tracked_file_handles().contains(hFindFile)) {
-            const auto hiding = is_file_hidden(kb::str::to_str(lpFindFileData->cFileName));
+    if(not is_tracked_file_handle(hFindFile)) {
+        return timer.call_original([&] {
+            return ORIGINAL(FindNextFileW)(hFindFile, lpFindFileData);
+        });
+    }
 
-            LOG_DEBUG(
-                "{} -> handle: {}, filename: \"{}\", hiding: {}",
-                __func__,
-                reinterpret_cast<uintptr_t>(hFindFile),
-                kb::str::to_str(lpFindFileData->cFileName),
-                hiding
-            );
+    FindHandleSource source(timer, __func__, hook_trace::Api::FindNextFileW, nullptr, hFindFile, *lpFindFileData);
+    find_filter::Enumeration enumeration(source, matcher);
 
-            if(hiding) {
-                SetLastError(ERROR_NO_MORE_FILES); // Is this necessary?
-                continue;
-            }
-        }
+    const auto state = enumeration.next();
+    timer.set_hidden(enumeration.hidden() > 0);
 
-        return success;
+    if(state == find_filter::State::FOUND) {
+        return TRUE;
     }
+
+    SetLastError(enumeration.last_error());
+    return FALSE;
 }
 
 BOOL WINAPI $FindClose(const HANDLE hFindFile) {
-    const auto result = ORIGINAL(FindClose)(hFindFile);
+    HOOK_TIMER(FindClose);
 
-    if(get_tracked_file_handles().contains(hFindFile)) {
-        LOG_DEBUG(
+    // Untrack before closing, since the OS may reuse the handle value immediately afterward
+    const auto tracked = get_tracked_file_handles().erase(reinterpret_cast<uintptr_t>(hFindFile));
+
+    const auto result = timer.call_original([&] { return ORIGINAL(FindClose)(hFindFile); });
+
+    if(tracked) {
+        trace_hook(hook_trace::Api::FindClose, false, reinterpret_cast<uintptr_t>(hFindFile), result, u"");
+
+        LOG_HOOK(
             "{} -> handle: {}, result: {}",
             __func__, reinterpret_cast<uintptr_t>(hFindFile), static_cast<bool>(result)
         );
-        get_tracked_file_handles().erase(hFindFile);
     }
 
     return result;
@@ -164,19 +341,26 @@ BOOL WINAPI $FindClose(const HANDLE hFindFile) {
 DWORD WINAPI $GetFileAttributesA(
     _In_ LPCSTR lpFileName
 ) {
-    const auto file_name = std::string(lpFileName);
-    const auto hiding = is_file_hidden(file_name);
+    HOOK_TIMER(GetFileAttributesA);
+
+    const auto hiding = is_file_hidden(lpFileName);
+    timer.set_hidden(hiding);
 
-    LOG_DEBUG("{} -> file_name: \"{}\", hiding: {}", __func__, file_name, hiding);
+    LOG_HOOK("{} -> file_name: \"{}\", hiding: {}", __func__, lpFileName, hiding);
 
     if(hiding) {
         SetLastError(ERROR_FILE_NOT_FOUND);
+        trace_hook(hook_trace::Api::GetFileAttributesA, true, 0, INVALID_FILE_ATTRIBUTES, lpFileName);
         return INVALID_FILE_ATTRIBUTES;
     }
 
-    const auto result = ORIGINAL(GetFileAttributesA)(
-        lpFileName
-    );
+    const auto result = timer.call_original([&] {
+        return ORIGINAL(GetFileAttributesA)(
+            lpFileName
+        );
+    });
+
+    trace_hook(hook_trace::Api::GetFileAttributesA, false, 0, result, lpFileName);
 
     return result;
 }
@@ -184,19 +368,26 @@ DWORD WINAPI $GetFileAttributesA(
 DWORD WINAPI $GetFileAttributesW(
     _In_ LPCWSTR lpFileName
 ) {
-    const auto file_name = kb::str::to_str(lpFileName);
-    const auto hiding = is_file_hidden(file_name);
+    HOOK_TIMER(GetFileAttributesW);
 
-    LOG_DEBUG("{} -> file_name: \"{}\", hiding: {}", __func__, file_name, hiding);
+    const auto hiding = is_file_hidden(lpFileName);
+    timer.set_hidden(hiding);
+
+    LOG_HOOK("{} -> file_name: \"{}\", hiding: {}", __func__, kb::str::to_str(lpFileName), hiding);
 
     if(hiding) {
         SetLastError(ERROR_FILE_NOT_FOUND);
+        trace_hook(hook_trace::Api::GetFileAttributesW, true, 0, INVALID_FILE_ATTRIBUTES, to_u16(lpFileName));
         return INVALID_FILE_ATTRIBUTES;
     }
 
-    const auto result = ORIGINAL(GetFileAttributesW)(
-        lpFileName
-    );
+    const auto result = timer.call_original([&] {
+        return ORIGINAL(GetFileAttributesW)(
+            lpFileName
+        );
+    });
+
+    trace_hook(hook_trace::Api::GetFileAttributesW, false, 0, result, to_u16(lpFileName));
 
     return result;
 }
@@ -206,22 +397,29 @@ BOOL WINAPI $GetFileAttributesExA(
     const GET_FILEEX_INFO_LEVELS fInfoLevelId,
     WIN32_FILE_ATTRIBUTE_DATA* lpFileInformation
 ) {
-    const auto file_name = std::string(lpFileName);
-    const auto hiding = is_file_hidden(file_name);
+    HOOK_TIMER(GetFileAttributesExA);
+
+    const auto hiding = is_file_hidden(lpFileName);
+    timer.set_hidden(hiding);
 
-    LOG_DEBUG("{} -> file_name: \"{}\", hiding: {}", __func__, file_name, hiding);
+    LOG_HOOK("{} -> file_name: \"{}\", hiding: {}", __func__, lpFileName, hiding);
 
     if(hiding) {
         *lpFileInformation = WIN32_FILE_ATTRIBUTE_DATA{};
         SetLastError(ERROR_FILE_NOT_FOUND);
+        trace_hook(hook_trace::Api::GetFileAttributesExA, true, 0, FALSE, lpFileName);
         return FALSE;
     }
 
-    const auto result = ORIGINAL(GetFileAttributesExA)(
-        lpFileName,
-        fInfoLevelId,
-        lpFileInformation
-    );
+    const auto result = timer.call_original([&] {
+        return ORIGINAL(GetFileAttributesExA)(
+            lpFileName,
+            fInfoLevelId,
+            lpFileInformation
+        );
+    });
+
+    trace_hook(hook_trace::Api::GetFileAttributesExA, false, 0, result, lpFileName);
 
     return result;
 }
@@ -231,22 +429,29 @@ BOOL WINAPI $GetFileAttributesExW(
     const GET_FILEEX_INFO_LEVELS fInfoLevelId,
     WIN32_FILE_ATTRIBUTE_DATA* lpFileInformation
 ) {
-    const auto file_name = kb::str::to_str(lpFileName);
-    const auto hiding = is_file_hidden(file_name);
+    HOOK_TIMER(GetFileAttributesExW);
+
+    const auto hiding = is_file_hidden(lpFileName);
+    timer.set_hidden(hiding);
 
-    LOG_DEBUG("{} -> file_name: \"{}\", hiding: {}", __func__, file_name, hiding);
+    LOG_HOOK("{} -> file_name: \"{}\", hiding: {}", __func__, kb::str::to_str(lpFileName), hiding);
 
     if(hiding) {
         *lpFileInformation = WIN32_FILE_ATTRIBUTE_DATA{};
         SetLastError(ERROR_FILE_NOT_FOUND);
+        trace_hook(hook_trace::Api::GetFileAttributesExW, true, 0, FALSE, to_u16(lpFileName));
         return FALSE;
     }
 
-    const auto result = ORIGINAL(GetFileAttributesExW)(
-        lpFileName,
-        fInfoLevelId,
-        lpFileInformation
-    );
+    const auto result = timer.call_original([&] {
+        return ORIGINAL(GetFileAttributesExW)(
+            lpFileName,
+            fInfoLevelId,
+            lpFileInformation
+        );
+    });
+
+    trace_hook(hook_trace::Api::GetFileAttributesExW, false, 0, result, to_u16(lpFileName));
 
     return result;
 }
@@ -260,27 +465,34 @@ HANDLE WINAPI $CreateFileA(
     _In_ DWORD dwFlagsAndAttributes,
     _In_opt_ HANDLE hTemplateFile
 ) {
+    HOOK_TIMER(CreateFileA);
+
     // TODO: More robust checks
 
-    const auto file_name = std::string(lpFileName);
-    const auto hiding = is_file_hidden(file_name);
+    const auto hiding = is_file_hidden(lpFileName);
+    timer.set_hidden(hiding);
 
-    LOG_DEBUG("{} -> file_name: \"{}\", hiding: {}", __func__, file_name, hiding);
+    LOG_HOOK("{} -> file_name: \"{}\", hiding: {}", __func__, lpFileName, hiding);
 
     if(hiding) {
         SetLastError(ERROR_FILE_NOT_FOUND);
+        trace_hook(hook_trace::Api::CreateFileA, true, 0, -1, lpFileName);
         return INVALID_HANDLE_VALUE;
     }
 
-    const auto result = ORIGINAL(CreateFileA)(
-        lpFileName,
-        dwDesiredAccess,
-        dwShareMode,
-        lpSecurityAttributes,
-        dwCreationDisposition,
-        dwFlagsAndAttributes,
-        hTemplateFile
-    );
+    const auto result = timer.call_original([&] {
+        return ORIGINAL(CreateFileA)(
+            lpFileName,
+            dwDesiredAccess,
+            dwShareMode,
+            lpSecurityAttributes,
+            dwCreationDisposition,
+            dwFlagsAndAttributes,
+            hTemplateFile
+        );
+    });
+
+    trace_hook(hook_trace::Api::CreateFileA, false, 0, reinterpret_cast<intptr_t>(result), lpFileName);
 
     return result;
 }
@@ -294,33 +506,40 @@ HANDLE WINAPI $CreateFileW(
     _In_ DWORD dwFlagsAndAttributes,
     _In_opt_ HANDLE hTemplateFile
 ) {
+    HOOK_TIMER(CreateFileW);
+
     // TODO: More robust checks
 
-    const auto file_name = kb::str::to_str(lpFileName);
-    const auto hiding = is_file_hidden(file_name);
+    const auto hiding = is_file_hidden(lpFileName);
+    timer.set_hidden(hiding);
 
-    LOG_DEBUG("{} -> file_name: \"{}\", hiding: {}", __func__, file_name, hiding);
+    LOG_HOOK("{} -> file_name: \"{}\", hiding: {}", __func__, kb::str::to_str(lpFileName), hiding);
 
     if(hiding) {
         SetLastError(ERROR_FILE_NOT_FOUND);
+        trace_hook(hook_trace::Api::CreateFileW, true, 0, -1, to_u16(lpFileName));
         return INVALID_HANDLE_VALUE;
     }
 
-    auto* const result = ORIGINAL(CreateFileW)(
-        lpFileName,
-        dwDesiredAccess,
-        dwShareMode,
-        lpSecurityAttributes,
-        dwCreationDisposition,
-        dwFlagsAndAttributes,
-        hTemplateFile
-    );
+    auto* const result = timer.call_original([&] {
+        return ORIGINAL(CreateFileW)(
+            lpFileName,
+            dwDesiredAccess,
+            dwShareMode,
+            lpSecurityAttributes,
+            dwCreationDisposition,
+            dwFlagsAndAttributes,
+            hTemplateFile
+        );
+    });
+
+    trace_hook(hook_trace::Api::CreateFileW, false, 0, reinterpret_cast<intptr_t>(result), to_u16(lpFileName));
 
     return result;
 }
 
 namespace file_api {
-    void hide_files() {
+    void hide_files(hide_matcher::Matcher compiled_matcher) {
 #define KL_HOOK(FUNC) kb::hook::detour( \
     reinterpret_cast<void*>(FUNC), \
     #FUNC, \
@@ -328,6 +547,25 @@ namespace file_api {
 )
         LOG_INFO("Initializing file hider...");
 
+        if(koaloader::config.logging && koaloader::config.async_logging) {
+            // The writer thread starts running once the loader lock is released
+            hook_log = std::make_unique<async_log::Log>(
+                [](const std::string_view line) {
+                    LOG_DEBUG("{}", line);
+                },
+                HOOK_LOG_CAPACITY
+            );
+        }
+
+        matcher = std::move(compiled_matcher);
+
+        LOG_DEBUG(
+            "Hiding files using {} patterns in {} DFA states ({} regex fallbacks)",
+            matcher.pattern_count(), matcher.dfa_state_count(), matcher.fallback_count()
+        );
+
+        const startup_trace::Scope trace_scope("install file hooks", "phase");
+
         KL_HOOK(FindFirstFileW);
         KL_HOOK(FindFirstFileExW);
         KL_HOOK(FindNextFileW);
@@ -339,6 +577,53 @@ namespace file_api {
         KL_HOOK(CreateFileA);
         KL_HOOK(CreateFileW);
 
+        if(koaloader::config.hook_stats && koaloader::config.hook_stats_interval_s > 0) {
+            start_hook_stats_reporter(koaloader::config.hook_stats_interval_s);
+        }
+
         LOG_INFO("File hider initialized");
     }
+
+    void record_hook_trace(const std::filesystem::path& trace_path) {
+        try {
+            trace_recorder = std::make_unique<hook_trace::Recorder>(trace_path);
+            LOG_INFO(R"(Recording file hook calls to "{}")", kb::path::to_str(trace_path));
+        } catch(const std::exception& e) {
+            LOG_WARN("Failed to start hook trace: {}", e.what());
+        }
+    }
+
+    void stop_hook_trace() {
+        if(not trace_recorder) {
+            return;
+        }
+
+        try {
+            trace_recorder->flush();
+            LOG_INFO("Recorded {} file hook calls", trace_recorder->count());
+        } catch(const std::exception& e) {
+            LOG_WARN("Failed to write hook trace: {}", e.what());
+        }
+    }
+
+    void stop_hook_log() {
+        if(not hook_log) {
+            return;
+        }
+
+        hook_log->stop();
+
+        if(const auto dropped = hook_log->dropped()) {
+            LOG_WARN("{} hook log records were dropped because the log buffer was full", dropped);
+        }
+    }
+
+    void report_hook_stats() {
+        const auto lines = hook_stats::registry().report();
+
+        LOG_INFO("File hook statistics ({} hooks called):", lines.size());
+        for(const auto& line : lines) {
+            LOG_INFO("  {}", line);
+        }
+    }
 }
@@ -1,5 +1,35 @@
 #pragma once
 
+#include <filesystem>
+
+#include "hide_matcher/hide_matcher.hpp"
+
 namespace file_api {
-    void hide_files();
+    /**
+     * @param compiled_matcher Compiled from `koaloader::config.hide_files`
+     */
+    void hide_files(hide_matcher::Matcher compiled_matcher);
+
+    /**
+     * Records every call of the file hooks into a trace file, which the `replay_hook_trace` tool can replay.
+     * Must be called before `hide_files`.
+     */
+    void record_hook_trace(const std::filesystem::path& trace_path);
+
+    /**
+     * Writes all buffered records of the hook trace.
+     * Calls recorded afterward are only written if the trace fills its buffer again.
+     */
+    void stop_hook_trace();
+
+    /**
+     * Writes all pending records of the asynchronous hook log on the calling thread.
+     * Records logged afterward are written synchronously.
+     */
+    void stop_hook_log();
+
+    /**
+     * Logs call counts and latency percentiles of every file hook that has been called
+     */
+    void report_hook_stats();
 }
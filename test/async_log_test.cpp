@@ -0,0 +1,196 @@
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_log/async_log.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    /**
+     * Formats into the record slot the way hooks do, without allocating
+     */
+    bool push_numbered(async_log::Log& log, const char* prefix, const int a, const int b = -1) {
+        return log.push_with(
+            [&](char* text, const size_t size) {
+                return b < 0
+                    ? std::snprintf(text, size, "%s %d", prefix, a)
+                    : std::snprintf(text, size, "%s %d %d", prefix, a, b);
+            }
+        );
+    }
+
+    /**
+     * Collects written lines and optionally blocks the writer until released
+     */
+    struct CollectingSink {
+        std::mutex mutex;
+        std::vector<std::string> lines;
+        std::atomic<bool> blocked = false;
+        std::atomic<int> concurrent_writers = 0;
+        std::atomic<bool> overlapped = false;
+
+        async_log::Log::Sink sink() {
+            return [this](const std::string_view line) {
+                if(concurrent_writers.fetch_add(1) != 0) {
+                    overlapped = true;
+                }
+
+                while(blocked) {
+                    std::this_thread::yield();
+                }
+
+                {
+                    const std::lock_guard lock(mutex);
+                    lines.emplace_back(line);
+                }
+
+                concurrent_writers.fetch_sub(1);
+            };
+        }
+    };
+
+    void test_order_and_flush() {
+        CollectingSink collector;
+        async_log::Log log(collector.sink(), 64);
+
+        CHECK(log.capacity() == 64);
+
+        for(int i = 0; i < 1000; ++i) {
+            CHECK(push_numbered(log, "record", i));
+
+            // Keep the buffer from filling up
+            if(i % 32 == 0) {
+                log.flush();
+            }
+        }
+
+        log.flush();
+
+        CHECK(log.written() == 1000);
+        CHECK(log.dropped() == 0);
+
+        const std::lock_guard lock(collector.mutex);
+        CHECK(collector.lines.size() == 1000);
+        for(size_t i = 0; i < collector.lines.size(); ++i) {
+            CHECK(collector.lines[i] == "record " + std::to_string(i));
+        }
+    }
+
+    void test_multiple_producers() {
+        CollectingSink collector;
+        async_log::Log log(collector.sink(), 1 << 16);
+
+        constexpr int thread_count = 8;
+        constexpr int records_per_thread = 4000;
+
+        std::vector<std::thread> threads;
+        for(int t = 0; t < thread_count; ++t) {
+            threads.emplace_back(
+                [&log, t] {
+                    for(int i = 0; i < records_per_thread; ++i) {
+                        push_numbered(log, "producer", t, i);
+                    }
+                }
+            );
+        }
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        log.flush();
+
+        CHECK(log.dropped() == 0);
+        CHECK(log.written() == thread_count * records_per_thread);
+        CHECK(not collector.overlapped);
+
+        // Records of each producer keep their order
+        std::vector<int> next(thread_count, 0);
+        bool ordered = true;
+
+        const std::lock_guard lock(collector.mutex);
+        for(const auto& line : collector.lines) {
+            int t = 0;
+            int i = 0;
+            std::sscanf(line.c_str(), "producer %d %d", &t, &i);
+            ordered = ordered && next[t] == i;
+            next[t] = i + 1;
+        }
+        CHECK(ordered);
+    }
+
+    void test_drops_when_full() {
+        CollectingSink collector;
+        collector.blocked = true;
+
+        async_log::Log log(collector.sink(), 8);
+
+        // The writer may take one record and block on it, which frees its slot
+        int accepted = 0;
+        for(int i = 0; i < 20; ++i) {
+            accepted += push_numbered(log, "record", i) ? 1 : 0;
+        }
+
+        CHECK(accepted == 8 || accepted == 9);
+        CHECK(log.dropped() == static_cast<uint64_t>(20 - accepted));
+
+        collector.blocked = false;
+        log.flush();
+
+        // Dropped records are reported once the writer catches up
+        const std::lock_guard lock(collector.mutex);
+        CHECK(collector.lines.size() == static_cast<size_t>(accepted + 1));
+        CHECK(
+            collector.lines.back() ==
+            std::to_string(20 - accepted) + " log records were dropped because the log buffer was full"
+        );
+    }
+
+    void test_truncation() {
+        CollectingSink collector;
+        async_log::Log log(collector.sink(), 4);
+
+        const std::string long_line(async_log::Log::RECORD_SIZE * 2, 'x');
+        log.push(long_line);
+        log.push(std::string_view{});
+        log.flush();
+
+        const std::lock_guard lock(collector.mutex);
+        CHECK(collector.lines.size() == 2);
+        CHECK(collector.lines[0] == long_line.substr(0, async_log::Log::RECORD_SIZE));
+        CHECK(collector.lines[1].empty());
+    }
+
+    void test_stop() {
+        CollectingSink collector;
+        async_log::Log log(collector.sink(), 1024);
+
+        for(int i = 0; i < 500; ++i) {
+            push_numbered(log, "before", i);
+        }
+
+        // Every record pushed before stopping is written by the time stop returns
+        log.stop();
+        CHECK(log.written() == 500);
+
+        // Afterward, records are written synchronously
+        CHECK(push_numbered(log, "after", 1));
+        log.stop();
+
+        const std::lock_guard lock(collector.mutex);
+        CHECK(collector.lines.size() == 501);
+        CHECK(collector.lines.back() == "after 1");
+    }
+}
+
+int main() {
+    test_order_and_flush();
+    test_multiple_producers();
+    test_drops_when_full();
+    test_truncation();
+    test_stop();
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+
+#include <benchmark/benchmark.h>
+
+#include "async_log/async_log.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr auto FILE_NAME = R"(C:\Program Files (x86)\Steam\steamapps\common\Game\Data\textures_042.pak)";
+
+    int format_hook_record(char* text, const size_t size, const int64_t i) {
+        return std::snprintf(
+            text, size, R"($CreateFileW -> file_name: "%s", call: %lld, hiding: %s)",
+            FILE_NAME, static_cast<long long>(i), i % 16 == 0 ? "true" : "false"
+        );
+    }
+
+    std::FILE* open_log_file() {
+        static const auto path = fs::temp_directory_path() / "koaloader_async_log_bench.log";
+        return std::fopen(path.string().c_str(), "w");
+    }
+
+    /**
+     * Hook-path logging as done by the file logger: format, write and flush on the calling thread
+     */
+    void BM_HookLog_Synchronous(benchmark::State& state) {
+        static std::FILE* file = nullptr;
+        static std::mutex mutex;
+
+        if(state.thread_index() == 0) {
+            file = open_log_file();
+        }
+
+        int64_t i = 0;
+        for(auto _ : state) {
+            char text[async_log::Log::RECORD_SIZE];
+            const auto length = format_hook_record(text, sizeof(text), i++);
+
+            const std::lock_guard lock(mutex);
+            std::fwrite(text, 1, static_cast<size_t>(length), file);
+            std::fputc('\n', file);
+            std::fflush(file);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+
+        if(state.thread_index() == 0) {
+            std::fclose(file);
+        }
+    }
+
+    BENCHMARK(BM_HookLog_Synchronous)->ThreadRange(1, 8)->UseRealTime();
+
+    /**
+     * Same records pushed into the ring buffer in bursts that fit into it, as during asset streaming.
+     * The file is written and flushed by the writer thread, which catches up between bursts.
+     */
+    void BM_HookLog_AsyncBurst(benchmark::State& state) {
+        constexpr int64_t burst_size = 1024;
+
+        auto* const file = open_log_file();
+        async_log::Log log(
+            [file](const std::string_view line) {
+                std::fwrite(line.data(), 1, line.size(), file);
+                std::fputc('\n', file);
+                std::fflush(file);
+            },
+            burst_size
+        );
+
+        int64_t i = 0;
+        for(auto _ : state) {
+            for(int64_t j = 0; j < burst_size; ++j) {
+                log.push_with(
+                    [&](char* text, const size_t size) {
+                        return format_hook_record(text, size, i++);
+                    }
+                );
+            }
+
+            state.PauseTiming();
+            log.flush();
+            state.ResumeTiming();
+        }
+
+        state.SetItemsProcessed(state.iterations() * burst_size);
+        state.counters["dropped"] = static_cast<double>(log.dropped());
+
+        log.stop();
+        std::fclose(file);
+    }
+
+    BENCHMARK(BM_HookLog_AsyncBurst);
+
+    /**
+     * Sustained overload from several threads: producers never wait for the file, and excess records are dropped
+     */
+    void BM_HookLog_AsyncOverload(benchmark::State& state) {
+        static std::FILE* file = nullptr;
+        static std::unique_ptr<async_log::Log> log;
+
+        if(state.thread_index() == 0) {
+            file = open_log_file();
+            log = std::make_unique<async_log::Log>(
+                [](const std::string_view line) {
+                    std::fwrite(line.data(), 1, line.size(), file);
+                    std::fputc('\n', file);
+                    std::fflush(file);
+                },
+                8192
+            );
+        }
+
+        int64_t i = 0;
+        for(auto _ : state) {
+            log->push_with(
+                [&](char* text, const size_t size) {
+                    return format_hook_record(text, size, i++);
+                }
+            );
+        }
+
+        state.SetItemsProcessed(state.iterations());
+
+        if(state.thread_index() == 0) {
+            state.counters["dropped"] = static_cast<double>(log->dropped());
+            log->stop();
+            log.reset();
+            std::fclose(file);
+        }
+    }
+
+    BENCHMARK(BM_HookLog_AsyncOverload)->ThreadRange(1, 8)->UseRealTime();
+}
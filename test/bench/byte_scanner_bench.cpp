@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <map>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "byte_scanner/byte_scanner.hpp"
+
+namespace {
+    constexpr auto PATTERN = "Steamworks initialization failed";
+
+    /**
+     * Synthetic 16 MiB section of mostly text-like data with the pattern at the very end
+     */
+    const std::string& get_section() {
+        static const auto section = [] {
+            std::string data;
+            data.reserve(16 << 20);
+
+            uint32_t state = 1;
+            while(data.size() < (16 << 20) - 64) {
+                state = state * 1664525 + 1013904223;
+                data += static_cast<char>(' ' + (state >> 24) % 95);
+            }
+            data += PATTERN;
+
+            return data;
+        }();
+
+        return section;
+    }
+
+    /**
+     * Reproduces the original `patch_string` implementation
+     */
+    void BM_Find_StdRegex(benchmark::State& state) {
+        const auto& section = get_section();
+        const std::string_view section_view(section);
+
+        for(auto _ : state) {
+            const std::regex regex(PATTERN);
+            std::match_results<std::string_view::const_iterator> m;
+            benchmark::DoNotOptimize(std::regex_search(section_view.begin(), section_view.end(), m, regex));
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * section.size()));
+    }
+
+    BENCHMARK(BM_Find_StdRegex)->Unit(benchmark::kMillisecond);
+
+    void BM_Find_Literal(benchmark::State& state) {
+        const auto& section = get_section();
+        const auto isa = static_cast<byte_scanner::Isa>(state.range(0));
+        state.SetLabel(byte_scanner::to_string(isa));
+
+        for(auto _ : state) {
+            const auto signature = byte_scanner::Signature::literal(PATTERN);
+            benchmark::DoNotOptimize(signature.find(section, isa));
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * section.size()));
+    }
+
+    void BM_Find_Signature(benchmark::State& state) {
+        const auto& section = get_section();
+        const auto isa = static_cast<byte_scanner::Isa>(state.range(0));
+        state.SetLabel(byte_scanner::to_string(isa));
+
+        for(auto _ : state) {
+            // "Steamworks ?? initialization"
+            const auto signature = byte_scanner::Signature::parse("53 74 65 61 6D 77 6F 72 6B 73 ?? ?? 6E 69 74");
+            benchmark::DoNotOptimize(signature.find(section, isa));
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * section.size()));
+    }
+
+    void apply_isas(benchmark::internal::Benchmark* benchmark) {
+        for(const auto isa : byte_scanner::supported_isas()) {
+            benchmark->Arg(static_cast<int>(isa));
+        }
+        benchmark->Unit(benchmark::kMillisecond);
+    }
+
+    BENCHMARK(BM_Find_Literal)->Apply(apply_isas);
+    BENCHMARK(BM_Find_Signature)->Apply(apply_isas);
+
+    /**
+     * Patches that are not present in the section, which is the worst case for every strategy
+     */
+    std::vector<byte_scanner::Signature> get_missing_signatures(const size_t count) {
+        std::vector<byte_scanner::Signature> signatures;
+        for(size_t i = 0; i < count; ++i) {
+            signatures.push_back(byte_scanner::Signature::literal("Koaloader patch #" + std::to_string(i) + "\x01"));
+        }
+        return signatures;
+    }
+
+    /**
+     * Reproduces the previous `patch_strings` implementation, which rescanned the section for every patch
+     */
+    void BM_FindMany_Sequential(benchmark::State& state) {
+        const auto& section = get_section();
+        const auto signatures = get_missing_signatures(state.range(0));
+
+        for(auto _ : state) {
+            for(const auto& signature : signatures) {
+                benchmark::DoNotOptimize(signature.find(section));
+            }
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * section.size()));
+    }
+
+    BENCHMARK(BM_FindMany_Sequential)->Arg(1)->Arg(4)->Arg(12)->Arg(48)->Unit(benchmark::kMillisecond);
+
+    void BM_FindMany_SignatureSet(benchmark::State& state) {
+        const auto& section = get_section();
+        const byte_scanner::SignatureSet set(get_missing_signatures(state.range(0)));
+
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(set.find_all(section));
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * section.size()));
+    }
+
+    BENCHMARK(BM_FindMany_SignatureSet)->Arg(1)->Arg(4)->Arg(12)->Arg(48)->Unit(benchmark::kMillisecond);
+
+    /**
+     * Patches that start with different letters, so that fewer bytes of the section can be skipped
+     */
+    void BM_FindMany_SignatureSet_Diverse(benchmark::State& state) {
+        const auto& section = get_section();
+
+        std::vector<byte_scanner::Signature> signatures;
+        for(int64_t i = 0; i < state.range(0); ++i) {
+            signatures.push_back(byte_scanner::Signature::literal(static_cast<char>('A' + i % 26) + std::string("_patch\x01")));
+        }
+        const byte_scanner::SignatureSet set(signatures);
+
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(set.find_all(section));
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * section.size()));
+    }
+
+    BENCHMARK(BM_FindMany_SignatureSet_Diverse)->Arg(4)->Arg(12)->Unit(benchmark::kMillisecond);
+
+    /**
+     * Scaling of chunked scanning with the number of threads, with 12 patches that are not present
+     */
+    void BM_FindMany_Parallel(benchmark::State& state) {
+        const auto& section = get_section();
+        const byte_scanner::SignatureSet set(get_missing_signatures(12));
+        const auto thread_count = static_cast<size_t>(state.range(0));
+
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(set.find_all_parallel(section, thread_count));
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * section.size()));
+    }
+
+    BENCHMARK(BM_FindMany_Parallel)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+    /**
+     * Text-like section of the given size, with copies of `present_patterns` spread over its second half
+     */
+    const std::string& get_section(const size_t size, const std::vector<std::string>& present_patterns) {
+        static std::map<size_t, std::string> sections;
+
+        auto& data = sections[size];
+        if(data.empty()) {
+            data.reserve(size);
+
+            uint32_t state = 7;
+            while(data.size() < size) {
+                state = state * 1664525 + 1013904223;
+                data += static_cast<char>(' ' + (state >> 24) % 95);
+            }
+
+            for(size_t i = 0; i < present_patterns.size(); ++i) {
+                const auto offset = size / 2 + i * (size / 2 / present_patterns.size());
+                data.replace(offset, present_patterns[i].size(), present_patterns[i]);
+            }
+        }
+
+        return data;
+    }
+
+    /**
+     * Mirrors `patch_section` in patcher.cpp with a typical config of 12 patches, half of which are found,
+     * over sections the size of `.rdata` in small, medium and large executables
+     */
+    void BM_ScanSection(benchmark::State& state) {
+        const std::vector<std::string> present{
+            "Steamworks initialization failed", "IsSubscribedApp", "BIsDlcInstalled",
+            "GetDLCCount", "bIsLicensed", "EntitlementCheck",
+        };
+        const auto& section = get_section(static_cast<size_t>(state.range(0)) << 20, present);
+
+        auto signatures = get_missing_signatures(4);
+        for(const auto& pattern : present) {
+            signatures.push_back(byte_scanner::Signature::literal(pattern));
+        }
+        signatures.push_back(byte_scanner::Signature::parse("53 74 65 61 6D ?? ?? 72 6B 73"));
+        signatures.push_back(byte_scanner::Signature::parse("4B 6F 61 ?? ?? ?? 61 64 65 72 01"));
+
+        const byte_scanner::SignatureSet set(std::move(signatures));
+        const auto thread_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 16);
+
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(set.find_all_parallel(section, thread_count));
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * section.size()));
+    }
+
+    BENCHMARK(BM_ScanSection)->Arg(1)->Arg(16)->Arg(64)->UseRealTime()->Unit(benchmark::kMillisecond);
+}
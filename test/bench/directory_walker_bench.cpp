@@ -0,0 +1,112 @@
+#include <fstream>
+#include <optional>
+
+#include <benchmark/benchmark.h>
+
+#include "directory_walker/directory_walker.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr auto TARGET_NAME = "SmokeAPI64.dll";
+
+    /**
+     * Synthetic game install: 8 top-level content folders, 4 levels of nesting
+     * with fan-out 6 and 20 files per directory, i.e. ~2k directories and ~40k files.
+     */
+    const fs::path& get_tree() {
+        static const auto root = [] {
+            const auto path = fs::temp_directory_path() / "koaloader_directory_walker_bench";
+            const auto marker = path / ".complete";
+
+            if(fs::exists(marker)) {
+                return path;
+            }
+
+            fs::remove_all(path);
+
+            const auto generate = [](const auto& self, const fs::path& directory, const int width, const int depth) -> void {
+                fs::create_directories(directory);
+                for(int file = 0; file < 20; ++file) {
+                    std::ofstream(directory / ("asset_" + std::to_string(file) + ".pak"));
+                }
+
+                if(depth == 0) {
+                    return;
+                }
+
+                for(int child = 0; child < width; ++child) {
+                    self(self, directory / ("dir_" + std::to_string(child)), 6, depth - 1);
+                }
+            };
+
+            generate(generate, path, 8, 4);
+            std::ofstream{marker};
+
+            return path;
+        }();
+
+        return root;
+    }
+
+    /**
+     * Range argument 0 places the module in the middle of the tree, 1 omits it (full scan).
+     */
+    std::optional<fs::path> place_target(const benchmark::State& state) {
+        if(state.range(0) != 0) {
+            return std::nullopt;
+        }
+
+        auto target = get_tree() / "dir_4" / "dir_3" / "dir_2" / "dir_3" / TARGET_NAME;
+        std::ofstream(target).put('\0');
+        return target;
+    }
+
+    bool is_target(const fs::directory_entry& entry) {
+        return entry.path().filename() == TARGET_NAME;
+    }
+
+    /**
+     * Original single-threaded discovery
+     */
+    void BM_Discovery_RecursiveIterator(benchmark::State& state) {
+        const auto target = place_target(state);
+
+        for(auto _ : state) {
+            bool found = false;
+            for(const auto& entry : fs::recursive_directory_iterator(get_tree())) {
+                if(not entry.is_directory() && is_target(entry)) {
+                    found = true;
+                    break;
+                }
+            }
+            benchmark::DoNotOptimize(found);
+        }
+
+        if(target) {
+            fs::remove(*target);
+        }
+    }
+
+    BENCHMARK(BM_Discovery_RecursiveIterator)
+        ->ArgNames({"missing"})->Arg(0)->Arg(1)
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    void BM_Discovery_DirectoryWalker(benchmark::State& state) {
+        const auto target = place_target(state);
+
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(directory_walker::find_first(get_tree(), is_target, {
+                .thread_count = static_cast<size_t>(state.range(1)),
+            }));
+        }
+
+        if(target) {
+            fs::remove(*target);
+        }
+    }
+
+    BENCHMARK(BM_Discovery_DirectoryWalker)
+        ->ArgNames({"missing", "threads"})->ArgsProduct({{0, 1}, {1, 2, 4, 8}})
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+}
@@ -0,0 +1,68 @@
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "handle_table/handle_table.hpp"
+
+namespace {
+    constexpr uintptr_t LIVE_HANDLES = 64;
+
+    uintptr_t handle_value(const uintptr_t i) {
+        return 0x100 + i * 4;
+    }
+
+    /**
+     * Lookup performed by every hooked FindNextFileW call using the original std::map tracking
+     */
+    void BM_FindNextFile_StdMap(benchmark::State& state) {
+        static std::map<uintptr_t, std::string> handles;
+        static std::mutex mutex;
+
+        if(state.thread_index() == 0) {
+            for(uintptr_t i = 0; i < LIVE_HANDLES; ++i) {
+                handles[handle_value(i)] = R"(C:\Program Files (x86)\Steam\steamapps\common\Game\Data\)";
+            }
+        }
+
+        uintptr_t i = state.thread_index();
+        for(auto _ : state) {
+            const std::lock_guard lock(mutex);
+            benchmark::DoNotOptimize(handles.contains(handle_value(i++ % LIVE_HANDLES)));
+        }
+    }
+
+    BENCHMARK(BM_FindNextFile_StdMap)->ThreadRange(1, 8);
+
+    void BM_FindNextFile_HandleTable(benchmark::State& state) {
+        static handle_table::HandleTable table(4096);
+
+        if(state.thread_index() == 0) {
+            for(uintptr_t i = 0; i < LIVE_HANDLES; ++i) {
+                table.insert(handle_value(i));
+            }
+        }
+
+        uintptr_t i = state.thread_index();
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(table.contains(handle_value(i++ % LIVE_HANDLES)));
+        }
+    }
+
+    BENCHMARK(BM_FindNextFile_HandleTable)->ThreadRange(1, 8);
+
+    void BM_FindFirstFileClose_HandleTable(benchmark::State& state) {
+        static handle_table::HandleTable table(4096);
+
+        uintptr_t i = 0;
+        for(auto _ : state) {
+            const auto handle = handle_value(i++ % 1024 + state.thread_index() * 1024);
+            table.insert(handle);
+            benchmark::DoNotOptimize(table.contains(handle));
+            table.erase(handle);
+        }
+    }
+
+    BENCHMARK(BM_FindFirstFileClose_HandleTable)->ThreadRange(1, 8);
+}
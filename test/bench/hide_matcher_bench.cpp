@@ -0,0 +1,112 @@
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "hide_matcher/hide_matcher.hpp"
+
+namespace {
+    const std::set<std::string> PATTERNS{
+        "version.dll",
+        "winhttp\\.dll$",
+        "SmokeAPI(32|64)?\\.dll",
+        "ScreamAPI(32|64)?\\.dll",
+        "Koaloader\\.(json|log)$",
+        "steam_(api|api64)\\.(dll|txt)",
+        "cream_api\\.ini",
+        "\\\\DLC\\\\[0-9]+\\\\",
+    };
+
+    const std::vector<std::string> FILE_NAMES{
+        R"(C:\Program Files (x86)\Steam\steamapps\common\Game\Data\textures\terrain_0042.dds)",
+        R"(C:\Program Files (x86)\Steam\steamapps\common\Game\Data\audio\music\track_07.ogg)",
+        R"(C:\Program Files (x86)\Steam\steamapps\common\Game\Binaries\Win64\version.dll)",
+        R"(C:\Program Files (x86)\Steam\steamapps\common\Game\Data\shaders\cache\4f2e7a.bin)",
+        R"(C:\Program Files (x86)\Steam\steamapps\common\Game\Data\DLC\1234\content.pak)",
+        R"(C:\Program Files (x86)\Steam\steamapps\common\Game\Binaries\Win64\Game.exe)",
+    };
+
+    /**
+     * Reproduces the original `is_file_hidden` implementation, which compiled every pattern per call.
+     */
+    bool is_file_hidden_per_call_regex(const std::string& filename) {
+        for(const auto& pattern : PATTERNS) {
+            if(std::regex_search(filename, std::regex(pattern, std::regex_constants::icase))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void BM_HideFiles_PerCallRegex(benchmark::State& state) {
+        size_t i = 0;
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(is_file_hidden_per_call_regex(FILE_NAMES[i++ % FILE_NAMES.size()]));
+        }
+    }
+
+    BENCHMARK(BM_HideFiles_PerCallRegex);
+
+    void BM_HideFiles_CachedRegex(benchmark::State& state) {
+        std::vector<std::regex> regexes;
+        for(const auto& pattern : PATTERNS) {
+            regexes.emplace_back(pattern, std::regex_constants::icase);
+        }
+
+        size_t i = 0;
+        for(auto _ : state) {
+            const auto& filename = FILE_NAMES[i++ % FILE_NAMES.size()];
+            bool hidden = false;
+            for(const auto& regex : regexes) {
+                if(std::regex_search(filename, regex)) {
+                    hidden = true;
+                    break;
+                }
+            }
+            benchmark::DoNotOptimize(hidden);
+        }
+    }
+
+    BENCHMARK(BM_HideFiles_CachedRegex);
+
+    void BM_HideFiles_CompiledMatcher(benchmark::State& state) {
+        const hide_matcher::Matcher matcher(PATTERNS);
+
+        size_t i = 0;
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(matcher.matches(FILE_NAMES[i++ % FILE_NAMES.size()]));
+        }
+    }
+
+    BENCHMARK(BM_HideFiles_CompiledMatcher);
+
+    /**
+     * Path taken by the W detours, which match on the OS buffer without converting to UTF-8
+     */
+    void BM_HideFiles_CompiledMatcherWide(benchmark::State& state) {
+        const hide_matcher::Matcher matcher(PATTERNS);
+
+        std::vector<std::wstring> wide_file_names;
+        for(const auto& file_name : FILE_NAMES) {
+            wide_file_names.emplace_back(file_name.begin(), file_name.end());
+        }
+
+        size_t i = 0;
+        for(auto _ : state) {
+            benchmark::DoNotOptimize(matcher.matches(std::wstring_view(wide_file_names[i++ % wide_file_names.size()])));
+        }
+    }
+
+    BENCHMARK(BM_HideFiles_CompiledMatcherWide);
+
+    void BM_HideFiles_MatcherCompilation(benchmark::State& state) {
+        for(auto _ : state) {
+            const hide_matcher::Matcher matcher(PATTERNS);
+            benchmark::DoNotOptimize(matcher.dfa_state_count());
+        }
+    }
+
+    BENCHMARK(BM_HideFiles_MatcherCompilation);
+}
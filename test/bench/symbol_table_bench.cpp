@@ -0,0 +1,190 @@
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "symbol_table/symbol_table.hpp"
+
+/**
+ * Every allocation is counted, so that the peak heap usage of each representation can be reported
+ */
+namespace {
+    std::atomic<size_t> allocated_bytes = 0;
+    std::atomic<size_t> peak_bytes = 0;
+
+    // Keeps the size in front of every allocation, which keeps the payload 16-byte aligned
+    constexpr size_t HEADER_SIZE = 16;
+
+    void* counted_allocate(const size_t size) {
+        auto* const block = static_cast<char*>(std::malloc(size + HEADER_SIZE));
+        if(not block) {
+            throw std::bad_alloc();
+        }
+
+        *reinterpret_cast<size_t*>(block) = size;
+
+        const auto current = allocated_bytes.fetch_add(size) + size;
+        auto peak = peak_bytes.load();
+        while(current > peak && not peak_bytes.compare_exchange_weak(peak, current)) {}
+
+        return block + HEADER_SIZE;
+    }
+
+    void counted_free(void* pointer) noexcept {
+        if(not pointer) {
+            return;
+        }
+
+        auto* const block = static_cast<char*>(pointer) - HEADER_SIZE;
+        allocated_bytes.fetch_sub(*reinterpret_cast<size_t*>(block));
+        std::free(block);
+    }
+}
+
+void* operator new(const size_t size) {
+    return counted_allocate(size);
+}
+
+void* operator new[](const size_t size) {
+    return counted_allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    counted_free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    counted_free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    counted_free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    counted_free(pointer);
+}
+
+namespace {
+    namespace fs = std::filesystem;
+
+    struct Library {
+        std::string path;
+        std::vector<std::string> symbols{};
+    };
+
+    /**
+     * Resembles a scan of System32 and an SDK: 2000 libraries with 150 exports each on average,
+     * a third of which come from a pool of common names such as COM and CRT entry points
+     */
+    const std::vector<Library>& get_corpus() {
+        static const auto corpus = [] {
+            std::mt19937 random(42);
+            std::vector<Library> libraries;
+
+            for(int i = 0; i < 2'000; ++i) {
+                Library library{
+                    .path = "C:/Program Files (x86)/Windows Kits/10/Redist/10.0.22621.0/ucrt/DLLs/x64/library_" +
+                            std::to_string(i) + ".dll",
+                };
+
+                const auto export_count = 50 + random() % 200;
+                for(size_t j = 0; j < export_count; ++j) {
+                    if(random() % 3 == 0) {
+                        library.symbols.push_back("CommonExportedFunction_" + std::to_string(random() % 5'000));
+                    } else {
+                        library.symbols.push_back("Library" + std::to_string(i) + "_ExportedFunction_" + std::to_string(j));
+                    }
+                }
+
+                libraries.push_back(std::move(library));
+            }
+
+            return libraries;
+        }();
+
+        return corpus;
+    }
+
+    size_t count_exports(const std::vector<Library>& corpus) {
+        size_t count = 0;
+        for(const auto& library : corpus) {
+            count += library.symbols.size();
+        }
+        return count;
+    }
+
+    /**
+     * Representation used by list_common_exports before the symbol table
+     */
+    void BM_MapOfPathSets(benchmark::State& state) {
+        const auto& corpus = get_corpus();
+        size_t peak = 0;
+        size_t retained = 0;
+
+        for(auto _ : state) {
+            const auto baseline = allocated_bytes.load();
+            peak_bytes = baseline;
+
+            std::map<std::string, std::set<fs::path>> map;
+            for(const auto& library : corpus) {
+                const fs::path path = library.path;
+                for(const auto& symbol : library.symbols) {
+                    map[symbol].insert(path);
+                }
+            }
+
+            retained = allocated_bytes.load() - baseline;
+            peak = peak_bytes.load() - baseline;
+            benchmark::DoNotOptimize(map);
+        }
+
+        state.counters["exports"] = static_cast<double>(count_exports(corpus));
+        state.counters["peak_bytes"] = static_cast<double>(peak);
+        state.counters["retained_bytes"] = static_cast<double>(retained);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count_exports(corpus)));
+    }
+
+    BENCHMARK(BM_MapOfPathSets)->Unit(benchmark::kMillisecond);
+
+    void BM_SymbolTable(benchmark::State& state) {
+        const auto& corpus = get_corpus();
+        size_t peak = 0;
+        size_t retained = 0;
+        size_t reported = 0;
+
+        for(auto _ : state) {
+            const auto baseline = allocated_bytes.load();
+            peak_bytes = baseline;
+
+            symbol_table::SymbolTable table;
+            for(const auto& library : corpus) {
+                const auto id = table.add_library(library.path);
+                for(const auto& symbol : library.symbols) {
+                    table.add(id, symbol);
+                }
+            }
+            table.finalize();
+
+            retained = allocated_bytes.load() - baseline;
+            peak = peak_bytes.load() - baseline;
+            reported = table.memory_usage();
+            benchmark::DoNotOptimize(table);
+        }
+
+        state.counters["exports"] = static_cast<double>(count_exports(corpus));
+        state.counters["peak_bytes"] = static_cast<double>(peak);
+        state.counters["retained_bytes"] = static_cast<double>(retained);
+        state.counters["memory_usage"] = static_cast<double>(reported);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count_exports(corpus)));
+    }
+
+    BENCHMARK(BM_SymbolTable)->Unit(benchmark::kMillisecond);
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "well_known_modules/well_known_modules.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    /**
+     * Paths resembling a game install: mostly assets, some binaries and the occasional well-known module
+     */
+    const std::vector<fs::path>& get_corpus() {
+        static const auto corpus = [] {
+            const std::vector<std::string> extensions{".pak", ".dds", ".ogg", ".bnk", ".json", ".txt", ".exe", ".dll"};
+            const std::vector<std::string> dll_names{
+                "steam_api64", "d3dcompiler_47", "PhysX3_x64", "bink2w64", "fmod", "vcruntime140", "EOSSDK-Win64-Shipping",
+            };
+
+            std::mt19937 random(42);
+            std::vector<fs::path> paths;
+
+            for(int i = 0; i < 10'000; ++i) {
+                const auto& extension = extensions[random() % extensions.size()];
+                const auto directory = "C:/Games/Title/Content/Paks/dir_" + std::to_string(random() % 100) + "/";
+
+                if(extension == ".dll") {
+                    paths.emplace_back(directory + dll_names[random() % dll_names.size()] + extension);
+                } else {
+                    paths.emplace_back(directory + "asset_" + std::to_string(i) + extension);
+                }
+            }
+
+            paths[5'000] = "C:/Games/Title/Binaries/Win64/SmokeAPI64.dll";
+
+            return paths;
+        }();
+
+        return corpus;
+    }
+
+    bool equals_ignore_case(const std::string& a, const std::string& b) {
+        return std::ranges::equal(a, b, [](const char x, const char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    /**
+     * Original filter from koaloader.cpp: allocate extension and file name, then compare against every name
+     */
+    bool is_well_known_linear(const fs::path& path) {
+        static const auto modules = [] {
+            std::set<std::string> result;
+            for(const auto name : well_known_modules::BASE_NAMES) {
+                result.insert(std::string(name) + ".dll");
+                result.insert(std::string(name) + "64.dll");
+            }
+            return result;
+        }();
+
+        if(not path.has_filename()) {
+            return false;
+        }
+
+        if(not equals_ignore_case(path.extension().string(), ".dll")) {
+            return false;
+        }
+
+        const auto filename = path.filename().string();
+        for(const auto& dll : modules) {
+            if(equals_ignore_case(filename, dll)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void BM_WellKnown_LinearScan(benchmark::State& state) {
+        const auto& corpus = get_corpus();
+
+        for(auto _ : state) {
+            size_t found = 0;
+            for(const auto& path : corpus) {
+                found += is_well_known_linear(path);
+            }
+            benchmark::DoNotOptimize(found);
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * corpus.size()));
+    }
+
+    BENCHMARK(BM_WellKnown_LinearScan);
+
+    void BM_WellKnown_ConstexprSet(benchmark::State& state) {
+        const auto& corpus = get_corpus();
+        constexpr well_known_modules::Set modules{64};
+
+        for(auto _ : state) {
+            size_t found = 0;
+            for(const auto& path : corpus) {
+                found += modules.contains_file_name_of(std::basic_string_view<fs::path::value_type>(path.native()));
+            }
+            benchmark::DoNotOptimize(found);
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * corpus.size()));
+    }
+
+    BENCHMARK(BM_WellKnown_ConstexprSet);
+}
@@ -0,0 +1,278 @@
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "byte_scanner/byte_scanner.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    /**
+     * Reference implementation that checks every position
+     */
+    std::optional<size_t> naive_find(
+        const std::string& haystack,
+        const std::string& bytes,
+        const std::vector<bool>& wildcards
+    ) {
+        for(size_t i = 0; i + bytes.size() <= haystack.size(); ++i) {
+            bool matches = true;
+            for(size_t j = 0; j < bytes.size() && matches; ++j) {
+                matches = wildcards[j] || haystack[i + j] == bytes[j];
+            }
+            if(matches) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::string to_signature(const std::string& bytes, const std::vector<bool>& wildcards) {
+        constexpr auto HEX = "0123456789ABCDEF";
+
+        std::string signature;
+        for(size_t j = 0; j < bytes.size(); ++j) {
+            if(j > 0) {
+                signature += ' ';
+            }
+            if(wildcards[j]) {
+                signature += "??";
+            } else {
+                const auto byte = static_cast<uint8_t>(bytes[j]);
+                signature += HEX[byte >> 4];
+                signature += HEX[byte & 0xF];
+            }
+        }
+        return signature;
+    }
+
+    void test_parse() {
+        const auto signature = byte_scanner::Signature::parse("48 8B ?? ?  05\t");
+        CHECK(signature.size() == 5);
+        CHECK(signature.wildcard_count() == 2);
+
+        const std::string haystack("\x00\x48\x8B\x01\x02\x05\x00", 7);
+        CHECK(signature.find(haystack) == 1);
+        CHECK(signature.matches_at(haystack, 1));
+        CHECK(not signature.matches_at(haystack, 0));
+        CHECK(not signature.matches_at(haystack, 3));
+        CHECK(not signature.matches_at(haystack, 100));
+
+        for(const auto* const invalid : {"", "?? ??", "4", "488B", "G0", "48 ???", "0x48"}) {
+            bool thrown = false;
+            try {
+                (void) byte_scanner::Signature::parse(invalid);
+            } catch(const std::invalid_argument&) {
+                thrown = true;
+            }
+            CHECK(thrown);
+        }
+
+        bool thrown = false;
+        try {
+            (void) byte_scanner::Signature::literal("");
+        } catch(const std::invalid_argument&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    void test_literal(const byte_scanner::Isa isa) {
+        const auto signature = byte_scanner::Signature::literal("steam_api64.dll");
+
+        std::string haystack(1000, 's');
+        CHECK(not signature.find(haystack, isa).has_value());
+
+        // At the very end, which is only reachable by the tail of a vectorized search
+        haystack.replace(haystack.size() - 15, 15, "steam_api64.dll");
+        CHECK(signature.find(haystack, isa) == haystack.size() - 15);
+
+        haystack.replace(0, 15, "steam_api64.dll");
+        CHECK(signature.find(haystack, isa) == 0);
+
+        CHECK(not signature.find("steam_api64.dl", isa).has_value());
+        CHECK(signature.find("steam_api64.dll", isa) == 0);
+    }
+
+    /**
+     * Random signatures with planted matches, compared against the reference implementation
+     */
+    void test_against_naive(const byte_scanner::Isa isa) {
+        std::mt19937 random(42);
+
+        for(int iteration = 0; iteration < 2000; ++iteration) {
+            // A small alphabet produces many partial matches
+            const auto alphabet = std::uniform_int_distribution<int>(1, 4)(random);
+            const auto random_byte = [&] {
+                return static_cast<char>(0xF0 + std::uniform_int_distribution<int>(0, alphabet)(random));
+            };
+
+            const auto length = std::uniform_int_distribution<size_t>(1, 40)(random);
+            std::string bytes(length, '\0');
+            std::vector<bool> wildcards(length);
+            bool has_fixed_byte = false;
+            for(size_t j = 0; j < length; ++j) {
+                bytes[j] = random_byte();
+                wildcards[j] = std::uniform_int_distribution<int>(0, 3)(random) == 0;
+                has_fixed_byte |= not wildcards[j];
+            }
+            if(not has_fixed_byte) {
+                wildcards[length / 2] = false;
+            }
+
+            std::string haystack(std::uniform_int_distribution<size_t>(0, 300)(random), '\0');
+            for(auto& byte : haystack) {
+                byte = random_byte();
+            }
+            if(haystack.size() >= length && iteration % 2 == 0) {
+                const auto offset = std::uniform_int_distribution<size_t>(0, haystack.size() - length)(random);
+                haystack.replace(offset, length, bytes);
+            }
+
+            for(size_t j = 0; j < length; ++j) {
+                if(wildcards[j]) {
+                    bytes[j] = 0;
+                }
+            }
+
+            const auto signature = byte_scanner::Signature::parse(to_signature(bytes, wildcards));
+            CHECK(signature.find(haystack, isa) == naive_find(haystack, bytes, wildcards));
+        }
+    }
+
+    void test_signature_set() {
+        std::vector<byte_scanner::Signature> signatures;
+        signatures.push_back(byte_scanner::Signature::literal("he"));
+        signatures.push_back(byte_scanner::Signature::literal("she"));
+        signatures.push_back(byte_scanner::Signature::literal("his"));
+        signatures.push_back(byte_scanner::Signature::literal("hers"));
+        signatures.push_back(byte_scanner::Signature::literal("missing"));
+        // "s?e" with the key "s" preceded by a wildcard
+        signatures.push_back(byte_scanner::Signature::parse("?? 73 ?? 65"));
+        signatures.push_back(byte_scanner::Signature::literal("he"));
+
+        const byte_scanner::SignatureSet set(signatures);
+        CHECK(set.size() == 7);
+
+        const auto results = set.find_all("ushers his");
+        CHECK(results.size() == 7);
+        CHECK(results[0] == 2);
+        CHECK(results[1] == 1);
+        CHECK(results[2] == 7);
+        CHECK(results[3] == 2);
+        CHECK(not results[4].has_value());
+        CHECK(results[5] == 0);
+        // The only other "he" overlaps the first one
+        CHECK(not results[6].has_value());
+
+        // Keys that end before the signature could start are not matches
+        CHECK(not byte_scanner::SignatureSet({byte_scanner::Signature::parse("?? ?? 41")}).find_all("AA")[0]);
+        CHECK(byte_scanner::SignatureSet({byte_scanner::Signature::parse("?? ?? 41")}).find_all("AAA")[0] == 0);
+    }
+
+    void test_signature_set_repeats() {
+        std::vector<byte_scanner::Signature> signatures;
+        signatures.push_back(byte_scanner::Signature::literal("steam_api"));
+        signatures.push_back(byte_scanner::Signature::literal("aaa"));
+        signatures.push_back(byte_scanner::Signature::literal("steam_api"));
+        signatures.push_back(byte_scanner::Signature::literal("aaa"));
+        signatures.push_back(byte_scanner::Signature::literal("steam_api"));
+        signatures.push_back(byte_scanner::Signature::literal("steam_api"));
+
+        const std::string haystack = "aaaaa steam_api.dll steam_api64.dll steam_api_o.dll";
+        const byte_scanner::SignatureSet set(signatures);
+
+        // Repeated entries take successive matches that do not overlap, like patching them one by one
+        const std::vector<std::optional<size_t>> expected{6, 0, 20, std::nullopt, 36, std::nullopt};
+        for(const auto isa : byte_scanner::supported_isas()) {
+            CHECK(set.find_all(haystack, isa) == expected);
+        }
+        CHECK(set.find_all_parallel(haystack, 4, 8) == expected);
+    }
+
+    /**
+     * Random signature sets compared against searching for each signature separately
+     */
+    void test_signature_set_against_single() {
+        std::mt19937 random(7);
+
+        for(int iteration = 0; iteration < 500; ++iteration) {
+            const auto random_byte = [&] {
+                return static_cast<char>('a' + std::uniform_int_distribution<int>(0, 3)(random));
+            };
+
+            std::vector<byte_scanner::Signature> signatures;
+            std::vector<std::string> patterns;
+            const auto count = std::uniform_int_distribution<size_t>(1, 12)(random);
+            for(size_t i = 0; i < count; ++i) {
+                const auto length = std::uniform_int_distribution<size_t>(1, 8)(random);
+                std::string bytes(length, '\0');
+                std::vector<bool> wildcards(length);
+                for(size_t j = 0; j < length; ++j) {
+                    bytes[j] = random_byte();
+                    wildcards[j] = j != length / 2 && std::uniform_int_distribution<int>(0, 4)(random) == 0;
+                }
+                patterns.push_back(to_signature(bytes, wildcards));
+                signatures.push_back(byte_scanner::Signature::parse(patterns.back()));
+            }
+
+            // Repeated signatures search after the match of the previous one
+            const auto find_expected = [&](const std::string& haystack) {
+                std::vector<std::optional<size_t>> expected(count);
+                for(size_t i = 0; i < count; ++i) {
+                    size_t begin = 0;
+                    bool repeated = false;
+                    for(size_t j = i; j-- > 0;) {
+                        if(patterns[j] == patterns[i]) {
+                            repeated = true;
+                            begin = expected[j] ? *expected[j] + signatures[i].size() : haystack.size() + 1;
+                            break;
+                        }
+                    }
+
+                    if(not repeated) {
+                        expected[i] = signatures[i].find(haystack, byte_scanner::Isa::SCALAR);
+                    } else if(begin <= haystack.size()) {
+                        if(const auto offset = signatures[i].find(haystack.substr(begin), byte_scanner::Isa::SCALAR)) {
+                            expected[i] = begin + *offset;
+                        }
+                    }
+                }
+                return expected;
+            };
+
+            // Bytes outside of the signatures' alphabet exercise skipping,
+            // including 0xE1..0xE4 that share nibble buckets with 'a'..'d'
+            std::string haystack(std::uniform_int_distribution<size_t>(0, 2000)(random), '\0');
+            for(auto& byte : haystack) {
+                const auto kind = std::uniform_int_distribution<int>(0, 9)(random);
+                byte = kind < 2 ? random_byte() : kind < 4 ? static_cast<char>(random_byte() + 0x80) : 'x';
+            }
+
+            const byte_scanner::SignatureSet set(signatures);
+            for(const auto isa : byte_scanner::supported_isas()) {
+                CHECK(set.find_all(haystack, isa) == find_expected(haystack));
+            }
+
+            // Chunks smaller than the signatures exercise matches that span several chunks
+            const auto chunk_size = std::uniform_int_distribution<size_t>(1, 64)(random);
+            CHECK(set.find_all_parallel(haystack, 4, chunk_size) == set.find_all(haystack));
+        }
+    }
+}
+
+int main() {
+    test_parse();
+
+    for(const auto isa : byte_scanner::supported_isas()) {
+        test_literal(isa);
+        test_against_naive(isa);
+    }
+
+    test_signature_set();
+    test_signature_set_repeats();
+    test_signature_set_against_single();
+
+    return test_utils::exit_code();
+}
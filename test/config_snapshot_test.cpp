@@ -0,0 +1,158 @@
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "config_snapshot/config_snapshot.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr auto BUILD_ID = "Koaloader 4.0.0 (Oct 16 2026 12:00:00)";
+
+    void write_file(const fs::path& path, const std::string& contents) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << contents;
+    }
+
+    std::string read_file(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    void test_writer_and_reader() {
+        config_snapshot::Writer writer;
+        writer.write(true);
+        writer.write<int32_t>(-1);
+        writer.write_string("Koaloader");
+        writer.write_string("");
+        writer.write_vector(std::vector<uint16_t>{1, 2, 65535});
+
+        config_snapshot::Reader reader(writer.data());
+        CHECK(reader.read<bool>() == true);
+        CHECK(reader.read<int32_t>() == -1);
+        CHECK(reader.read_string() == "Koaloader");
+        CHECK(reader.read_string().empty());
+        CHECK((reader.read_vector<uint16_t>() == std::vector<uint16_t>{1, 2, 65535}));
+        CHECK(reader.remaining() == 0);
+
+        try {
+            (void) reader.read<uint8_t>();
+            CHECK(false);
+        } catch(const std::runtime_error&) {}
+
+        // A corrupted length must not cause a huge allocation
+        config_snapshot::Writer bogus;
+        bogus.write<uint64_t>(UINT64_MAX / 2);
+        try {
+            config_snapshot::Reader bogus_reader(bogus.data());
+            (void) bogus_reader.read_vector<uint32_t>();
+            CHECK(false);
+        } catch(const std::runtime_error&) {}
+    }
+
+    void test_store_and_load(const fs::path& directory) {
+        const auto config_path = directory / "Koaloader.config.json";
+        const auto snapshot_path = directory / "Koaloader.config.snapshot";
+        const std::string payload("compiled\0config", 15);
+
+        write_file(config_path, R"({"logging": true})");
+
+        CHECK(not config_snapshot::get_stamp(directory / "missing.json"));
+
+        const auto stamp = config_snapshot::get_stamp(config_path);
+        CHECK(stamp.has_value());
+        if(not stamp) {
+            return;
+        }
+        CHECK(stamp->size == 17);
+
+        CHECK(not config_snapshot::load(snapshot_path, *stamp, BUILD_ID));
+
+        config_snapshot::store(snapshot_path, *stamp, BUILD_ID, payload);
+        CHECK(config_snapshot::load(snapshot_path, *stamp, BUILD_ID) == payload);
+
+        // No temporary files are left behind
+        size_t file_count = 0;
+        for([[maybe_unused]] const auto& entry : fs::directory_iterator(directory)) {
+            ++file_count;
+        }
+        CHECK(file_count == 2);
+
+        // Another build may have a different payload layout
+        CHECK(not config_snapshot::load(snapshot_path, *stamp, "Koaloader 4.0.1"));
+
+        // Editing the config invalidates the snapshot
+        write_file(config_path, R"({"logging": false})");
+        const auto edited = config_snapshot::get_stamp(config_path);
+        CHECK(edited.has_value() && *edited != *stamp);
+        if(edited) {
+            CHECK(not config_snapshot::load(snapshot_path, *edited, BUILD_ID));
+        }
+
+        // Same size, different modification time
+        auto touched = *stamp;
+        touched.modified += 1;
+        CHECK(not config_snapshot::load(snapshot_path, touched, BUILD_ID));
+
+        // Corruption of the payload is detected by the checksum
+        auto contents = read_file(snapshot_path);
+        contents[contents.size() - 3] ^= 0x20;
+        write_file(snapshot_path, contents);
+        CHECK(not config_snapshot::load(snapshot_path, *stamp, BUILD_ID));
+
+        // Truncation as well
+        config_snapshot::store(snapshot_path, *stamp, BUILD_ID, payload);
+        contents = read_file(snapshot_path);
+        write_file(snapshot_path, contents.substr(0, contents.size() - 4));
+        CHECK(not config_snapshot::load(snapshot_path, *stamp, BUILD_ID));
+
+        write_file(snapshot_path, "garbage");
+        CHECK(not config_snapshot::load(snapshot_path, *stamp, BUILD_ID));
+    }
+
+    void test_concurrent_store(const fs::path& directory) {
+        const auto snapshot_path = directory / "concurrent.snapshot";
+        const config_snapshot::Stamp stamp{.size = 1, .modified = 2};
+
+        // Processes started at the same time may all store the snapshot, and readers never see a partial one
+        std::vector<std::thread> threads;
+        for(int t = 0; t < 4; ++t) {
+            threads.emplace_back(
+                [&, t] {
+                    for(int i = 0; i < 50; ++i) {
+                        try {
+                            config_snapshot::store(snapshot_path, stamp, BUILD_ID, std::string(1000, static_cast<char>('a' + t)));
+                        } catch(const std::runtime_error&) {}
+
+                        if(const auto payload = config_snapshot::load(snapshot_path, stamp, BUILD_ID)) {
+                            CHECK(payload->size() == 1000);
+                            CHECK(payload->find_first_not_of(payload->front()) == std::string::npos);
+                        }
+                    }
+                }
+            );
+        }
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        CHECK(config_snapshot::load(snapshot_path, stamp, BUILD_ID).has_value());
+    }
+}
+
+int main() {
+    const auto directory = fs::temp_directory_path() / "koaloader_config_snapshot_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    test_writer_and_reader();
+    test_store_and_load(directory);
+    test_concurrent_store(directory);
+
+    fs::remove_all(directory);
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,136 @@
+#include <atomic>
+#include <fstream>
+
+#include "directory_walker/directory_walker.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    void touch(const fs::path& path) {
+        fs::create_directories(path.parent_path());
+        std::ofstream(path).put('\0');
+    }
+
+    /**
+     * Creates `width`^`depth` leaf directories with a few files each
+     */
+    void generate_tree(const fs::path& directory, const int width, const int depth) {
+        for(int file = 0; file < 3; ++file) {
+            touch(directory / ("asset_" + std::to_string(file) + ".pak"));
+        }
+
+        if(depth == 0) {
+            return;
+        }
+
+        for(int child = 0; child < width; ++child) {
+            generate_tree(directory / ("dir_" + std::to_string(child)), width, depth - 1);
+        }
+    }
+
+    bool is_target(const fs::directory_entry& entry) {
+        return entry.path().filename() == "SmokeAPI64.dll";
+    }
+
+    void test_finds_deep_file(const fs::path& root) {
+        for(const size_t threads : {1, 2, 4, 8}) {
+            const auto result = directory_walker::find_first(root, is_target, {.thread_count = threads});
+            CHECK(result.path.has_value());
+            CHECK(result.path && result.path->filename() == "SmokeAPI64.dll");
+        }
+    }
+
+    void test_missing_file(const fs::path& root) {
+        for(const size_t threads : {1, 4}) {
+            std::atomic<size_t> visited = 0;
+            const auto result = directory_walker::find_first(root, [&](const fs::directory_entry& entry) {
+                ++visited;
+                return entry.path().filename() == "missing.dll";
+            }, {.thread_count = threads, .collect_listed_directories = true});
+
+            CHECK(not result.path.has_value());
+            // 3 files in each of 1 + 3 + 9 + 27 directories, plus the target file
+            CHECK(visited == 121);
+            CHECK(result.files_visited == 121);
+            CHECK(result.directories_visited == 40);
+            CHECK(result.listed_directories.size() == 40);
+            CHECK(not result.deadline_exceeded);
+        }
+    }
+
+    void test_stops_after_first_match(const fs::path& root) {
+        std::atomic<size_t> matches = 0;
+        const auto result = directory_walker::find_first(root, [&](const fs::directory_entry&) {
+            ++matches;
+            return true;
+        }, {.thread_count = 4});
+
+        CHECK(result.path.has_value());
+        // Workers that were already evaluating an entry may still finish it
+        CHECK(matches <= 4);
+    }
+
+    void test_max_depth(const fs::path& root) {
+        // The target is at depth 3
+        const auto shallow = directory_walker::find_first(root, is_target, {.thread_count = 2, .max_depth = 2});
+        CHECK(not shallow.path.has_value());
+        CHECK(shallow.directories_visited == 13);
+        CHECK(shallow.directories_beyond_max_depth == 27);
+
+        const auto deep = directory_walker::find_first(root, is_target, {.thread_count = 2, .max_depth = 3});
+        CHECK(deep.path.has_value());
+
+        const auto root_only = directory_walker::find_first(root, is_target, {.max_depth = 0});
+        CHECK(root_only.directories_visited == 1);
+        CHECK(root_only.files_visited == 3);
+    }
+
+    void test_exclusions(const fs::path& root) {
+        const auto result = directory_walker::find_first(root, is_target, {
+            .thread_count = 2,
+            .is_excluded = [](const fs::directory_entry& entry) { return entry.path().filename() == "dir_2"; },
+        });
+
+        CHECK(not result.path.has_value());
+        // dir_2 is excluded at every level
+        CHECK(result.directories_visited == 15);
+        CHECK(result.directories_excluded == 7);
+    }
+
+    void test_deadline(const fs::path& root) {
+        const auto result = directory_walker::find_first(root, is_target, {
+            .thread_count = 2,
+            .deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(1),
+        });
+
+        CHECK(not result.path.has_value());
+        CHECK(result.deadline_exceeded);
+        CHECK(result.directories_visited == 0);
+    }
+
+    void test_missing_root() {
+        const auto result = directory_walker::find_first("/nonexistent/koaloader/root", is_target, {.thread_count = 2});
+        CHECK(not result.path.has_value());
+    }
+}
+
+int main() {
+    const auto root = fs::temp_directory_path() / "koaloader_directory_walker_test";
+    fs::remove_all(root);
+
+    generate_tree(root, 3, 3);
+    touch(root / "dir_2" / "dir_1" / "dir_0" / "SmokeAPI64.dll");
+
+    test_finds_deep_file(root);
+    test_missing_file(root);
+    test_stops_after_first_match(root);
+    test_max_depth(root);
+    test_exclusions(root);
+    test_deadline(root);
+    test_missing_root();
+
+    fs::remove_all(root);
+
+    return test_utils::exit_code();
+}
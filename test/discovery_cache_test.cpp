@@ -0,0 +1,185 @@
+#include <fstream>
+
+#include "directory_walker/directory_walker.hpp"
+#include "discovery_cache/discovery_cache.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    void write_file(const fs::path& path, const std::string& content) {
+        fs::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::trunc) << content;
+    }
+
+    discovery_cache::Entry make_entry(const discovery_cache::Key& key, const fs::path& module_path) {
+        return {
+            .key = key,
+            .module_path = module_path,
+            .dependencies = {key.starting_directory, module_path},
+            .scan_duration = std::chrono::milliseconds(1234),
+        };
+    }
+
+    void test_hit_and_invalidation(const fs::path& root) {
+        const auto game_dir = root / "game";
+        // Typical setup: the cache lives in the directory that is searched first
+        const auto cache_path = game_dir / "Koaloader.cache";
+        const auto module_path = game_dir / "dlc" / "SmokeAPI64.dll";
+        write_file(module_path, "module");
+
+        const discovery_cache::Key key{
+            .executable_path = game_dir / "game.exe",
+            .koaloader_directory = game_dir,
+            .starting_directory = game_dir,
+        };
+
+        CHECK(not discovery_cache::lookup(cache_path, key));
+
+        discovery_cache::store(cache_path, make_entry(key, module_path));
+
+        const auto hit = discovery_cache::lookup(cache_path, key);
+        CHECK(hit.has_value());
+        CHECK(hit && hit->module_path == module_path);
+        CHECK(hit && hit->scan_duration.count() == 1234);
+
+        // Different executable does not share the entry
+        auto other_key = key;
+        other_key.executable_path = game_dir / "launcher.exe";
+        CHECK(not discovery_cache::lookup(cache_path, other_key));
+
+        // Both entries coexist
+        const auto other_module = game_dir / "ScreamAPI.dll";
+        write_file(other_module, "other");
+        discovery_cache::store(cache_path, make_entry(other_key, other_module));
+        CHECK(discovery_cache::lookup(cache_path, other_key).has_value());
+
+        // Replaced module invalidates the entry
+        write_file(module_path, "module v2");
+        CHECK(not discovery_cache::lookup(cache_path, key));
+
+        discovery_cache::store(cache_path, make_entry(key, module_path));
+        CHECK(discovery_cache::lookup(cache_path, key).has_value());
+
+        // A new file in a searched directory invalidates the entry
+        const auto before = fs::last_write_time(game_dir);
+        write_file(game_dir / "Unlocker.dll", "new");
+        fs::last_write_time(game_dir, before + std::chrono::seconds(1));
+        CHECK(not discovery_cache::lookup(cache_path, key));
+
+        // Deleted module invalidates the entry
+        discovery_cache::store(cache_path, make_entry(key, module_path));
+        fs::remove(module_path);
+        CHECK(not discovery_cache::lookup(cache_path, key));
+    }
+
+    void test_negative_entry(const fs::path& root) {
+        const auto game_dir = root / "empty_game";
+        const auto cache_path = root / "negative.cache";
+        fs::create_directories(game_dir);
+
+        const discovery_cache::Key key{
+            .executable_path = game_dir / "game.exe",
+            .koaloader_directory = root,
+            .starting_directory = game_dir,
+        };
+
+        discovery_cache::store(cache_path, {
+            .key = key,
+            .module_path = std::nullopt,
+            .dependencies = {game_dir, root},
+            .scan_duration = std::chrono::milliseconds(5000),
+        });
+
+        // A search that found nothing is not repeated
+        const auto hit = discovery_cache::lookup(cache_path, key);
+        CHECK(hit.has_value());
+        CHECK(hit && not hit->module_path);
+        CHECK(hit && hit->scan_duration.count() == 5000);
+
+        // A new file in a searched directory invalidates the entry
+        const auto before = fs::last_write_time(game_dir);
+        write_file(game_dir / "Unlocker.dll", "new");
+        fs::last_write_time(game_dir, before + std::chrono::seconds(1));
+        CHECK(not discovery_cache::lookup(cache_path, key));
+    }
+
+    void test_negative_entry_subdirectory(const fs::path& root) {
+        const auto game_dir = root / "walked_game";
+        const auto cache_path = root / "walked.cache";
+        write_file(game_dir / "data" / "textures" / "asset.pak", "asset");
+        write_file(game_dir / "plugins" / "readme.txt", "readme");
+
+        const discovery_cache::Key key{
+            .executable_path = game_dir / "game.exe",
+            .koaloader_directory = root,
+            .starting_directory = game_dir,
+            .max_depth = 4,
+            .excluded_directories = {"logs"},
+        };
+
+        const auto result = directory_walker::find_first(game_dir, [](const fs::directory_entry& entry) {
+            return entry.path().extension() == ".dll";
+        }, {.thread_count = 2, .collect_listed_directories = true});
+        CHECK(not result.path);
+        CHECK(result.listed_directories.size() == 4);
+
+        discovery_cache::store(cache_path, {
+            .key = key,
+            .module_path = std::nullopt,
+            .dependencies = result.listed_directories,
+            .scan_duration = std::chrono::milliseconds(800),
+        });
+        CHECK(discovery_cache::lookup(cache_path, key).has_value());
+
+        // Different search limits do not share the entry
+        auto other_key = key;
+        other_key.max_depth = 1;
+        CHECK(not discovery_cache::lookup(cache_path, other_key));
+        other_key = key;
+        other_key.excluded_directories.clear();
+        CHECK(not discovery_cache::lookup(cache_path, other_key));
+        other_key = key;
+        other_key.time_limit_ms = 500;
+        CHECK(not discovery_cache::lookup(cache_path, other_key));
+
+        // A module that appears deep in a walked subdirectory invalidates the entry
+        const auto textures_dir = game_dir / "data" / "textures";
+        const auto before = fs::last_write_time(textures_dir);
+        write_file(textures_dir / "SmokeAPI64.dll", "module");
+        fs::last_write_time(textures_dir, before + std::chrono::seconds(1));
+        CHECK(not discovery_cache::lookup(cache_path, key));
+    }
+
+    void test_corrupted_cache(const fs::path& root) {
+        const auto cache_path = root / "corrupted.cache";
+        const discovery_cache::Key key{.executable_path = "a.exe", .koaloader_directory = root, .starting_directory = root};
+
+        write_file(cache_path, "garbage");
+        CHECK(not discovery_cache::lookup(cache_path, key));
+
+        write_file(cache_path, "koaloader-discovery-cache 3\nentry\nscan_ms not-a-number\nend\n");
+        CHECK(not discovery_cache::lookup(cache_path, key));
+
+        // Storing over a corrupted cache recovers
+        const auto module_path = root / "Lyptus.dll";
+        write_file(module_path, "module");
+        discovery_cache::store(cache_path, make_entry(key, module_path));
+        CHECK(discovery_cache::lookup(cache_path, key).has_value());
+    }
+}
+
+int main() {
+    const auto root = fs::temp_directory_path() / "koaloader_discovery_cache_test";
+    fs::remove_all(root);
+    fs::create_directories(root);
+
+    test_hit_and_invalidation(root);
+    test_negative_entry(root);
+    test_negative_entry_subdirectory(root);
+    test_corrupted_cache(root);
+
+    fs::remove_all(root);
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,179 @@
+#include <fstream>
+#include <sstream>
+
+#include "export_index/export_index.hpp"
+#include "test_utils.hpp"
+
+/**
+ * Uses the PE fixtures of `pe_exports_test`
+ */
+namespace {
+    namespace fs = std::filesystem;
+    using export_index::Index;
+
+    const fs::path FIXTURES_DIR = PE_FIXTURES_DIR;
+
+    std::string read_file(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    void write_file(const fs::path& path, const std::string& contents) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << contents;
+    }
+
+    uint64_t hash(const std::string& data) {
+        return export_index::content_hash({reinterpret_cast<const uint8_t*>(data.data()), data.size()});
+    }
+
+    void test_content_hash() {
+        const auto data = read_file(FIXTURES_DIR / "exports64.dll");
+
+        CHECK(hash(data) == hash(data));
+        CHECK(hash("") != hash(std::string(1, '\0')));
+        CHECK(hash("abcdefghi") != hash("abcdefgh"));
+
+        // Every byte contributes, including the ones after the last full word
+        for(const auto position : {size_t{0}, size_t{7}, size_t{100}, data.size() - 1}) {
+            auto changed = data;
+            changed[position] ^= 1;
+            CHECK(hash(changed) != hash(data));
+        }
+    }
+
+    void test_update(const fs::path& directory) {
+        for(const auto* const name : {"exports64.dll", "exports32.dll", "no_exports.dll"}) {
+            fs::copy_file(FIXTURES_DIR / name, directory / name);
+        }
+        write_file(directory / "not_pe.dll", "Not a PE image");
+
+        const std::vector<fs::path> paths{
+            directory / "exports64.dll",
+            directory / "exports32.dll",
+            directory / "no_exports.dll",
+            directory / "not_pe.dll",
+            // Duplicates are processed once
+            directory / "." / "exports64.dll",
+        };
+
+        Index index;
+
+        auto stats = index.update(paths, 2);
+        CHECK(stats.parsed == 3);
+        CHECK(stats.failed == 1);
+        CHECK(stats.unchanged == 0);
+        CHECK(index.entries().size() == 4);
+
+        const auto exports64 = Index::to_key(directory / "exports64.dll");
+        const auto exports32 = Index::to_key(directory / "exports32.dll");
+        const auto not_pe = Index::to_key(directory / "not_pe.dll");
+
+        CHECK(index.entries().at(not_pe).error.has_value());
+        CHECK((index.entries().at(exports64).symbols == std::vector<std::string>{
+            "Alpha", "Forwarded", "Shared", "SharedAlias"
+        }));
+
+        // Unchanged files are not read, including those that failed to parse
+        stats = index.update(paths, 2);
+        CHECK(stats.unchanged == 4);
+        CHECK(stats.parsed == 0 && stats.rehashed == 0 && stats.failed == 0);
+
+        // A new modification time with the same content only rehashes the file
+        const auto exports32_path = directory / "exports32.dll";
+        fs::last_write_time(exports32_path, fs::last_write_time(exports32_path) + std::chrono::hours(1));
+
+        stats = index.update(paths, 1);
+        CHECK(stats.rehashed == 1);
+        CHECK(stats.unchanged == 3);
+        CHECK(index.entries().at(exports32).stamp == *config_snapshot::get_stamp(exports32_path));
+
+        // A new content is parsed again
+        fs::copy_file(FIXTURES_DIR / "exports32.dll", directory / "no_exports.dll", fs::copy_options::overwrite_existing);
+        fs::last_write_time(directory / "no_exports.dll", fs::last_write_time(exports32_path) + std::chrono::hours(1));
+
+        stats = index.update(paths, 1);
+        CHECK(stats.parsed == 1);
+        CHECK(index.entries().at(Index::to_key(directory / "no_exports.dll")).symbols.size() == 3);
+
+        // Entries of other libraries are kept unless they no longer exist
+        fs::remove(directory / "not_pe.dll");
+
+        stats = index.update({directory / "exports64.dll", directory / "missing.dll"}, 1);
+        CHECK(stats.unchanged == 1);
+        CHECK(stats.failed == 1);
+        CHECK(stats.removed == 1);
+        CHECK(index.entries().size() == 3);
+        CHECK(not index.entries().contains(not_pe));
+    }
+
+    void test_queries(const fs::path& directory) {
+        Index index;
+        index.update({directory / "exports64.dll", directory / "exports32.dll"}, 1);
+
+        const auto exports64 = Index::to_key(directory / "exports64.dll");
+        const auto exports32 = Index::to_key(directory / "exports32.dll");
+
+        CHECK((index.libraries_exporting("Shared") == std::vector{exports32, exports64}));
+        CHECK((index.libraries_exporting("Alpha") == std::vector{exports64}));
+        CHECK(index.libraries_exporting("shared").empty());
+
+        CHECK((index.resolve("EXPORTS32.DLL") == std::vector{exports32}));
+        CHECK((index.resolve((directory / "exports64.dll").string()) == std::vector{exports64}));
+        CHECK(index.resolve("missing.dll").empty());
+
+        CHECK((index.shared_symbols({exports64, exports32}) == std::vector<std::string>{"Shared"}));
+        CHECK(index.shared_symbols({exports64}).size() == 4);
+        CHECK(index.shared_symbols({exports64, "missing.dll"}).empty());
+    }
+
+    void test_save_and_load(const fs::path& directory) {
+        const auto index_path = directory / "exports.index";
+
+        CHECK(Index::load(index_path).entries().empty());
+
+        Index index;
+        index.update({directory / "exports64.dll", directory / "exports32.dll"}, 1);
+        index.save(index_path);
+
+        const auto loaded = Index::load(index_path);
+        CHECK(loaded.entries().size() == 2);
+
+        for(const auto& [key, entry] : index.entries()) {
+            const auto it = loaded.entries().find(key);
+            CHECK(it != loaded.entries().end());
+
+            if(it != loaded.entries().end()) {
+                CHECK(it->second.stamp == entry.stamp);
+                CHECK(it->second.hash == entry.hash);
+                CHECK(it->second.symbols == entry.symbols);
+                CHECK(it->second.error == entry.error);
+            }
+        }
+
+        auto corrupted = read_file(index_path);
+        corrupted[corrupted.size() / 2] ^= 1;
+        write_file(index_path, corrupted);
+        CHECK(Index::load(index_path).entries().empty());
+
+        write_file(index_path, corrupted.substr(0, corrupted.size() / 2));
+        CHECK(Index::load(index_path).entries().empty());
+    }
+}
+
+int main() {
+    const auto directory = fs::temp_directory_path() / "koaloader_export_index_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    test_content_hash();
+    test_update(directory);
+    test_queries(directory);
+    test_save_and_load(directory);
+
+    fs::remove_all(directory);
+
+    return test_utils::exit_code();
+}
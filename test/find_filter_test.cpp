@@ -0,0 +1,217 @@
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "find_filter/find_filter.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    using find_filter::Advance;
+    using find_filter::FILE_NOT_FOUND;
+    using find_filter::NO_MORE_FILES;
+    using find_filter::State;
+
+    // `ERROR_IO_DEVICE`, which the simulated directory reports for a failing entry
+    constexpr uint32_t IO_DEVICE = 1117;
+
+    /**
+     * Find handle positioned at the first entry, like after a successful `FindFirstFileW`
+     */
+    class SimulatedDirectory final : public find_filter::Source {
+    public:
+        explicit SimulatedDirectory(std::vector<std::u16string> entries, const std::optional<size_t> failing_entry = {}) :
+            entries(std::move(entries)), failing_entry(failing_entry) {}
+
+        Advance next() override {
+            next_calls++;
+
+            if(failing_entry == position + 1) {
+                last_error = IO_DEVICE;
+                return Advance::FAILURE;
+            }
+
+            if(position + 1 >= entries.size()) {
+                last_error = NO_MORE_FILES;
+                return Advance::END;
+            }
+
+            position++;
+            return Advance::ENTRY;
+        }
+
+        [[nodiscard]] std::u16string_view name() const override {
+            return entries[position];
+        }
+
+        [[nodiscard]] uint32_t error() const override {
+            return last_error;
+        }
+
+        void examined(const bool hidden) override {
+            examined_entries.emplace_back(name());
+            hidden_entries += hidden;
+        }
+
+        std::vector<std::u16string> entries;
+        std::optional<size_t> failing_entry;
+        size_t position = 0;
+        uint32_t last_error = 0;
+        size_t next_calls = 0;
+        std::vector<std::u16string> examined_entries;
+        size_t hidden_entries = 0;
+    };
+
+    struct Listing {
+        std::vector<std::u16string> names;
+        // Last error after the final call, as set by the hooks
+        uint32_t error = 0;
+    };
+
+    /**
+     * Lists the directory like a caller of the hooked `FindFirstFileW` and `FindNextFileW`.
+     * Every hook call runs its own enumeration on the same handle.
+     */
+    Listing list(SimulatedDirectory& directory, const hide_matcher::Matcher& matcher) {
+        Listing listing;
+
+        find_filter::Enumeration first(directory, matcher);
+        if(first.first() != State::FOUND) {
+            listing.error = first.last_error();
+            return listing;
+        }
+
+        while(true) {
+            listing.names.emplace_back(directory.name());
+
+            find_filter::Enumeration next(directory, matcher);
+            if(next.next() != State::FOUND) {
+                listing.error = next.last_error();
+                return listing;
+            }
+        }
+    }
+
+    const hide_matcher::Matcher& get_matcher() {
+        static const hide_matcher::Matcher matcher({"SmokeAPI", R"(\.log$)"});
+        return matcher;
+    }
+
+    void test_nothing_hidden() {
+        SimulatedDirectory directory({u".", u"..", u"Game.exe", u"data"});
+
+        const auto listing = list(directory, get_matcher());
+
+        CHECK((listing.names == std::vector<std::u16string>{u".", u"..", u"Game.exe", u"data"}));
+        CHECK(listing.error == NO_MORE_FILES);
+        CHECK(directory.next_calls == 4);
+        CHECK(directory.hidden_entries == 0);
+    }
+
+    void test_hidden_first_entries() {
+        SimulatedDirectory directory({u"SmokeAPI64.dll", u"SmokeAPI.log", u"Game.exe", u"data"});
+        const auto& matcher = get_matcher();
+
+        find_filter::Enumeration first(directory, matcher);
+        CHECK(first.first() == State::FOUND);
+        CHECK(first.hidden() == 2);
+        CHECK(directory.name() == u"Game.exe");
+        CHECK(directory.next_calls == 2);
+
+        // The directory is never opened again, so every entry is read exactly once
+        SimulatedDirectory fresh({u"SmokeAPI64.dll", u"SmokeAPI.log", u"Game.exe", u"data"});
+        const auto listing = list(fresh, matcher);
+        CHECK((listing.names == std::vector<std::u16string>{u"Game.exe", u"data"}));
+        CHECK(listing.error == NO_MORE_FILES);
+        CHECK(fresh.examined_entries == fresh.entries);
+        CHECK(fresh.next_calls == 4);
+    }
+
+    void test_hidden_in_between_and_at_end() {
+        SimulatedDirectory directory({u"Game.exe", u"SmokeAPI64.dll", u"data", u"crash.log", u"SmokeAPI.json"});
+
+        const auto listing = list(directory, get_matcher());
+
+        CHECK((listing.names == std::vector<std::u16string>{u"Game.exe", u"data"}));
+        // Hidden entries at the end look like the end of the directory
+        CHECK(listing.error == NO_MORE_FILES);
+        CHECK(directory.examined_entries == directory.entries);
+        CHECK(directory.hidden_entries == 3);
+    }
+
+    void test_everything_hidden() {
+        SimulatedDirectory directory({u"SmokeAPI32.dll", u"SmokeAPI64.dll", u"SmokeAPI.log"});
+
+        find_filter::Enumeration enumeration(directory, get_matcher());
+        CHECK(enumeration.first() == State::END);
+        CHECK(enumeration.hidden() == 3);
+        CHECK(enumeration.last_error() == FILE_NOT_FOUND);
+        CHECK(directory.next_calls == 3);
+
+        // The end is final, without touching the handle again
+        CHECK(enumeration.next() == State::END);
+        CHECK(directory.next_calls == 3);
+
+        // The query has no visible matches, so `FindFirstFileW` reports that nothing was found
+        SimulatedDirectory fresh({u"SmokeAPI32.dll", u"SmokeAPI64.dll", u"SmokeAPI.log"});
+        const auto listing = list(fresh, get_matcher());
+        CHECK(listing.names.empty());
+        CHECK(listing.error == FILE_NOT_FOUND);
+    }
+
+    void test_failure() {
+        // Reading the entry after the hidden one fails
+        SimulatedDirectory directory({u"Game.exe", u"SmokeAPI64.dll", u"data"}, 2);
+
+        const auto listing = list(directory, get_matcher());
+
+        CHECK((listing.names == std::vector<std::u16string>{u"Game.exe"}));
+        // The error of the original function is passed on, rather than replaced by the end of the directory
+        CHECK(listing.error == IO_DEVICE);
+        CHECK(directory.next_calls == 2);
+
+        find_filter::Enumeration enumeration(directory, get_matcher());
+        directory.position = 1;
+        CHECK(enumeration.next() == State::FAILED);
+        CHECK(enumeration.next() == State::FAILED);
+        CHECK(directory.next_calls == 3);
+        CHECK(enumeration.last_error() == IO_DEVICE);
+    }
+
+    void test_empty_matcher() {
+        SimulatedDirectory directory({u"SmokeAPI64.dll", u"Game.exe"});
+
+        const auto listing = list(directory, hide_matcher::Matcher());
+
+        CHECK(listing.names.size() == 2);
+        CHECK(directory.hidden_entries == 0);
+    }
+
+    void test_large_directory() {
+        std::vector<std::u16string> entries;
+        for(auto i = 0; i < 10'000; ++i) {
+            const auto number = std::to_string(i);
+            entries.push_back((i % 2 ? u"SmokeAPI_" : u"asset_") + std::u16string(number.begin(), number.end()));
+        }
+
+        SimulatedDirectory directory(entries);
+        const auto listing = list(directory, get_matcher());
+
+        CHECK(listing.names.size() == 5'000);
+        CHECK(listing.error == NO_MORE_FILES);
+        CHECK(directory.next_calls == entries.size());
+        CHECK(directory.examined_entries.size() == entries.size());
+    }
+}
+
+int main() {
+    test_nothing_hidden();
+    test_hidden_first_entries();
+    test_hidden_in_between_and_at_end();
+    test_everything_hidden();
+    test_failure();
+    test_empty_matcher();
+    test_large_directory();
+
+    return test_utils::exit_code();
+}
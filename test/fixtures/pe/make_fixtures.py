@@ -0,0 +1,139 @@
+"""
+Generates the minimal PE fixtures used by pe_exports_test.
+
+The images contain nothing but headers, a stub .text section and an .edata section,
+so that the export directory can only be found by translating RVAs through the section table.
+
+Usage: python make_fixtures.py
+"""
+
+import struct
+from pathlib import Path
+
+FILE_ALIGNMENT = 0x200
+SECTION_ALIGNMENT = 0x1000
+TEXT_RVA = 0x1000
+EDATA_RVA = 0x2000
+
+
+def align(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+
+def build_edata(dll_name, base, functions):
+    """
+    :param functions: list of (names, target), where target is an RVA, a forwarder string, or 0 for a gap
+    """
+    named = sorted((name, index) for index, (names, _) in enumerate(functions) for name in names)
+
+    header_size = 40
+    functions_offset = header_size
+    names_offset = functions_offset + 4 * len(functions)
+    ordinals_offset = names_offset + 4 * len(named)
+    strings_offset = ordinals_offset + 2 * len(named)
+
+    strings = bytearray()
+
+    def add_string(value):
+        offset = strings_offset + len(strings)
+        strings.extend(value.encode() + b"\0")
+        return EDATA_RVA + offset
+
+    dll_name_rva = add_string(dll_name)
+    name_rvas = [add_string(name) for name, _ in named]
+
+    function_rvas = []
+    for _, target in functions:
+        function_rvas.append(add_string(target) if isinstance(target, str) else target)
+
+    data = bytearray(struct.pack(
+        "<IIHHIIIIIII",
+        0, 0, 0, 0, dll_name_rva, base, len(functions), len(named),
+        EDATA_RVA + functions_offset, EDATA_RVA + names_offset, EDATA_RVA + ordinals_offset,
+    ))
+    data += struct.pack(f"<{len(function_rvas)}I", *function_rvas)
+    data += struct.pack(f"<{len(name_rvas)}I", *name_rvas)
+    data += struct.pack(f"<{len(named)}H", *(index for _, index in named))
+    data += strings
+
+    return bytes(data)
+
+
+def section_header(name, virtual_size, rva, raw_size, raw_offset, characteristics):
+    return struct.pack("<8sIIIIIIHHI", name, virtual_size, rva, raw_size, raw_offset, 0, 0, 0, 0, characteristics)
+
+
+def build_image(pe32_plus, edata):
+    text = b"\xC3" * 0x40
+    sections = [(b".text", text, TEXT_RVA, 0x60000020)]
+    if edata:
+        sections.append((b".edata", edata, EDATA_RVA, 0x40000040))
+
+    optional_header_size = (112 if pe32_plus else 96) + 16 * 8
+    headers_size = align(0x40 + 4 + 20 + optional_header_size + 40 * len(sections), FILE_ALIGNMENT)
+
+    raw_offset = headers_size
+    section_headers = b""
+    section_data = b""
+    for name, content, rva, characteristics in sections:
+        raw_size = align(len(content), FILE_ALIGNMENT)
+        section_headers += section_header(name, len(content), rva, raw_size, raw_offset, characteristics)
+        section_data += content.ljust(raw_size, b"\0")
+        raw_offset += raw_size
+
+    size_of_image = align(sections[-1][2] + len(sections[-1][1]), SECTION_ALIGNMENT)
+
+    dos_header = b"MZ".ljust(0x3C, b"\0") + struct.pack("<I", 0x40)
+
+    machine = 0x8664 if pe32_plus else 0x14C
+    characteristics = 0x2022 if pe32_plus else 0x2102
+    file_header = struct.pack("<HHIIIHH", machine, len(sections), 0, 0, 0, optional_header_size, characteristics)
+
+    if pe32_plus:
+        optional_header = struct.pack(
+            "<HBBIIIIIQIIHHHHHHIIIIHHQQQQII",
+            0x20B, 14, 0, 0x200, 0x200, 0, 0, TEXT_RVA, 0x180000000, SECTION_ALIGNMENT, FILE_ALIGNMENT,
+            6, 0, 0, 0, 6, 0, 0, size_of_image, headers_size, 0, 2, 0x160,
+            0x100000, 0x1000, 0x100000, 0x1000, 0, 16,
+        )
+    else:
+        optional_header = struct.pack(
+            "<HBBIIIIIIIIIHHHHHHIIIIHHIIIIII",
+            0x10B, 14, 0, 0x200, 0x200, 0, 0, TEXT_RVA, EDATA_RVA, 0x10000000, SECTION_ALIGNMENT, FILE_ALIGNMENT,
+            6, 0, 0, 0, 6, 0, 0, size_of_image, headers_size, 0, 2, 0x140,
+            0x100000, 0x1000, 0x100000, 0x1000, 0, 16,
+        )
+
+    data_directories = bytearray(16 * 8)
+    if edata:
+        struct.pack_into("<II", data_directories, 0, EDATA_RVA, len(edata))
+
+    headers = dos_header + b"PE\0\0" + file_header + optional_header + data_directories + section_headers
+    return headers.ljust(headers_size, b"\0") + section_data
+
+
+def main():
+    directory = Path(__file__).parent
+
+    exports64 = build_edata("exports64.dll", 1, [
+        (["Alpha"], TEXT_RVA),
+        (["Shared", "SharedAlias"], TEXT_RVA + 0x10),
+        (["Forwarded"], "KERNEL32.Sleep"),
+        ([], 0),
+        ([], TEXT_RVA + 0x20),
+    ])
+    (directory / "exports64.dll").write_bytes(build_image(True, exports64))
+
+    exports32 = build_edata("exports32.dll", 10, [
+        (["Beta"], TEXT_RVA),
+        (["Shared"], TEXT_RVA + 0x4),
+        ([], TEXT_RVA + 0x8),
+        (["HeapAllocForward"], "NTDLL.RtlAllocateHeap"),
+    ])
+    (directory / "exports32.dll").write_bytes(build_image(False, exports32))
+
+    (directory / "no_exports.dll").write_bytes(build_image(True, None))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,138 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "handle_table/handle_table.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    void test_basic_operations() {
+        handle_table::HandleTable table(16);
+
+        CHECK(table.capacity() == 16);
+        CHECK(table.insert(0x1004));
+        CHECK(table.insert(0x2008));
+        CHECK(table.contains(0x1004));
+        CHECK(table.contains(0x2008));
+        CHECK(not table.contains(0x300C));
+        CHECK(table.size() == 2);
+
+        CHECK(table.erase(0x1004));
+        CHECK(not table.erase(0x1004));
+        CHECK(not table.contains(0x1004));
+        CHECK(table.contains(0x2008));
+        CHECK(table.size() == 1);
+
+        // Reserved values are never stored
+        CHECK(not table.insert(0));
+        CHECK(not table.insert(UINTPTR_MAX));
+    }
+
+    void test_capacity_is_bounded() {
+        handle_table::HandleTable table(8);
+
+        for(uintptr_t i = 1; i <= 8; ++i) {
+            CHECK(table.insert(i * 4));
+        }
+        CHECK(not table.insert(9 * 4));
+
+        // Tombstones are reused
+        CHECK(table.erase(3 * 4));
+        CHECK(table.insert(9 * 4));
+        CHECK(table.contains(9 * 4));
+        CHECK(not table.contains(3 * 4));
+    }
+
+    void test_handle_set_overflow() {
+        handle_table::HandleSet handles(8);
+
+        for(uintptr_t i = 1; i <= 8; ++i) {
+            CHECK(handles.insert(i * 4));
+        }
+
+        // Handles beyond the capacity of the table are still tracked
+        CHECK(not handles.insert(9 * 4));
+        CHECK(not handles.insert(10 * 4));
+        CHECK(handles.overflow_size() == 2);
+        for(uintptr_t i = 1; i <= 10; ++i) {
+            CHECK(handles.contains(i * 4));
+        }
+        CHECK(not handles.contains(11 * 4));
+
+        CHECK(handles.erase(9 * 4));
+        CHECK(not handles.erase(9 * 4));
+        CHECK(not handles.contains(9 * 4));
+        CHECK(handles.overflow_size() == 1);
+
+        // Freed slots of the table are used again
+        CHECK(handles.erase(1 * 4));
+        CHECK(handles.insert(11 * 4));
+        CHECK(handles.contains(11 * 4));
+        CHECK(handles.contains(10 * 4));
+
+        CHECK(handles.erase(10 * 4));
+        CHECK(handles.overflow_size() == 0);
+    }
+
+    /**
+     * Emulates worker threads that open, enumerate and close find handles concurrently.
+     * Each thread owns a disjoint range of handle values, like the OS guarantees for live handles.
+     */
+    void test_concurrent_stress() {
+        constexpr size_t thread_count = 16;
+        constexpr size_t handles_per_thread = 32;
+        constexpr size_t rounds = 2'000;
+
+        handle_table::HandleTable table(1024);
+        std::atomic<size_t> errors = 0;
+        std::vector<std::thread> threads;
+
+        for(size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t] {
+                for(size_t round = 0; round < rounds; ++round) {
+                    const auto base = (t * handles_per_thread + 1) * 4;
+
+                    for(size_t h = 0; h < handles_per_thread; ++h) {
+                        if(not table.insert(base + h * 4 * thread_count * handles_per_thread)) {
+                            ++errors;
+                        }
+                    }
+
+                    for(size_t h = 0; h < handles_per_thread; ++h) {
+                        // Several FindNextFileW calls per handle
+                        for(int call = 0; call < 4; ++call) {
+                            if(not table.contains(base + h * 4 * thread_count * handles_per_thread)) {
+                                ++errors;
+                            }
+                        }
+                    }
+
+                    for(size_t h = 0; h < handles_per_thread; ++h) {
+                        if(not table.erase(base + h * 4 * thread_count * handles_per_thread)) {
+                            ++errors;
+                        }
+                        if(table.contains(base + h * 4 * thread_count * handles_per_thread)) {
+                            ++errors;
+                        }
+                    }
+                }
+            });
+        }
+
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        CHECK(errors == 0);
+        CHECK(table.size() == 0);
+    }
+}
+
+int main() {
+    test_basic_operations();
+    test_capacity_is_bounded();
+    test_handle_set_overflow();
+    test_concurrent_stress();
+
+    return test_utils::exit_code();
+}
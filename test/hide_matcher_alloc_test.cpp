@@ -0,0 +1,91 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <string>
+
+#include "hide_matcher/hide_matcher.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    std::atomic<size_t> allocations = 0;
+}
+
+void* operator new(const size_t size) {
+    ++allocations;
+    if(auto* const ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+    /**
+     * Counts heap allocations performed while matching,
+     * mirroring what the file API detours do on every call.
+     */
+    template<typename Function>
+    size_t count_allocations(const Function& function) {
+        const auto before = allocations.load();
+        function();
+        return allocations.load() - before;
+    }
+
+    void test_hook_paths_do_not_allocate() {
+        const hide_matcher::Matcher matcher({
+            "version\\.dll$",
+            "SmokeAPI(32|64)?\\.dll",
+            "\\\\DLC\\\\[0-9]+\\\\",
+            "\xC3\xA9t\xC3\xA9",
+        });
+
+        const wchar_t* const create_file_path = LR"(C:\Games\Title\Data\textures\terrain_0042.dds)";
+        const wchar_t find_data_file_name[260] = L"audio_bank_07.bnk";
+        const char* const ansi_path = R"(C:\Games\Title\Data\config.ini)";
+        const char16_t* const utf16_path = uR"(C:\Games\Title\Data\shaders\4f2e7a.bin)";
+
+        bool hidden = false;
+        const auto count = count_allocations([&] {
+            for(int i = 0; i < 1'000; ++i) {
+                hidden = hidden || matcher.matches(std::wstring_view(create_file_path));
+                hidden = hidden || matcher.matches(std::wstring_view(find_data_file_name));
+                hidden = hidden || matcher.matches(std::string_view(ansi_path));
+                hidden = hidden || matcher.matches(std::u16string_view(utf16_path));
+            }
+        });
+
+        CHECK(not hidden);
+        CHECK(count == 0);
+
+        // Hidden case is allocation free as well
+        const auto hidden_count = count_allocations([&] {
+            hidden = matcher.matches(std::wstring_view(LR"(C:\Games\Title\VERSION.DLL)"));
+        });
+        CHECK(hidden);
+        CHECK(hidden_count == 0);
+    }
+
+    void test_wide_input_matches_utf8_input() {
+        const hide_matcher::Matcher matcher({"\xC3\xA9t\xC3\xA9", "\xF0\x9F\x90\xA8\\.png$"});
+
+        CHECK(matcher.matches(std::wstring_view(L"\u00c9T\u00e9.txt")) == matcher.matches("\xC3\x89T\xC3\xA9.txt"));
+        CHECK(matcher.matches(std::wstring_view(L"\u00e9t\u00e9.txt")));
+        CHECK(matcher.matches(std::wstring_view(L"koala_\U0001F428.png")));
+        CHECK(not matcher.matches(std::wstring_view(L"koala_\U0001F428.png.bak")));
+    }
+}
+
+int main() {
+    test_hook_paths_do_not_allocate();
+    test_wide_input_matches_utf8_input();
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,229 @@
+#include <regex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hide_matcher/hide_matcher.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    bool regex_matches(const std::string& pattern, const std::string& file_name) {
+        return std::regex_search(file_name, std::regex(pattern, std::regex_constants::icase));
+    }
+
+    /**
+     * Every pattern is checked individually and as part of a combined set
+     * against the reference `std::regex_search` implementation.
+     */
+    void test_against_std_regex() {
+        const std::set<std::string> patterns{
+            "version.dll",
+            R"(^C:\\Games\\.*\.exe$)",
+            "SmokeAPI(32|64)?\\.dll$",
+            "[a-c]+_[^0-9]{2,3}x",
+            "\\d{3}\\.pak",
+            "(?:foo|bar)+baz",
+            "^koa",
+            "loader$",
+            "\\w+\\s\\w+",
+            "[\\W]secret",
+            "a.c",
+            "x?y*z+",
+            "cream\\u0041pi",
+            "\\x41\\x42",
+            "(a|)b",
+        };
+
+        const std::vector<std::string> inputs{
+            "",
+            "version.dll",
+            "C:\\Windows\\System32\\VERSION.DLL",
+            "version.dll.bak",
+            "C:\\Games\\Test\\game.EXE",
+            "D:\\C:\\Games\\game.exe",
+            "C:\\Games\\game.exe.old",
+            "smokeapi64.dll",
+            "SmokeAPI.dll",
+            "SmokeAPI128.dll",
+            "abc_xyx",
+            "ABC_XYZx",
+            "b_1x",
+            "cc_a-x",
+            "data_001.pak",
+            "data_01.pak",
+            "foobarfoobaz",
+            "barbaz",
+            "baz",
+            "Koaloader.dll",
+            "xkoa",
+            "koaloader",
+            "KoaLoader.log",
+            "hello world",
+            "hello-world",
+            "my.secret",
+            "mysecret",
+            "abc",
+            "a\nc",
+            "zzz",
+            "yyy",
+            "screamApi",
+            "AB",
+            "b",
+            "\xC3\xA9version.dll",
+            "\xFF\xFE",
+        };
+
+        for(const auto& pattern : patterns) {
+            const hide_matcher::Matcher matcher({pattern});
+
+            for(const auto& input : inputs) {
+                if(matcher.matches(input) != regex_matches(pattern, input)) {
+                    std::fprintf(stderr, "Mismatch: pattern '%s', input '%s'\n", pattern.c_str(), input.c_str());
+                }
+                CHECK(matcher.matches(input) == regex_matches(pattern, input));
+            }
+        }
+
+        const hide_matcher::Matcher matcher(patterns);
+        CHECK(matcher.fallback_count() == 0);
+
+        for(const auto& input : inputs) {
+            bool expected = false;
+            for(const auto& pattern : patterns) {
+                expected = expected || regex_matches(pattern, input);
+            }
+            CHECK(matcher.matches(input) == expected);
+        }
+    }
+
+    void test_utf16_input() {
+        const hide_matcher::Matcher matcher({"version\\.dll$", "\xC3\xA9t\xC3\xA9", "\xF0\x9F\x90\xA8"});
+
+        CHECK(matcher.matches(std::u16string_view(u"C:\\Windows\\VERSION.dll")));
+        CHECK(not matcher.matches(std::u16string_view(u"C:\\Windows\\version.dll.bak")));
+        CHECK(matcher.matches(std::u16string_view(u"\u00e9t\u00e9.txt")));
+        CHECK(matcher.matches(std::u16string_view(u"koala_\U0001F428.png")));
+        CHECK(not matcher.matches(std::u16string_view(u"koala.png")));
+    }
+
+    /**
+     * Patterns match UTF-16 code units, unlike `std::regex` over UTF-8 bytes
+     */
+    void test_non_ascii_units() {
+        // "ä" is a single code unit, but two UTF-8 bytes
+        const hide_matcher::Matcher four_units({"^.{4}$"});
+        CHECK(four_units.matches("\xC3\xA4.dl"));
+        CHECK(four_units.matches(std::u16string_view(u"\u00e4.dl")));
+        CHECK(not regex_matches("^.{4}$", "\xC3\xA4.dl"));
+
+        // A negated class consumes the whole "ä"
+        const hide_matcher::Matcher negated({"^[^a][.]dll$"});
+        CHECK(negated.matches("\xC3\xA4.dll"));
+        CHECK(negated.matches(std::u16string_view(u"\u00e4.dll")));
+        CHECK(not negated.matches("a.dll"));
+
+        // Characters outside the Basic Multilingual Plane are surrogate pairs of two code units
+        const hide_matcher::Matcher single({"^.$"});
+        CHECK(not single.matches("\xF0\x9F\x90\xA8"));
+        CHECK(not single.matches(std::u16string_view(u"\U0001F428")));
+        CHECK(hide_matcher::Matcher({"^..$"}).matches("\xF0\x9F\x90\xA8"));
+
+        // Bytes that are not valid UTF-8, such as "ä" in Windows-1252 from the `A` APIs, are taken as Latin-1
+        const hide_matcher::Matcher umlaut({"^\xC3\xA4[.]dll$"});
+        CHECK(umlaut.matches("\xE4.dll"));
+        CHECK(umlaut.matches("\xC3\xA4.dll"));
+        CHECK(not regex_matches("^\xC3\xA4[.]dll$", "\xE4.dll"));
+
+        // Case folding only applies to ASCII letters
+        CHECK(not umlaut.matches(std::u16string_view(u"\u00c4.dll")));
+        CHECK(umlaut.matches(std::u16string_view(u"\u00e4.DLL")));
+    }
+
+    void test_fallback_patterns() {
+        const hide_matcher::Matcher matcher({"(a)\\1", "\\bdll\\b", "foo(?=bar)"});
+
+        CHECK(matcher.fallback_count() == 3);
+        CHECK(matcher.matches("xaax"));
+        CHECK(matcher.matches("some dll here"));
+        CHECK(matcher.matches(std::u16string_view(u"foobar")));
+        CHECK(not matcher.matches("foobaz"));
+    }
+
+    void test_invalid_patterns() {
+        try {
+            const hide_matcher::Matcher matcher({"valid", "(unclosed", "[z-a]"});
+            CHECK(false);
+        } catch(const std::invalid_argument& e) {
+            const std::string message = e.what();
+            CHECK(message.find("(unclosed") != std::string::npos);
+            CHECK(message.find("[z-a]") != std::string::npos);
+            CHECK(message.find("valid\"") == std::string::npos);
+        }
+    }
+
+    void test_empty() {
+        const hide_matcher::Matcher matcher;
+        CHECK(matcher.empty());
+        CHECK(not matcher.matches("anything"));
+
+        const hide_matcher::Matcher empty_pattern({""});
+        CHECK(empty_pattern.matches("anything"));
+    }
+
+    void test_large_pattern_set() {
+        std::set<std::string> patterns;
+        for(int i = 0; i < 200; ++i) {
+            patterns.insert("module_" + std::to_string(i) + "_[a-z]+\\.dll");
+        }
+
+        const hide_matcher::Matcher matcher(patterns);
+        CHECK(matcher.matches("C:\\game\\module_42_abc.dll"));
+        CHECK(matcher.matches("MODULE_199_X.DLL"));
+        CHECK(not matcher.matches("module_200_x.dll"));
+        CHECK(not matcher.matches("module_42_.dll"));
+    }
+
+    void test_save_and_load() {
+        const hide_matcher::Matcher original({"version\\.dll$", "\xC3\xA9t\xC3\xA9", "(a)\\1", "^koa"});
+
+        config_snapshot::Writer writer;
+        original.save(writer);
+
+        config_snapshot::Reader reader(writer.data());
+        const auto loaded = hide_matcher::Matcher::load(reader);
+        CHECK(reader.remaining() == 0);
+
+        CHECK(loaded.pattern_count() == original.pattern_count());
+        CHECK(loaded.fallback_count() == 1);
+        CHECK(loaded.dfa_state_count() == original.dfa_state_count());
+
+        for(const auto* file_name : {"C:\\Windows\\VERSION.dll", "version.dll.bak", "\xC3\x89T\xC3\xA9", "xaax", "koaloader", "loader"}) {
+            CHECK(loaded.matches(file_name) == original.matches(file_name));
+        }
+        CHECK(loaded.matches(std::u16string_view(u"\u00e9t\u00e9.txt")));
+
+        // Truncated data is rejected instead of producing a broken automaton
+        const auto& data = writer.data();
+        for(const auto size : {size_t{0}, size_t{8}, data.size() / 2, data.size() - 1}) {
+            config_snapshot::Reader truncated(std::string_view(data).substr(0, size));
+            try {
+                (void) hide_matcher::Matcher::load(truncated);
+                CHECK(false);
+            } catch(const std::runtime_error&) {}
+        }
+    }
+}
+
+int main() {
+    test_against_std_regex();
+    test_utf16_input();
+    test_non_ascii_units();
+    test_fallback_patterns();
+    test_invalid_patterns();
+    test_empty();
+    test_large_pattern_set();
+    test_save_and_load();
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,204 @@
+#include <string>
+#include <vector>
+
+#include "hook_replay/hook_replay.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    using hook_trace::Api;
+    using hook_trace::Record;
+
+    constexpr uint64_t FIND_HANDLE = 0x1A4;
+    constexpr uint64_t PLUGINS_HANDLE = 0x1B0;
+
+    // Hook calls of the session, since the hidden entry was skipped within a call of `FindNextFileW`
+    constexpr size_t SESSION_CALLS = 8;
+
+    /**
+     * Session of a game that lists its directory and probes a few files,
+     * recorded with `hide_files` set to `SmokeAPI`
+     */
+    std::vector<Record> make_session() {
+        return {
+            {.api = Api::FindFirstFileExW, .result = FIND_HANDLE, .path = "C:/Game/*", .file_name = "Game.exe"},
+            {.api = Api::FindNextFileW, .hidden = true, .handle = FIND_HANDLE, .result = 1, .file_name = "SmokeAPI64.dll"},
+            {.api = Api::FindNextFileW, .handle = FIND_HANDLE, .result = 1, .file_name = "config.json"},
+            {.api = Api::FindNextFileW, .handle = FIND_HANDLE, .result = 0},
+            {.api = Api::FindClose, .handle = FIND_HANDLE, .result = 1},
+            {.api = Api::GetFileAttributesW, .hidden = true, .result = -1, .path = "C:/Game/SmokeAPI64.dll"},
+            {.api = Api::GetFileAttributesA, .result = 0x20, .path = "C:/Game/Game.exe"},
+            {.api = Api::CreateFileW, .result = 0x300, .path = "C:/Game/config.json"},
+            {.api = Api::FindFirstFileW, .result = hook_replay::INVALID_HANDLE, .path = "C:/Game/Saves/*"},
+        };
+    }
+
+    /**
+     * Enumeration of a directory whose entries were all hidden, so that `FindFirstFileW`
+     * closed its handle and reported that nothing was found
+     */
+    std::vector<Record> make_hidden_directory_session() {
+        return {
+            {.api = Api::FindFirstFileW, .hidden = true, .result = PLUGINS_HANDLE, .path = "C:/Game/Plugins/*", .file_name = "SmokeAPI32.dll"},
+            {.api = Api::FindNextFileW, .hidden = true, .handle = PLUGINS_HANDLE, .result = 1, .file_name = "SmokeAPI64.dll"},
+            {.api = Api::FindNextFileW, .handle = PLUGINS_HANDLE, .result = 0},
+            {.api = Api::FindClose, .handle = PLUGINS_HANDLE, .result = 1},
+        };
+    }
+
+    /**
+     * Counts calls that reach the file system
+     */
+    class CountingFileSystem final : public hook_replay::FileSystem {
+    public:
+        explicit CountingFileSystem(hook_replay::FileSystem& file_system) : file_system(file_system) {}
+
+        int64_t find_first_file(const std::u16string_view query, std::u16string& file_name) override {
+            calls++;
+            return file_system.find_first_file(query, file_name);
+        }
+
+        bool find_next_file(const int64_t handle, std::u16string& file_name) override {
+            calls++;
+            return file_system.find_next_file(handle, file_name);
+        }
+
+        bool find_close(const int64_t handle) override {
+            calls++;
+            return file_system.find_close(handle);
+        }
+
+        uint32_t get_file_attributes(const std::u16string_view path) override {
+            calls++;
+            queried_paths.emplace_back(path);
+            return file_system.get_file_attributes(path);
+        }
+
+        int64_t create_file(const std::u16string_view path) override {
+            calls++;
+            queried_paths.emplace_back(path);
+            return file_system.create_file(path);
+        }
+
+        hook_replay::FileSystem& file_system;
+        size_t calls = 0;
+        std::vector<std::u16string> queried_paths;
+    };
+
+    void test_trace_file_system() {
+        const auto session = make_session();
+        hook_replay::TraceFileSystem file_system(session);
+
+        CHECK(file_system.directory_count() == 1);
+
+        std::u16string file_name;
+        const auto handle = file_system.find_first_file(u"C:/Game/*", file_name);
+        CHECK(handle != hook_replay::INVALID_HANDLE);
+        CHECK(file_name == u"Game.exe");
+
+        // Hidden entries are part of the listing
+        CHECK(file_system.find_next_file(handle, file_name) && file_name == u"SmokeAPI64.dll");
+        CHECK(file_system.find_next_file(handle, file_name) && file_name == u"config.json");
+        CHECK(not file_system.find_next_file(handle, file_name));
+        CHECK(file_system.find_close(handle));
+        CHECK(not file_system.find_close(handle));
+
+        CHECK(file_system.find_first_file(u"C:/Game/Saves/*", file_name) == hook_replay::INVALID_HANDLE);
+
+        CHECK(file_system.get_file_attributes(u"C:/Game/Game.exe") == 0x20);
+        // Hidden paths never reached the file system when recorded
+        CHECK(file_system.get_file_attributes(u"C:/Game/SmokeAPI64.dll") == hook_replay::INVALID_FILE_ATTRIBUTES);
+        CHECK(file_system.create_file(u"C:/Game/config.json") == 0x300);
+        CHECK(file_system.create_file(u"C:/Game/missing.txt") == hook_replay::INVALID_HANDLE);
+    }
+
+    void test_recorded_config() {
+        const auto session = make_session();
+        hook_replay::TraceFileSystem trace_file_system(session);
+        CountingFileSystem file_system(trace_file_system);
+
+        const hide_matcher::Matcher matcher({"SmokeAPI"});
+        const auto report = hook_replay::replay(session, matcher, file_system);
+
+        CHECK(report.calls == SESSION_CALLS);
+        CHECK(report.hidden == 2);
+        CHECK(report.newly_hidden == 0);
+        CHECK(report.newly_visible == 0);
+        CHECK(report.calls_per_second() > 0);
+
+        // One line per API that was called
+        CHECK(report.hook_lines.size() == 7);
+
+        // Except for the hidden path, every call reached the file system
+        CHECK(file_system.calls == session.size() - 1);
+        CHECK((file_system.queried_paths == std::vector<std::u16string>{u"C:/Game/Game.exe", u"C:/Game/config.json"}));
+    }
+
+    void test_other_configs() {
+        const auto session = make_session();
+        hook_replay::TraceFileSystem file_system(session);
+
+        const auto report = hook_replay::replay(session, hide_matcher::Matcher({R"(config\.json$)"}), file_system);
+        // The enumerated entry and the opened file
+        CHECK(report.hidden == 2);
+        CHECK(report.newly_hidden == 2);
+        CHECK(report.newly_visible == 2);
+
+        CHECK(report.calls == SESSION_CALLS);
+
+        // The visible entry takes an extra call to reach the end of the directory
+        const auto unhidden = hook_replay::replay(session, hide_matcher::Matcher(), file_system);
+        CHECK(unhidden.hidden == 0);
+        CHECK(unhidden.newly_visible == 2);
+        CHECK(unhidden.calls == SESSION_CALLS + 1);
+
+        // The caller sees the end one call earlier and stops enumerating
+        const auto hidden = hook_replay::replay(session, hide_matcher::Matcher({"SmokeAPI", "config"}), file_system);
+        CHECK(hidden.hidden == 4);
+        CHECK(hidden.calls == SESSION_CALLS - 1);
+    }
+
+    void test_hidden_directory() {
+        const auto session = make_hidden_directory_session();
+        hook_replay::TraceFileSystem trace_file_system(session);
+        CountingFileSystem file_system(trace_file_system);
+
+        // The internal close belongs to the call of `FindFirstFileW`
+        const auto report = hook_replay::replay(session, hide_matcher::Matcher({"SmokeAPI"}), file_system);
+        CHECK(report.calls == 1);
+        CHECK(report.hidden == 2);
+        CHECK(report.newly_hidden == 0);
+        CHECK(file_system.calls == session.size());
+
+        // Visible entries are listed to the end and the handle is closed
+        const auto unhidden = hook_replay::replay(session, hide_matcher::Matcher(), trace_file_system);
+        CHECK(unhidden.calls == 4);
+        CHECK(unhidden.newly_visible == 2);
+
+        const auto partly_hidden = hook_replay::replay(session, hide_matcher::Matcher({"SmokeAPI64"}), trace_file_system);
+        CHECK(partly_hidden.calls == 3);
+        CHECK(partly_hidden.hidden == 1);
+        CHECK(partly_hidden.newly_visible == 1);
+    }
+
+    void test_iterations() {
+        const auto session = make_session();
+        hook_replay::TraceFileSystem file_system(session);
+
+        const auto report = hook_replay::replay(session, hide_matcher::Matcher({"SmokeAPI"}), file_system, 3);
+
+        CHECK(report.calls == SESSION_CALLS * 3);
+        // Decisions are those of the last iteration, which match those of the first one
+        CHECK(report.hidden == 2);
+        CHECK(report.newly_hidden == 0);
+    }
+}
+
+int main() {
+    test_trace_file_system();
+    test_recorded_config();
+    test_other_configs();
+    test_hidden_directory();
+    test_iterations();
+
+    return test_utils::exit_code();
+}
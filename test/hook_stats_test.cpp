@@ -0,0 +1,140 @@
+#include <thread>
+#include <vector>
+
+#include "hook_stats/hook_stats.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    using namespace std::chrono_literals;
+    using hook_stats::Histogram;
+
+    void test_buckets() {
+        CHECK(Histogram::bucket_of(0) == 0);
+        CHECK(Histogram::bucket_of(1) == 0);
+        CHECK(Histogram::bucket_of(2) == 1);
+        CHECK(Histogram::bucket_of(3) == 1);
+        CHECK(Histogram::bucket_of(4) == 2);
+        CHECK(Histogram::bucket_of(1023) == 9);
+        CHECK(Histogram::bucket_of(1024) == 10);
+        CHECK(Histogram::bucket_of(UINT64_MAX) == Histogram::BUCKET_COUNT - 1);
+    }
+
+    void test_percentiles() {
+        Histogram histogram;
+        CHECK(Histogram::percentile(histogram.snapshot(), 0.5) == 0);
+
+        for(int i = 0; i < 90; ++i) {
+            histogram.record(100ns);
+        }
+        for(int i = 0; i < 10; ++i) {
+            histogram.record(100us);
+        }
+
+        const auto buckets = histogram.snapshot();
+        CHECK(buckets[Histogram::bucket_of(100)] == 90);
+        CHECK(buckets[Histogram::bucket_of(100'000)] == 10);
+
+        // Percentiles are reported as the upper bound of their bucket
+        CHECK(Histogram::percentile(buckets, 0.5) == 128);
+        CHECK(Histogram::percentile(buckets, 0.9) == 128);
+        CHECK(Histogram::percentile(buckets, 0.91) == 131'072);
+        CHECK(Histogram::percentile(buckets, 1.0) == 131'072);
+        CHECK(Histogram::percentile(buckets, 0.0) == 128);
+    }
+
+    void test_concurrent_counts() {
+        hook_stats::HookStats stats("CreateFileW");
+
+        constexpr int thread_count = 8;
+        constexpr int calls_per_thread = 10'000;
+
+        std::vector<std::thread> threads;
+        for(int t = 0; t < thread_count; ++t) {
+            threads.emplace_back(
+                [&stats] {
+                    for(int i = 0; i < calls_per_thread; ++i) {
+                        stats.record(50ns, 1us, i % 4 == 0);
+                    }
+                }
+            );
+        }
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        CHECK(stats.calls() == thread_count * calls_per_thread);
+        CHECK(stats.hidden() == thread_count * calls_per_thread / 4);
+
+        const auto own = stats.own_time().snapshot();
+        const auto original = stats.original_time().snapshot();
+        CHECK(own[Histogram::bucket_of(50)] == thread_count * calls_per_thread);
+        CHECK(original[Histogram::bucket_of(1000)] == thread_count * calls_per_thread);
+
+        CHECK(alignof(hook_stats::HookStats) == 64);
+    }
+
+    void test_call_timer() {
+        hook_stats::HookStats stats("FindNextFileW");
+
+        {
+            hook_stats::CallTimer timer(stats, true);
+
+            // Two calls of the original function, as when a hook skips a hidden entry
+            CHECK(timer.call_original([] { std::this_thread::sleep_for(5ms); return 1; }) == 1);
+            timer.set_hidden(true);
+            CHECK(timer.call_original([] { std::this_thread::sleep_for(5ms); return 2; }) == 2);
+            timer.set_hidden(false);
+        }
+
+        CHECK(stats.calls() == 1);
+        CHECK(stats.hidden() == 1);
+
+        const auto original = stats.original_time().snapshot();
+        const auto own = stats.own_time().snapshot();
+        CHECK(Histogram::percentile(original, 1.0) >= 10'000'000);
+        CHECK(Histogram::percentile(own, 1.0) < Histogram::percentile(original, 1.0));
+
+        {
+            hook_stats::CallTimer timer(stats, false);
+            CHECK(timer.call_original([] { return 3; }) == 3);
+            timer.set_hidden(true);
+        }
+
+        // Disabled timers record nothing
+        CHECK(stats.calls() == 1);
+        CHECK(stats.hidden() == 1);
+    }
+
+    void test_report() {
+        hook_stats::Registry registry;
+
+        auto& create_file = registry.add("CreateFileW");
+        registry.add("FindClose");
+        auto& get_attributes = registry.add("GetFileAttributesW");
+
+        get_attributes.record(200ns, 3us, true);
+        create_file.record(100ns, 20us, false);
+        create_file.record(100ns, 20us, false);
+
+        const auto lines = registry.report();
+        CHECK(lines.size() == 2);
+        if(lines.size() != 2) {
+            return;
+        }
+
+        // Registration order, skipping hooks that were never called
+        CHECK(lines[0].starts_with("CreateFileW: 2 calls, 0 hidden | own: total 200 ns, p50 < 128 ns"));
+        CHECK(lines[0].find("| original: total 40 us, p50 < 32 us, p99 < 32 us") != std::string::npos);
+        CHECK(lines[1].starts_with("GetFileAttributesW: 1 calls, 1 hidden"));
+    }
+}
+
+int main() {
+    test_buckets();
+    test_percentiles();
+    test_concurrent_counts();
+    test_call_timer();
+    test_report();
+
+    return test_utils::exit_code();
+}
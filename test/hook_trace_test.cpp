@@ -0,0 +1,179 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hook_trace/hook_trace.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+    using hook_trace::Api;
+
+    template<typename Function>
+    bool throws_runtime_error(const Function& function) {
+        try {
+            function();
+            return false;
+        } catch(const std::runtime_error&) {
+            return true;
+        }
+    }
+
+    std::string read_file(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        return std::move(contents).str();
+    }
+
+    void test_utf_conversion() {
+        CHECK(hook_trace::to_utf8(u"C:/Games/Game.exe") == "C:/Games/Game.exe");
+        CHECK(hook_trace::to_utf8(u"Spiele/Über.dll") == "Spiele/\xC3\x9C" "ber.dll");
+        CHECK(hook_trace::to_utf8(u"\U0001F428.dll") == "\xF0\x9F\x90\xA8.dll");
+
+        // Unpaired surrogates survive a round trip
+        const std::u16string lone_surrogates{u'a', char16_t(0xD800), u'b', char16_t(0xDC00)};
+        CHECK(hook_trace::to_utf16(hook_trace::to_utf8(lone_surrogates)) == lone_surrogates);
+        CHECK(hook_trace::to_utf16(hook_trace::to_utf8(u"\U0001F428/Über")) == u"\U0001F428/Über");
+
+        // Invalid sequences are replaced
+        CHECK(hook_trace::to_utf16("a\xFF" "b") == u"a\uFFFDb");
+        CHECK(hook_trace::to_utf16("\xC3") == u"\uFFFD");
+        CHECK(hook_trace::to_utf16("\xC0\xAF") == u"\uFFFD\uFFFD");
+    }
+
+    void test_round_trip(const fs::path& directory) {
+        const auto path = directory / "round_trip.trace";
+
+        {
+            hook_trace::Recorder recorder(path);
+
+            recorder.record(Api::FindFirstFileW, false, 0, 0x1A4, u"C:/Game/*", u"Game.exe");
+            recorder.record(Api::FindNextFileW, true, 0x1A4, 1, u"", u"SmokeAPI64.dll");
+            recorder.record(Api::FindNextFileW, false, 0x1A4, 0, u"", u"");
+            recorder.record(Api::FindClose, false, 0x1A4, 1, u"");
+            recorder.record(Api::GetFileAttributesA, true, 0, 0xFFFFFFFF, "C:/Game/SmokeAPI64.dll");
+            recorder.record(Api::CreateFileW, false, 0, -1, u"C:/Spiele/\U0001F428.json");
+
+            CHECK(recorder.count() == 6);
+            recorder.flush();
+        }
+
+        const auto records = hook_trace::load(path);
+        CHECK(records.size() == 6);
+        if(records.size() != 6) {
+            return;
+        }
+
+        CHECK(records[0].api == Api::FindFirstFileW);
+        CHECK(records[0].result == 0x1A4);
+        CHECK(records[0].path == "C:/Game/*");
+        CHECK(records[0].file_name == "Game.exe");
+
+        CHECK(records[1].hidden);
+        CHECK(records[1].handle == 0x1A4);
+        CHECK(records[1].file_name == "SmokeAPI64.dll");
+
+        CHECK(records[3].api == Api::FindClose);
+        CHECK(records[4].api == Api::GetFileAttributesA);
+        CHECK(records[4].result == 0xFFFFFFFF);
+        CHECK(records[4].path == "C:/Game/SmokeAPI64.dll");
+
+        CHECK(records[5].result == -1);
+        CHECK(records[5].path == "C:/Spiele/\xF0\x9F\x90\xA8.json");
+
+        for(size_t i = 1; i < records.size(); ++i) {
+            CHECK(records[i - 1].timestamp_ns <= records[i].timestamp_ns);
+        }
+
+        // A few bytes per record beyond its paths
+        CHECK(fs::file_size(path) < 150);
+    }
+
+    void test_invalid_traces(const fs::path& directory) {
+        const auto path = directory / "invalid.trace";
+
+        {
+            hook_trace::Recorder recorder(path);
+            recorder.record(Api::GetFileAttributesW, false, 0, 0x20, u"C:/Game/Game.exe");
+        }
+
+        const auto data = read_file(path);
+        CHECK(hook_trace::parse(data).size() == 1);
+
+        CHECK(throws_runtime_error([&] { (void) hook_trace::parse(data.substr(0, data.size() - 1)); }));
+        CHECK(throws_runtime_error([&] { (void) hook_trace::parse("koaloader-config-snapshot"); }));
+        CHECK(throws_runtime_error([&] { (void) hook_trace::parse(""); }));
+        CHECK(throws_runtime_error([&] { (void) hook_trace::load(directory / "missing.trace"); }));
+
+        // Header followed by a record of an unknown API
+        const auto header_size = 1 + std::string_view("koaloader-hook-trace").size() + 1;
+        const auto corrupted = data.substr(0, header_size) + std::string("\x7F\0\0\0\0\0", 6);
+        CHECK(throws_runtime_error([&] { (void) hook_trace::parse(corrupted); }));
+    }
+
+    /**
+     * Records from several threads, enough to fill the buffer several times
+     */
+    void test_concurrent_recording(const fs::path& directory) {
+        const auto path = directory / "concurrent.trace";
+        constexpr auto THREAD_COUNT = 4;
+        constexpr auto RECORD_COUNT = 5000;
+
+        {
+            hook_trace::Recorder recorder(path);
+
+            std::vector<std::thread> threads;
+            for(auto t = 0; t < THREAD_COUNT; ++t) {
+                threads.emplace_back([&recorder, t] {
+                    const auto file_name = u"C:/Program Files (x86)/Steam/steamapps/common/Game/thread_" +
+                                           std::u16string(1, static_cast<char16_t>(u'0' + t)) + u".dat";
+                    for(auto i = 0; i < RECORD_COUNT; ++i) {
+                        recorder.record(Api::GetFileAttributesW, i % 2, 0, i, file_name);
+                    }
+                });
+            }
+
+            for(auto& thread : threads) {
+                thread.join();
+            }
+
+            CHECK(recorder.count() == THREAD_COUNT * RECORD_COUNT);
+        }
+
+        const auto records = hook_trace::load(path);
+        CHECK(records.size() == THREAD_COUNT * RECORD_COUNT);
+
+        std::vector<int64_t> next_result(THREAD_COUNT, 0);
+        for(size_t i = 0; i < records.size(); ++i) {
+            const auto thread = records[i].path[records[i].path.size() - 5] - '0';
+
+            // Records of each thread keep their order
+            CHECK(records[i].result == next_result[thread]++);
+            CHECK(records[i].hidden == (records[i].result % 2 == 1));
+
+            if(i > 0) {
+                CHECK(records[i - 1].timestamp_ns <= records[i].timestamp_ns);
+            }
+        }
+    }
+}
+
+int main() {
+    const auto directory = fs::temp_directory_path() / "koaloader_hook_trace_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    test_utf_conversion();
+    test_round_trip(directory);
+    test_invalid_traces(directory);
+    test_concurrent_recording(directory);
+
+    fs::remove_all(directory);
+
+    return test_utils::exit_code();
+}
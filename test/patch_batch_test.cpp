@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "patch_batch/patch_batch.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    /**
+     * Changes protection with `mprotect`, which cannot report the previous protection,
+     * so the protector keeps track of it for the memory it manages.
+     */
+    class MprotectProtector : public patch_batch::MemoryProtector {
+    public:
+        std::map<uintptr_t, int> page_protections;
+        size_t unprotect_calls = 0;
+        size_t restore_calls = 0;
+        uintptr_t failing_page = 0;
+
+        patch_batch::Protection unprotect(const patch_batch::Range& range) override {
+            ++unprotect_calls;
+
+            if(failing_page >= range.address && failing_page < range.address + range.size) {
+                throw std::runtime_error("Simulated protection failure");
+            }
+
+            const auto previous = page_protections.at(range.address);
+            if(mprotect(reinterpret_cast<void*>(range.address), range.size, PROT_READ | PROT_WRITE) != 0) {
+                throw std::runtime_error("mprotect failed");
+            }
+
+            return previous;
+        }
+
+        void restore(const patch_batch::Range& range, const patch_batch::Protection protection) override {
+            ++restore_calls;
+
+            if(mprotect(reinterpret_cast<void*>(range.address), range.size, static_cast<int>(protection)) != 0) {
+                throw std::runtime_error("mprotect failed");
+            }
+        }
+    };
+
+    /**
+     * @return Permissions of the mapping containing the address, such as `r--p`
+     */
+    std::string get_permissions(const uintptr_t address) {
+        std::ifstream maps("/proc/self/maps");
+        std::string line;
+        while(std::getline(maps, line)) {
+            std::istringstream stream(line);
+            uintptr_t begin = 0;
+            uintptr_t end = 0;
+            char dash = 0;
+            std::string permissions;
+            stream >> std::hex >> begin >> dash >> end >> permissions;
+
+            if(address >= begin && address < end) {
+                return permissions;
+            }
+        }
+        return {};
+    }
+
+    void test_ranges() {
+        patch_batch::Batch batch(0x1000);
+        batch.add(0x5000, "x");
+        batch.add(0x1010, "abc");
+        // Spans two pages
+        batch.add(0x1FFE, "abcd");
+        batch.add(0x1020, "same page");
+        // Adjacent to the page of the first write
+        batch.add(0x4FFF, "y");
+        batch.add(0x9000, "");
+
+        CHECK(batch.size() == 6);
+
+        const auto ranges = batch.ranges();
+        CHECK(ranges.size() == 2);
+        CHECK(ranges[0] == (patch_batch::Range{0x1000, 0x2000}));
+        CHECK(ranges[1] == (patch_batch::Range{0x4000, 0x2000}));
+    }
+
+    void test_apply_with_mprotect() {
+        const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        constexpr size_t PAGE_COUNT = 8;
+
+        auto* const memory = static_cast<char*>(
+            mmap(nullptr, page_size * PAGE_COUNT, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+        );
+        CHECK(memory != MAP_FAILED);
+        if(memory == MAP_FAILED) {
+            return;
+        }
+
+        std::memset(memory, '.', page_size * PAGE_COUNT);
+        CHECK(mprotect(memory, page_size * PAGE_COUNT, PROT_READ) == 0);
+
+        MprotectProtector protector;
+        for(size_t page = 0; page < PAGE_COUNT; ++page) {
+            protector.page_protections[reinterpret_cast<uintptr_t>(memory + page * page_size)] = PROT_READ;
+        }
+
+        const auto address = [&](const size_t offset) { return reinterpret_cast<uintptr_t>(memory + offset); };
+
+        patch_batch::Batch batch(page_size);
+        batch.add(address(16), "first");
+        batch.add(address(64), "second");
+        batch.add(address(page_size - 2), "span");
+        batch.add(address(16), "FI");
+        batch.add(address(5 * page_size), "far");
+
+        const auto result = batch.apply(protector);
+
+        CHECK(result.write_errors.size() == 5);
+        CHECK(std::ranges::none_of(result.write_errors, [](const auto& error) { return error.has_value(); }));
+        CHECK(result.restore_errors.empty());
+
+        // Pages 0-1 and page 5
+        CHECK(protector.unprotect_calls == 2);
+        CHECK(protector.restore_calls == 2);
+
+        CHECK(std::string_view(memory + 16, 5) == "FIrst");
+        CHECK(std::string_view(memory + 64, 6) == "second");
+        CHECK(std::string_view(memory + page_size - 2, 4) == "span");
+        CHECK(std::string_view(memory + 5 * page_size, 3) == "far");
+        CHECK(memory[5 * page_size + 3] == '.');
+
+        for(const size_t page : {0, 1, 5}) {
+            CHECK(get_permissions(address(page * page_size)).starts_with("r--"));
+        }
+
+        // Writes in a range whose protection cannot be changed are skipped
+        patch_batch::Batch failing_batch(page_size);
+        failing_batch.add(address(32), "applied");
+        failing_batch.add(address(3 * page_size), "skipped");
+        protector.failing_page = address(3 * page_size);
+
+        const auto failing_result = failing_batch.apply(protector);
+        CHECK(not failing_result.write_errors[0].has_value());
+        CHECK(failing_result.write_errors[1].has_value());
+        CHECK(std::string_view(memory + 32, 7) == "applied");
+        CHECK(memory[3 * page_size] == '.');
+        CHECK(get_permissions(address(0)).starts_with("r--"));
+
+        munmap(memory, page_size * PAGE_COUNT);
+    }
+
+    void test_invalid_page_size() {
+        bool thrown = false;
+        try {
+            patch_batch::Batch batch(3000);
+        } catch(const std::invalid_argument&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+}
+
+int main() {
+    test_ranges();
+    test_apply_with_mprotect();
+    test_invalid_page_size();
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,83 @@
+#include <fstream>
+
+#include "patch_cache/patch_cache.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    void write_file(const fs::path& path, const std::string& content) {
+        std::ofstream(path, std::ios::trunc) << content;
+    }
+
+    void test_round_trip(const fs::path& root) {
+        const auto cache_path = root / "Koaloader.patches.cache";
+        const patch_cache::Identity identity{.timestamp = 0x5F3E2A10, .size_of_image = 0x2A000000, .checksum = 0};
+
+        CHECK(patch_cache::lookup(cache_path, identity).empty());
+
+        const patch_cache::Offsets offsets{
+            {{".rdata", "literal", "steam_api64.dll"}, 0x1234},
+            {{".text", "signature", "48 8B ?? ?? 05"}, 0},
+            // Patterns with separators and line breaks
+            {{".rdata", "regex", "a b\nc\\d+"}, 0xFFFFFFFF0},
+            {{"", "auto", ""}, 42},
+            // Repeated patterns
+            {{".rdata", "literal", "steam_api64.dll", 1}, 0x1300},
+            {{".rdata", "literal", "steam_api64.dll", 2}, 0x1400},
+        };
+        patch_cache::store(cache_path, identity, offsets);
+
+        CHECK(patch_cache::lookup(cache_path, identity) == offsets);
+
+        // Another build of the executable does not share the offsets
+        auto other_identity = identity;
+        other_identity.timestamp++;
+        CHECK(patch_cache::lookup(cache_path, other_identity).empty());
+
+        // Both executables coexist
+        const patch_cache::Offsets other_offsets{{{".rdata", "literal", "other"}, 7}};
+        patch_cache::store(cache_path, other_identity, other_offsets);
+        CHECK(patch_cache::lookup(cache_path, identity) == offsets);
+        CHECK(patch_cache::lookup(cache_path, other_identity) == other_offsets);
+
+        // Storing again replaces the previous offsets
+        patch_cache::store(cache_path, identity, {});
+        CHECK(patch_cache::lookup(cache_path, identity).empty());
+        CHECK(patch_cache::lookup(cache_path, other_identity) == other_offsets);
+    }
+
+    void test_corrupted_cache(const fs::path& root) {
+        const auto cache_path = root / "corrupted.cache";
+        const patch_cache::Identity identity{.timestamp = 1, .size_of_image = 2, .checksum = 3};
+
+        write_file(cache_path, "garbage");
+        CHECK(patch_cache::lookup(cache_path, identity).empty());
+
+        write_file(cache_path, "koaloader-patch-cache 2\nexe 1 2 3\npatch 10 0 2e ZZ 61\nend\n");
+        CHECK(patch_cache::lookup(cache_path, identity).empty());
+
+        write_file(cache_path, "koaloader-patch-cache 2\nexe 1 2 3\npatch not-a-number 0 2e 61 61\nend\n");
+        CHECK(patch_cache::lookup(cache_path, identity).empty());
+
+        write_file(cache_path, "koaloader-patch-cache 2\nexe 1 2 3\npatch 10 0 2e 61 616\nend\n");
+        CHECK(patch_cache::lookup(cache_path, identity).empty());
+
+        // Storing over a corrupted cache recovers
+        patch_cache::store(cache_path, identity, {{{".data", "literal", "x"}, 1}});
+        CHECK(patch_cache::lookup(cache_path, identity).size() == 1);
+    }
+}
+
+int main() {
+    const auto root = fs::temp_directory_path() / "koaloader_patch_cache_test";
+    fs::remove_all(root);
+    fs::create_directories(root);
+
+    test_round_trip(root);
+    test_corrupted_cache(root);
+
+    fs::remove_all(root);
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pe_exports/pe_exports.hpp"
+#include "test_utils.hpp"
+
+/**
+ * The fixtures are generated by `fixtures/pe/make_fixtures.py`
+ */
+namespace {
+    namespace fs = std::filesystem;
+
+    const fs::path FIXTURES_DIR = PE_FIXTURES_DIR;
+
+    std::vector<uint8_t> read_fixture(const std::string& name) {
+        const pe_exports::MappedFile file(FIXTURES_DIR / name);
+        const auto data = file.data();
+        return {data.begin(), data.end()};
+    }
+
+    bool throws(const std::vector<uint8_t>& file) {
+        try {
+            (void) pe_exports::parse(file);
+            return false;
+        } catch(const std::runtime_error&) {
+            return true;
+        }
+    }
+
+    const pe_exports::Export* find(const pe_exports::Exports& exports, const uint32_t ordinal) {
+        const auto it = std::ranges::find(exports.exports, ordinal, &pe_exports::Export::ordinal);
+        return it == exports.exports.end() ? nullptr : &*it;
+    }
+
+    void test_pe32_plus() {
+        const auto file = read_fixture("exports64.dll");
+        const auto exports = pe_exports::parse(file);
+
+        CHECK(exports.pe32_plus);
+        CHECK(exports.dll_name == "exports64.dll");
+        CHECK(exports.exports.size() == 5);
+
+        if(exports.exports.size() == 5) {
+            // Named exports come in the order of the name table, which is sorted
+            CHECK(exports.exports[0].name == "Alpha");
+            CHECK(exports.exports[0].ordinal == 1);
+            CHECK(exports.exports[0].rva == 0x1000);
+            CHECK(exports.exports[0].forwarder.empty());
+
+            CHECK(exports.exports[1].name == "Forwarded");
+            CHECK(exports.exports[1].ordinal == 3);
+            CHECK(exports.exports[1].rva == 0);
+            CHECK(exports.exports[1].forwarder == "KERNEL32.Sleep");
+
+            // Two names of the same function
+            CHECK(exports.exports[2].name == "Shared");
+            CHECK(exports.exports[3].name == "SharedAlias");
+            CHECK(exports.exports[2].ordinal == 2);
+            CHECK(exports.exports[3].ordinal == 2);
+            CHECK(exports.exports[3].rva == 0x1010);
+
+            CHECK(exports.exports[4].name.empty());
+            CHECK(exports.exports[4].ordinal == 5);
+            CHECK(exports.exports[4].rva == 0x1020);
+        }
+
+        // Unused ordinals are skipped
+        CHECK(find(exports, 4) == nullptr);
+
+        // Strings point into the file
+        const auto* const begin = reinterpret_cast<const char*>(file.data());
+        CHECK(exports.dll_name.data() >= begin && exports.dll_name.data() < begin + file.size());
+    }
+
+    void test_pe32() {
+        const auto exports = pe_exports::parse(read_fixture("exports32.dll"));
+
+        CHECK(not exports.pe32_plus);
+        CHECK(exports.dll_name == "exports32.dll");
+        CHECK(exports.exports.size() == 4);
+
+        const auto* const beta = find(exports, 10);
+        CHECK(beta && beta->name == "Beta" && beta->rva == 0x1000);
+
+        const auto* const shared = find(exports, 11);
+        CHECK(shared && shared->name == "Shared" && shared->rva == 0x1004);
+
+        const auto* const unnamed = find(exports, 12);
+        CHECK(unnamed && unnamed->name.empty() && unnamed->rva == 0x1008);
+
+        const auto* const forwarded = find(exports, 13);
+        CHECK(forwarded && forwarded->name == "HeapAllocForward");
+        CHECK(forwarded && forwarded->forwarder == "NTDLL.RtlAllocateHeap");
+    }
+
+    void test_no_exports() {
+        const auto exports = pe_exports::parse(read_fixture("no_exports.dll"));
+
+        CHECK(exports.pe32_plus);
+        CHECK(exports.dll_name.empty());
+        CHECK(exports.exports.empty());
+    }
+
+    void test_malformed() {
+        const auto file = read_fixture("exports64.dll");
+
+        CHECK(throws({}));
+        CHECK(throws({'M', 'Z'}));
+
+        auto not_pe = file;
+        not_pe[0] = 'X';
+        CHECK(throws(not_pe));
+
+        auto bad_signature = file;
+        bad_signature[0x40] = 'X';
+        CHECK(throws(bad_signature));
+
+        auto bad_magic = file;
+        bad_magic[0x40 + 24] = 0;
+        CHECK(throws(bad_magic));
+
+        // The export directory starts at offset 0x400, followed by its tables
+        const std::vector truncated(file.begin(), file.begin() + 0x420);
+        CHECK(throws(truncated));
+
+        auto bad_ordinal = file;
+        constexpr uint16_t out_of_range = 100;
+        std::memcpy(bad_ordinal.data() + 0x44C, &out_of_range, sizeof(out_of_range));
+        CHECK(throws(bad_ordinal));
+
+        // A huge function count must be rejected before anything is allocated for it
+        auto huge_count = file;
+        constexpr uint32_t count = 0x40000000;
+        std::memcpy(huge_count.data() + 0x400 + 20, &count, sizeof(count));
+        CHECK(throws(huge_count));
+    }
+
+    void test_read_files() {
+        const std::vector paths{
+            FIXTURES_DIR / "exports64.dll",
+            FIXTURES_DIR / "missing.dll",
+            FIXTURES_DIR / "exports32.dll",
+            FIXTURES_DIR / "no_exports.dll",
+            FIXTURES_DIR / "make_fixtures.py",
+        };
+
+        for(const size_t thread_count : {1, 2, 8}) {
+            std::mutex mutex;
+            std::set<std::pair<size_t, std::string>> names;
+
+            const auto errors = pe_exports::read_files(
+                paths, thread_count, [&](const size_t index, const pe_exports::Exports& exports) {
+                    const std::scoped_lock lock(mutex);
+                    for(const auto& entry : exports.exports) {
+                        names.emplace(index, entry.name);
+                    }
+                }
+            );
+
+            CHECK(errors.size() == paths.size());
+            CHECK(not errors[0] && not errors[2] && not errors[3]);
+            CHECK(errors[1].has_value());
+            CHECK(errors[4].has_value());
+
+            CHECK(names.contains({0, "Shared"}));
+            CHECK(names.contains({2, "Shared"}));
+            CHECK(names.contains({0, "SharedAlias"}));
+            CHECK(not names.contains({2, "SharedAlias"}));
+            CHECK(names.size() == 9);
+        }
+    }
+}
+
+int main() {
+    test_pe32_plus();
+    test_pe32();
+    test_no_exports();
+    test_malformed();
+    test_read_files();
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,193 @@
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "read_ahead/read_ahead.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    /**
+     * Issues read-ahead with `posix_fadvise`, which starts the reads in the kernel and returns immediately
+     */
+    class FadviseReader : public read_ahead::Reader {
+    public:
+        uint64_t add(const fs::path& path) override {
+            const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if(fd < 0) {
+                throw std::runtime_error("Failed to open " + path.string());
+            }
+
+            struct stat status{};
+            fstat(fd, &status);
+
+            const auto result = posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            close(fd);
+
+            if(result != 0) {
+                throw std::runtime_error("posix_fadvise failed");
+            }
+
+            return static_cast<uint64_t>(status.st_size);
+        }
+
+        void start() override {}
+    };
+
+    /**
+     * Records calls and fails for files named `fail.dll`
+     */
+    class FakeReader : public read_ahead::Reader {
+    public:
+        std::vector<fs::path> added;
+        int start_calls = 0;
+        bool fail_start = false;
+
+        uint64_t add(const fs::path& path) override {
+            if(path.filename() == "fail.dll") {
+                throw std::runtime_error("Simulated failure");
+            }
+
+            added.push_back(path);
+            return fs::file_size(path);
+        }
+
+        void start() override {
+            ++start_calls;
+
+            if(fail_start) {
+                throw std::runtime_error("Simulated start failure");
+            }
+        }
+    };
+
+    fs::path make_temp_directory() {
+        auto directory = fs::temp_directory_path() / ("koaloader_read_ahead_test_" + std::to_string(getpid()));
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+        return directory;
+    }
+
+    void write_file(const fs::path& path, const size_t size) {
+        std::ofstream file(path, std::ios::binary);
+        const std::string chunk(4096, 'k');
+        for(size_t written = 0; written < size; written += chunk.size()) {
+            file.write(chunk.data(), static_cast<std::streamsize>(std::min(chunk.size(), size - written)));
+        }
+    }
+
+    /**
+     * @return Fraction of the pages of the file that are in the page cache
+     */
+    double get_residency(const fs::path& path) {
+        const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        const auto size = static_cast<size_t>(fs::file_size(path));
+        auto* const view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+
+        const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        std::vector<unsigned char> pages((size + page_size - 1) / page_size);
+        mincore(view, size, pages.data());
+        munmap(view, size);
+
+        size_t resident = 0;
+        for(const auto page : pages) {
+            resident += page & 1;
+        }
+        return static_cast<double>(resident) / static_cast<double>(pages.size());
+    }
+
+    void test_candidates(const fs::path& directory) {
+        write_file(directory / "SmokeAPI64.dll", 10000);
+        write_file(directory / "ScreamAPI64.dll", 3000);
+        write_file(directory / "fail.dll", 100);
+        fs::create_directories(directory / "folder.dll");
+
+        FakeReader reader;
+        const auto summary = read_ahead::start_all(
+            reader, {
+                directory / "SmokeAPI64.dll",
+                directory / "missing.dll",
+                directory / "folder.dll",
+                directory / "fail.dll",
+                // Alternative spelling of a candidate that was already added
+                directory / "folder.dll" / ".." / "SmokeAPI64.dll",
+                directory / "ScreamAPI64.dll",
+            }
+        );
+
+        CHECK(reader.start_calls == 1);
+        CHECK(reader.added.size() == 2);
+        CHECK(not summary.error);
+        CHECK(summary.total_size == 13000);
+
+        CHECK(summary.results.size() == 3);
+        if(summary.results.size() == 3) {
+            CHECK(summary.results[0].path.filename() == "SmokeAPI64.dll");
+            CHECK(summary.results[0].size == 10000);
+            CHECK(not summary.results[0].error);
+            CHECK(summary.results[1].path.filename() == "fail.dll");
+            CHECK(summary.results[1].error == "Simulated failure");
+            CHECK(summary.results[2].path.filename() == "ScreamAPI64.dll");
+        }
+
+        reader.fail_start = true;
+        const auto failed = read_ahead::start_all(reader, {directory / "ScreamAPI64.dll"});
+        CHECK(failed.error == "Simulated start failure");
+        CHECK(failed.results.size() == 1);
+    }
+
+    void test_fadvise(const fs::path& directory) {
+        const auto path = directory / "UplayR1Unlocker64.dll";
+        write_file(path, 8 << 20);
+
+        // Evict the file from the page cache, which only works on disk-backed file systems
+        {
+            const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+
+        const auto evicted = get_residency(path) < 0.5;
+
+        FadviseReader reader;
+        const auto summary = read_ahead::start_all(reader, {path});
+
+        CHECK(summary.results.size() == 1);
+        CHECK(summary.total_size == 8 << 20);
+        CHECK(not summary.error);
+
+        if(not evicted) {
+            std::printf("Page cache eviction is not supported here, skipping residency check\n");
+            return;
+        }
+
+        // Read-ahead completes in the background without the file ever being read
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while(get_residency(path) < 1.0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        CHECK(get_residency(path) == 1.0);
+    }
+}
+
+int main() {
+    const auto directory = make_temp_directory();
+
+    test_candidates(directory);
+    test_fadvise(directory);
+
+    fs::remove_all(directory);
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,111 @@
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "startup_trace/startup_trace.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    void sleep_ms(const int ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+
+    void test_nested_scopes() {
+        startup_trace::Trace trace;
+
+        {
+            const startup_trace::Scope init("init", "phase", trace);
+            {
+                const startup_trace::Scope config("parse config", "phase", trace);
+                sleep_ms(2);
+            }
+            {
+                const startup_trace::Scope load("load SmokeAPI64.dll", "module", trace);
+                sleep_ms(1);
+            }
+        }
+
+        const auto events = trace.events();
+        CHECK(events.size() == 3);
+        if(events.size() != 3) {
+            return;
+        }
+
+        // Ordered by start time even though the outer scope ended last
+        CHECK(events[0].name == "init");
+        CHECK(events[0].depth == 0);
+        CHECK(events[1].name == "parse config");
+        CHECK(events[1].depth == 1);
+        CHECK(events[2].name == "load SmokeAPI64.dll");
+        CHECK(events[2].category == "module");
+
+        CHECK(events[1].duration >= std::chrono::milliseconds(2));
+        CHECK(events[0].duration >= events[1].duration + events[2].duration);
+        CHECK(events[1].start >= events[0].start);
+        CHECK(events[2].start >= events[1].start + events[1].duration);
+
+        const auto summary = trace.summary();
+        CHECK(summary.size() == 3);
+        CHECK(summary[0].starts_with("init: "));
+        CHECK(summary[1].starts_with("  parse config: "));
+        CHECK(summary[1].ends_with(" ms"));
+    }
+
+    void test_threads() {
+        startup_trace::Trace trace;
+
+        const startup_trace::Scope outer("outer", "phase", trace);
+
+        std::thread worker([&] {
+            const startup_trace::Scope scope("worker", "scan", trace);
+        });
+        worker.join();
+
+        const auto events = trace.events();
+        CHECK(events.size() == 1);
+        // Depth is tracked per thread
+        CHECK(events.size() == 1 && events[0].depth == 0);
+        CHECK(events.size() == 1 && events[0].thread_id != 0);
+    }
+
+    void test_chrome_json(const fs::path& root) {
+        startup_trace::Trace trace;
+        {
+            const startup_trace::Scope scope("patch \"a\\b\"\n", "patch", trace);
+        }
+
+        const auto json = trace.to_chrome_json();
+        CHECK(json.starts_with(R"({"displayTimeUnit":"ms","traceEvents":[)"));
+        CHECK(json.find(R"("name":"patch \"a\\b\"\n")") != std::string::npos);
+        CHECK(json.find(R"("cat":"patch","ph":"X","ts":)") != std::string::npos);
+        CHECK(json.find(R"("pid":1,"tid":)") != std::string::npos);
+        CHECK(json.ends_with("]}\n"));
+
+        // Empty traces are still valid
+        CHECK(startup_trace::Trace().to_chrome_json() == "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n]}\n");
+
+        const auto path = root / "Koaloader.trace.json";
+        trace.write_chrome_json(path);
+
+        std::ifstream file(path);
+        std::stringstream content;
+        content << file.rdbuf();
+        CHECK(content.str() == json);
+    }
+}
+
+int main() {
+    const auto root = fs::temp_directory_path() / "koaloader_startup_trace_test";
+    fs::remove_all(root);
+    fs::create_directories(root);
+
+    test_nested_scopes();
+    test_threads();
+    test_chrome_json(root);
+
+    fs::remove_all(root);
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,149 @@
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "symbol_table/symbol_table.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    using symbol_table::Id;
+
+    template<typename Function>
+    bool throws_logic_error(const Function& function) {
+        try {
+            function();
+            return false;
+        } catch(const std::logic_error&) {
+            return true;
+        }
+    }
+
+    void test_string_pool() {
+        symbol_table::StringPool pool;
+
+        CHECK(not pool.find("").has_value());
+
+        const auto b = pool.intern("b");
+        const auto a = pool.intern("a");
+        const auto empty = pool.intern("");
+
+        CHECK(pool.intern("b") == b);
+        CHECK(pool.size() == 3);
+        CHECK(pool.get(a) == "a");
+        CHECK(pool.get(empty).empty());
+        CHECK(pool.find("a") == a);
+        CHECK(not pool.find("c").has_value());
+
+        // Enough strings to rehash several times
+        for(auto i = 0; i < 10000; ++i) {
+            pool.intern("symbol_" + std::to_string(i));
+        }
+
+        CHECK(pool.size() == 10003);
+        CHECK(pool.get(*pool.find("symbol_1234")) == "symbol_1234");
+        CHECK(pool.intern("symbol_9999") == *pool.find("symbol_9999"));
+
+        const auto new_ids = pool.sort();
+        CHECK(new_ids.size() == pool.size());
+        CHECK(pool.get(0).empty());
+        CHECK(pool.get(1) == "a");
+        CHECK(pool.get(2) == "b");
+        CHECK(pool.get(new_ids[b]) == "b");
+        CHECK(pool.get(*pool.find("symbol_42")) == "symbol_42");
+
+        for(Id id = 1; id < pool.size(); ++id) {
+            CHECK(pool.get(id - 1) < pool.get(id));
+        }
+    }
+
+    void test_symbol_table() {
+        symbol_table::SymbolTable table;
+
+        const auto user32 = table.add_library("C:/Windows/System32/user32.dll");
+        const auto version = table.add_library("C:/Windows/System32/version.dll");
+        const auto kernel32 = table.add_library("C:/Windows/System32/kernel32.dll");
+        CHECK(table.add_library("C:/Windows/System32/version.dll") == version);
+
+        table.add(version, "GetFileVersionInfoW");
+        table.add(version, "VerQueryValueW");
+        table.add(kernel32, "GetFileVersionInfoW");
+        table.add(kernel32, "Sleep");
+        table.add(user32, "MessageBoxW");
+        // Duplicates are stored once
+        table.add(kernel32, "Sleep");
+
+        CHECK(table.membership_count() == 6);
+        CHECK(throws_logic_error([&] { (void) table.libraries_of(0); }));
+
+        table.finalize();
+        table.finalize();
+
+        CHECK(table.symbol_count() == 4);
+        CHECK(table.library_count() == 3);
+        CHECK(table.membership_count() == 5);
+
+        // IDs follow the sorted order of names
+        CHECK(table.symbol(0) == "GetFileVersionInfoW");
+        CHECK(table.symbol(3) == "VerQueryValueW");
+        CHECK(table.library(0) == "C:/Windows/System32/kernel32.dll");
+        CHECK(table.library(2) == "C:/Windows/System32/version.dll");
+
+        const auto shared = table.libraries_of(*table.find_symbol("GetFileVersionInfoW"));
+        CHECK((std::vector(shared.begin(), shared.end()) == std::vector<Id>{0, 2}));
+
+        const auto sleep = table.libraries_of(*table.find_symbol("Sleep"));
+        CHECK(sleep.size() == 1 && table.library(sleep[0]) == "C:/Windows/System32/kernel32.dll");
+
+        CHECK(not table.find_symbol("Missing").has_value());
+        CHECK(table.memory_usage() > 0);
+
+        CHECK(throws_logic_error([&] { table.add(0, "Late"); }));
+        CHECK(throws_logic_error([&] { table.add_library("C:/late.dll"); }));
+    }
+
+    /**
+     * Compares the table with the map it replaces on a corpus where many symbols are shared
+     */
+    void test_against_map() {
+        symbol_table::SymbolTable table;
+        std::map<std::string, std::set<std::string>> expected;
+
+        for(auto library = 0; library < 50; ++library) {
+            const auto path = "lib" + std::to_string(library) + ".dll";
+            const auto id = table.add_library(path);
+
+            for(auto symbol = 0; symbol < 200; ++symbol) {
+                const auto name = "Symbol" + std::to_string((library * 37 + symbol * 11) % 1000);
+                table.add(id, name);
+                expected[name].insert(path);
+            }
+        }
+
+        table.finalize();
+
+        CHECK(table.symbol_count() == expected.size());
+
+        Id id = 0;
+        for(const auto& [name, paths] : expected) {
+            CHECK(table.symbol(id) == name);
+
+            std::set<std::string> libraries;
+            for(const auto library : table.libraries_of(id)) {
+                libraries.emplace(table.library(library));
+            }
+            CHECK(libraries == paths);
+
+            ++id;
+        }
+    }
+}
+
+int main() {
+    test_string_pool();
+    test_symbol_table();
+    test_against_map();
+
+    return test_utils::exit_code();
+}
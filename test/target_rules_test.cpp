@@ -0,0 +1,63 @@
+#include "target_rules/target_rules.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    void test_exact_names() {
+        const target_rules::Rules rules({{"Game.exe", "GameLauncher.exe"}, {"Helper.exe"}});
+
+        CHECK(rules.exact_count() == 3);
+        CHECK(rules.wildcard_count() == 0);
+
+        CHECK(rules.find("Game.exe") == 0);
+        CHECK(rules.find("GAME.EXE") == 0);
+        CHECK(rules.find("gamelauncher.exe") == 0);
+        CHECK(rules.find("helper.exe") == 1);
+        CHECK(not rules.find("Game.exe.bak"));
+        CHECK(not rules.find("Game"));
+        CHECK(not rules.find(""));
+    }
+
+    void test_wildcards() {
+        const target_rules::Rules rules({{"Launcher*.exe"}, {"Game.exe", "Game_??.exe"}, {"*.exe"}});
+
+        CHECK(rules.exact_count() == 1);
+        CHECK(rules.wildcard_count() == 3);
+
+        CHECK(rules.find("Launcher.exe") == 0);
+        CHECK(rules.find("launcher_x64.EXE") == 0);
+        CHECK(rules.find("Game_DX.exe") == 1);
+        CHECK(rules.find("Game_DX12.exe") == 2);
+        CHECK(rules.find("CrashReporter.exe") == 2);
+        CHECK(not rules.find("readme.txt"));
+    }
+
+    void test_priority() {
+        // The first rule wins, whether it matched by name or by wildcard
+        const target_rules::Rules rules({{"Game*.exe"}, {"Game.exe", "Tool.exe"}, {"Tool.exe", "*"}});
+
+        CHECK(rules.find("Game.exe") == 0);
+        CHECK(rules.find("Tool.exe") == 1);
+        CHECK(rules.find("Other.dll") == 2);
+
+        const target_rules::Rules exact_first({{"Game.exe"}, {"*.exe"}});
+        CHECK(exact_first.find("game.exe") == 0);
+        CHECK(exact_first.find("editor.exe") == 1);
+    }
+
+    void test_empty() {
+        const target_rules::Rules rules;
+        CHECK(not rules.find("Game.exe"));
+
+        const target_rules::Rules empty_rules({{}, {}});
+        CHECK(not empty_rules.find("Game.exe"));
+    }
+}
+
+int main() {
+    test_exact_names();
+    test_wildcards();
+    test_priority();
+    test_empty();
+
+    return test_utils::exit_code();
+}
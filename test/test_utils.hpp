@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Minimal assertion helpers for the portable test executables.
+ * Failures are reported and counted, and the process exit code reflects the total.
+ */
+namespace test_utils {
+    inline int failures = 0;
+
+    inline int exit_code() {
+        if(failures) {
+            std::fprintf(stderr, "%d check(s) failed\n", failures);
+            return EXIT_FAILURE;
+        }
+
+        std::printf("All checks passed\n");
+        return EXIT_SUCCESS;
+    }
+}
+
+#define CHECK(EXPR)                                                                                \
+    do {                                                                                           \
+        if(not(EXPR)) {                                                                            \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #EXPR);          \
+            ++test_utils::failures;                                                                \
+        }                                                                                          \
+    } while(false)
@@ -0,0 +1,68 @@
+#include <string>
+
+#include "well_known_modules/well_known_modules.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    constexpr well_known_modules::Set MODULES_32{32};
+    constexpr well_known_modules::Set MODULES_64{64};
+
+    bool contains_64(const std::string_view file_name) {
+        return MODULES_64.contains(file_name);
+    }
+
+    void test_all_names() {
+        for(const auto base_name : well_known_modules::BASE_NAMES) {
+            const std::string name(base_name);
+
+            CHECK(contains_64(name + ".dll"));
+            CHECK(contains_64(name + "64.dll"));
+            CHECK(not contains_64(name + "32.dll"));
+            CHECK(MODULES_32.contains(std::string_view(name + "32.dll")));
+            CHECK(not MODULES_32.contains(std::string_view(name + "64.dll")));
+        }
+
+        CHECK(MODULES_64.size() == 22);
+    }
+
+    void test_case_insensitivity() {
+        CHECK(contains_64("smokeapi64.DLL"));
+        CHECK(contains_64("SCREAMAPI.Dll"));
+        CHECK(contains_64("uplayr2unlocker.dll"));
+        CHECK(MODULES_64.contains(std::wstring_view(L"Lyptus64.DLL")));
+        CHECK(MODULES_64.contains(std::u16string_view(u"koaloaderb.dll")));
+    }
+
+    void test_rejections() {
+        CHECK(not contains_64(""));
+        CHECK(not contains_64(".dll"));
+        CHECK(not contains_64("SmokeAPI"));
+        CHECK(not contains_64("SmokeAPI.exe"));
+        CHECK(not contains_64("SmokeAPI.dll.bak"));
+        CHECK(not contains_64("xSmokeAPI.dll"));
+        CHECK(not contains_64("SmokeAPI6.dll"));
+        CHECK(not contains_64("SmokeAPI128.dll"));
+        CHECK(not contains_64("steam_api64.dll"));
+        CHECK(not contains_64("KoaloaderD.dll"));
+        CHECK(not contains_64("UplayR1Unlocker64.dll.config"));
+        CHECK(not MODULES_64.contains(std::wstring_view(L"Sm\u00f6keAPI.dll")));
+    }
+
+    void test_paths() {
+        CHECK(MODULES_64.contains_file_name_of(std::string_view(R"(C:\Games\Title\SmokeAPI64.dll)")));
+        CHECK(MODULES_64.contains_file_name_of(std::string_view("/games/title/dlc/ScreamAPI.dll")));
+        CHECK(MODULES_64.contains_file_name_of(std::wstring_view(LR"(D:\Unlocker.dll)")));
+        CHECK(MODULES_64.contains_file_name_of(std::string_view("Lyptus.dll")));
+        CHECK(not MODULES_64.contains_file_name_of(std::string_view(R"(C:\SmokeAPI64.dll\data.bin)")));
+        CHECK(not MODULES_64.contains_file_name_of(std::string_view(R"(C:\Games\)")));
+    }
+}
+
+int main() {
+    test_all_names();
+    test_case_insensitivity();
+    test_rejections();
+    test_paths();
+
+    return test_utils::exit_code();
+}
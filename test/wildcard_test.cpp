@@ -0,0 +1,54 @@
+#include <string_view>
+
+#include "wildcard/wildcard.hpp"
+#include "test_utils.hpp"
+
+namespace {
+    bool matches(const std::string_view pattern, const std::string_view text) {
+        return wildcard::matches(pattern, text);
+    }
+
+    void test_literals() {
+        CHECK(matches(".git", ".git"));
+        CHECK(matches("__pycache__", "__PYCACHE__"));
+        CHECK(not matches(".git", ".github"));
+        CHECK(not matches(".git", "a.git"));
+        CHECK(matches("", ""));
+        CHECK(not matches("", "a"));
+    }
+
+    void test_wildcards() {
+        CHECK(matches("*", ""));
+        CHECK(matches("*", "anything"));
+        CHECK(matches("ShaderCache*", "shadercache_dx12"));
+        CHECK(matches("*cache*", "D3DSCache"));
+        CHECK(matches("*.exe", "Game-Win64-Shipping.EXE"));
+        CHECK(not matches("*.exe", "Game.exe.bak"));
+        CHECK(matches("game?.exe", "game2.exe"));
+        CHECK(not matches("game?.exe", "game.exe"));
+        CHECK(matches("a*b*c", "aXXbYYbZZc"));
+        CHECK(not matches("a*b*c", "aXXbYYbZZ"));
+        CHECK(matches("**a**", "bab"));
+    }
+
+    void test_wide_text() {
+        CHECK(wildcard::matches("shader*", std::wstring_view(L"ShaderCache")));
+        CHECK(wildcard::matches("?", std::u16string_view(u"é")));
+        CHECK(not wildcard::matches("a", std::wstring_view(L"á")));
+    }
+
+    void test_is_literal() {
+        CHECK(wildcard::is_literal("game.exe"));
+        CHECK(not wildcard::is_literal("game*.exe"));
+        CHECK(not wildcard::is_literal("game?.exe"));
+    }
+}
+
+int main() {
+    test_literals();
+    test_wildcards();
+    test_wide_text();
+    test_is_literal();
+
+    return test_utils::exit_code();
+}
@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+
+#include "export_index/export_index.hpp"
+#include "pe_exports/pe_exports.hpp"
+#include "utf8_path/utf8_path.hpp"
+
+namespace {
+    using namespace export_index;
+
+    constexpr std::string_view MAGIC = "koaloader-export-index";
+    constexpr uint32_t FORMAT_VERSION = 1;
+
+    struct Pending {
+        std::string key;
+        config_snapshot::Stamp stamp;
+        std::optional<Entry> entry{};
+        bool rehashed = false;
+    };
+
+    bool equals_ignore_case(const std::string_view a, const std::string_view b) {
+        return std::ranges::equal(a, b, [](const char x, const char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    std::vector<std::string> get_symbols(const pe_exports::Exports& exports) {
+        std::vector<std::string> symbols;
+        symbols.reserve(exports.exports.size());
+
+        // Exports that are only available by ordinal have no symbol
+        for(const auto& entry : exports.exports) {
+            if(not entry.name.empty()) {
+                symbols.emplace_back(entry.name);
+            }
+        }
+
+        std::ranges::sort(symbols);
+        symbols.erase(std::ranges::unique(symbols).begin(), symbols.end());
+        return symbols;
+    }
+
+    void write_entry(config_snapshot::Writer& writer, const std::string& key, const Entry& entry) {
+        writer.write_string(key);
+        writer.write(entry.stamp.size);
+        writer.write(entry.stamp.modified);
+        writer.write(entry.hash);
+
+        writer.write<uint64_t>(entry.symbols.size());
+        for(const auto& symbol : entry.symbols) {
+            writer.write_string(symbol);
+        }
+
+        writer.write<uint8_t>(entry.error.has_value());
+        if(entry.error) {
+            writer.write_string(*entry.error);
+        }
+    }
+
+    Entry read_entry(config_snapshot::Reader& reader) {
+        Entry entry;
+        entry.stamp.size = reader.read<uint64_t>();
+        entry.stamp.modified = reader.read<int64_t>();
+        entry.hash = reader.read<uint64_t>();
+
+        const auto symbol_count = reader.read<uint64_t>();
+        // Every symbol takes at least its length, which guards against allocating for a corrupted count
+        if(symbol_count > reader.remaining() / sizeof(uint64_t)) {
+            throw std::runtime_error("Truncated index");
+        }
+
+        entry.symbols.reserve(symbol_count);
+        for(uint64_t i = 0; i < symbol_count; ++i) {
+            entry.symbols.push_back(reader.read_string());
+        }
+
+        if(reader.read<uint8_t>()) {
+            entry.error = reader.read_string();
+        }
+
+        return entry;
+    }
+}
+
+namespace export_index {
+    /**
+     * Multiplies and rotates 8 bytes at a time, and mixes the result like the SplitMix64 finalizer
+     */
+    uint64_t content_hash(const std::span<const uint8_t> data) {
+        constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+
+        auto hash = data.size() * multiplier;
+        size_t offset = 0;
+
+        for(; offset + sizeof(uint64_t) <= data.size(); offset += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, data.data() + offset, sizeof(word));
+            hash = std::rotl(hash ^ (word * multiplier), 27) * 0xBF58476D1CE4E5B9ull;
+        }
+
+        for(; offset < data.size(); ++offset) {
+            hash = (hash ^ data[offset]) * 0x100000001B3ull;
+        }
+
+        hash = (hash ^ hash >> 30) * 0xBF58476D1CE4E5B9ull;
+        hash = (hash ^ hash >> 27) * 0x94D049BB133111EBull;
+        return hash ^ hash >> 31;
+    }
+
+    /**
+     * Layout:
+     *
+     * magic, format version, payload checksum, payload
+     */
+    Index Index::load(const fs::path& index_path) {
+        std::ifstream file(index_path, std::ios::binary);
+        if(not file) {
+            return {};
+        }
+
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        const auto data = std::move(contents).str();
+
+        try {
+            config_snapshot::Reader reader(data);
+
+            if(reader.read_string() != MAGIC || reader.read<uint32_t>() != FORMAT_VERSION) {
+                return {};
+            }
+
+            const auto expected_checksum = reader.read<uint64_t>();
+            const auto payload = reader.read_string();
+            if(content_hash({reinterpret_cast<const uint8_t*>(payload.data()), payload.size()}) != expected_checksum) {
+                return {};
+            }
+
+            config_snapshot::Reader payload_reader(payload);
+
+            Index index;
+            const auto entry_count = payload_reader.read<uint64_t>();
+            for(uint64_t i = 0; i < entry_count; ++i) {
+                auto key = payload_reader.read_string();
+                index.entries_by_path.insert_or_assign(std::move(key), read_entry(payload_reader));
+            }
+
+            return index;
+        } catch(const std::runtime_error&) {
+            return {};
+        }
+    }
+
+    void Index::save(const fs::path& index_path) const {
+        config_snapshot::Writer payload;
+        payload.write<uint64_t>(entries_by_path.size());
+        for(const auto& [key, entry] : entries_by_path) {
+            write_entry(payload, key, entry);
+        }
+
+        const auto& payload_data = payload.data();
+
+        config_snapshot::Writer writer;
+        writer.write_string(MAGIC);
+        writer.write(FORMAT_VERSION);
+        writer.write(content_hash({reinterpret_cast<const uint8_t*>(payload_data.data()), payload_data.size()}));
+        writer.write_string(payload_data);
+
+        auto temp_path = index_path;
+        temp_path += ".";
+        temp_path += std::to_string(std::random_device()()) + ".tmp";
+
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            if(not file) {
+                throw std::runtime_error("Failed to open " + utf8_path::to_utf8(temp_path) + " for writing");
+            }
+
+            file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+            if(not file) {
+                throw std::runtime_error("Failed to write " + utf8_path::to_utf8(temp_path));
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(temp_path, index_path, ec);
+        if(ec) {
+            fs::remove(temp_path, ec);
+            throw std::runtime_error("Failed to replace " + utf8_path::to_utf8(index_path));
+        }
+    }
+
+    UpdateStats Index::update(const std::vector<fs::path>& paths, const size_t thread_count) {
+        UpdateStats stats;
+
+        std::set<std::string> requested_keys;
+        std::vector<Pending> pending;
+        std::vector<fs::path> pending_paths;
+
+        for(const auto& path : paths) {
+            auto key = to_key(path);
+            if(not requested_keys.insert(key).second) {
+                continue;
+            }
+
+            // The stamp is taken before the file is read, like with config snapshots
+            const auto stamp = config_snapshot::get_stamp(path);
+            if(not stamp) {
+                stats.failed++;
+                stats.removed += entries_by_path.erase(key);
+                continue;
+            }
+
+            const auto it = entries_by_path.find(key);
+            if(it != entries_by_path.end() && it->second.stamp == *stamp) {
+                stats.unchanged++;
+                continue;
+            }
+
+            pending.push_back({.key = std::move(key), .stamp = *stamp});
+            pending_paths.push_back(path);
+        }
+
+        for(auto it = entries_by_path.begin(); it != entries_by_path.end();) {
+            if(not requested_keys.contains(it->first) && not config_snapshot::get_stamp(utf8_path::from_utf8(it->first))) {
+                it = entries_by_path.erase(it);
+                stats.removed++;
+            } else {
+                ++it;
+            }
+        }
+
+        // Entries are only read while the files are processed, and each file writes only its own result
+        const auto errors = pe_exports::for_each_file(
+            pending_paths, thread_count, [&](const size_t index, const std::span<const uint8_t> file) {
+                auto& item = pending[index];
+
+                Entry entry{.stamp = item.stamp, .hash = content_hash(file)};
+
+                const auto previous = entries_by_path.find(item.key);
+                if(previous != entries_by_path.end() && previous->second.hash == entry.hash) {
+                    entry.symbols = previous->second.symbols;
+                    entry.error = previous->second.error;
+                    item.rehashed = true;
+                } else {
+                    try {
+                        entry.symbols = get_symbols(pe_exports::parse(file));
+                    } catch(const std::runtime_error& e) {
+                        entry.error = e.what();
+                    }
+                }
+
+                item.entry = std::move(entry);
+            }
+        );
+
+        for(size_t i = 0; i < pending.size(); ++i) {
+            auto& item = pending[i];
+
+            if(errors[i] || not item.entry) {
+                stats.failed++;
+                entries_by_path.erase(item.key);
+                continue;
+            }
+
+            if(item.rehashed) {
+                stats.rehashed++;
+            } else if(item.entry->error) {
+                stats.failed++;
+            } else {
+                stats.parsed++;
+            }
+
+            entries_by_path.insert_or_assign(item.key, std::move(*item.entry));
+        }
+
+        return stats;
+    }
+
+    const std::map<std::string, Entry>& Index::entries() const {
+        return entries_by_path;
+    }
+
+    std::vector<std::string> Index::resolve(const std::string_view library) const {
+        if(const auto it = entries_by_path.find(to_key(utf8_path::from_utf8(library))); it != entries_by_path.end()) {
+            return {it->first};
+        }
+
+        std::vector<std::string> result;
+        for(const auto& [key, _] : entries_by_path) {
+            if(equals_ignore_case(utf8_path::to_utf8(utf8_path::from_utf8(key).filename()), library)) {
+                result.push_back(key);
+            }
+        }
+
+        return result;
+    }
+
+    std::vector<std::string> Index::libraries_exporting(const std::string_view symbol) const {
+        std::vector<std::string> result;
+
+        for(const auto& [key, entry] : entries_by_path) {
+            if(std::ranges::binary_search(entry.symbols, symbol)) {
+                result.push_back(key);
+            }
+        }
+
+        return result;
+    }
+
+    std::vector<std::string> Index::shared_symbols(const std::vector<std::string>& libraries) const {
+        std::vector<std::string> result;
+
+        for(size_t i = 0; i < libraries.size(); ++i) {
+            const auto it = entries_by_path.find(libraries[i]);
+            if(it == entries_by_path.end()) {
+                return {};
+            }
+
+            if(i == 0) {
+                result = it->second.symbols;
+                continue;
+            }
+
+            std::vector<std::string> intersection;
+            std::ranges::set_intersection(result, it->second.symbols, std::back_inserter(intersection));
+            result = std::move(intersection);
+        }
+
+        return result;
+    }
+
+    std::string Index::to_key(const fs::path& path) {
+        std::error_code ec;
+        const auto absolute = fs::absolute(path, ec);
+        return utf8_path::to_utf8((ec ? path : absolute).lexically_normal());
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config_snapshot/config_snapshot.hpp"
+
+/**
+ * Persistent index of the named exports of libraries.
+ *
+ * Every library is remembered with the size, modification time and content hash of its file,
+ * so that updating the index only reads libraries whose size or modification time changed,
+ * and only parses those whose content changed as well. Queries are answered from the index alone.
+ */
+namespace export_index {
+    namespace fs = std::filesystem;
+
+    struct Entry {
+        config_snapshot::Stamp stamp;
+        uint64_t hash = 0;
+        // Sorted and unique
+        std::vector<std::string> symbols{};
+        // Set if the file is not a valid PE image, so that it is not parsed again until it changes
+        std::optional<std::string> error{};
+    };
+
+    struct UpdateStats {
+        // Libraries with the same size and modification time as before
+        size_t unchanged = 0;
+        // Libraries with a different size or modification time, but the same content
+        size_t rehashed = 0;
+        size_t parsed = 0;
+        // Libraries that could not be read or parsed
+        size_t failed = 0;
+        // Entries of libraries that no longer exist
+        size_t removed = 0;
+    };
+
+    /**
+     * Fast non-cryptographic hash of file contents
+     */
+    uint64_t content_hash(std::span<const uint8_t> data);
+
+    /**
+     * Library paths are absolute and UTF-8 encoded
+     */
+    class Index {
+    public:
+        /**
+         * Corrupted or missing index files are treated as empty.
+         */
+        static Index load(const fs::path& index_path);
+
+        /**
+         * The index is written to a temporary file first and then renamed over the previous one.
+         *
+         * @throws std::runtime_error if the index cannot be written
+         */
+        void save(const fs::path& index_path) const;
+
+        /**
+         * Brings the entries of the given libraries up to date, reading changed ones on up to `thread_count` threads.
+         * Entries of libraries that no longer exist are removed, while entries of other libraries are kept.
+         */
+        UpdateStats update(const std::vector<fs::path>& paths, size_t thread_count);
+
+        [[nodiscard]] const std::map<std::string, Entry>& entries() const;
+
+        /**
+         * @param library Path of a library, or a file name that is compared case-insensitively
+         * @return Paths of matching libraries in the index
+         */
+        [[nodiscard]] std::vector<std::string> resolve(std::string_view library) const;
+
+        /**
+         * @return Paths of libraries that export the symbol
+         */
+        [[nodiscard]] std::vector<std::string> libraries_exporting(std::string_view symbol) const;
+
+        /**
+         * @param libraries Paths of libraries in the index
+         * @return Symbols exported by every one of the libraries
+         */
+        [[nodiscard]] std::vector<std::string> shared_symbols(const std::vector<std::string>& libraries) const;
+
+        static std::string to_key(const fs::path& path);
+
+    private:
+        std::map<std::string, Entry> entries_by_path;
+    };
+}
@@ -0,0 +1,489 @@
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "hook_replay/hook_replay.hpp"
+#include "find_filter/find_filter.hpp"
+#include "hook_stats/hook_stats.hpp"
+
+namespace {
+    using hook_trace::Api;
+    using namespace hook_replay;
+
+    constexpr uint32_t FILE_ATTRIBUTE_NORMAL = 0x80;
+
+    /**
+     * Hiding decisions of recorded enumerations, by entry name
+     */
+    using EntryDecisions = std::map<std::u16string, bool, std::less<>>;
+
+    /**
+     * Hook call reconstructed from the trace, with its paths decoded ahead of time,
+     * so that decoding is not measured. A call of the find hooks spans several records
+     * when hidden entries were skipped on its handle.
+     */
+    struct Call {
+        Api api;
+        bool recorded_hidden = false;
+        // Find handle that `FindFirstFile` returned, or that was passed to `FindNextFileW` or `FindClose`
+        uint64_t recorded_handle = 0;
+        // `FindFirstFile` call that returned a handle
+        bool recorded_found = false;
+        // `FindNextFileW` call that reported the end of the directory, after which the caller stopped enumerating
+        bool recorded_end = false;
+        // Narrow path as recorded, for the ANSI functions
+        std::string_view narrow_path{};
+        std::u16string path{};
+    };
+
+    struct Session {
+        std::vector<Call> calls;
+        // Decisions of the recorded enumerations, by query
+        std::map<std::u16string, EntryDecisions, std::less<>> entry_decisions;
+    };
+
+    /**
+     * Groups records into hook calls. Records of a find handle belong to the same call
+     * until a visible entry or the end of the directory, and a `FindClose` that follows
+     * a `FindFirstFile` without visible entries was made by the hook itself.
+     */
+    Session read_session(const std::span<const hook_trace::Record> records) {
+        Session session;
+        // Calls that are still skipping hidden entries, by recorded handle
+        std::unordered_map<uint64_t, size_t> open_calls;
+        // Query of each recorded find handle
+        std::unordered_map<uint64_t, std::u16string> queries;
+        // Handles that were closed by `FindFirstFile` itself
+        std::unordered_set<uint64_t> closed_by_hook;
+
+        for(const auto& record : records) {
+            switch(record.api) {
+            case Api::FindFirstFileW:
+            case Api::FindFirstFileExW: {
+                auto& call = session.calls.emplace_back(Call{
+                    .api = record.api,
+                    .path = hook_trace::to_utf16(record.path),
+                });
+
+                if(record.result == INVALID_HANDLE) {
+                    break;
+                }
+
+                const auto handle = static_cast<uint64_t>(record.result);
+                call.recorded_handle = handle;
+                call.recorded_found = true;
+                queries[handle] = call.path;
+                session.entry_decisions[call.path].try_emplace(hook_trace::to_utf16(record.file_name), record.hidden);
+
+                if(record.hidden) {
+                    open_calls[handle] = session.calls.size() - 1;
+                }
+                break;
+            }
+            case Api::FindNextFileW: {
+                if(record.result) {
+                    session.entry_decisions[queries[record.handle]].try_emplace(
+                        hook_trace::to_utf16(record.file_name), record.hidden
+                    );
+                }
+
+                auto index = session.calls.size();
+                if(const auto open = open_calls.find(record.handle); open != open_calls.end()) {
+                    index = open->second;
+                } else {
+                    session.calls.push_back({.api = record.api, .recorded_handle = record.handle});
+                }
+
+                if(record.hidden) {
+                    open_calls[record.handle] = index;
+                    break;
+                }
+
+                open_calls.erase(record.handle);
+
+                if(not record.result) {
+                    auto& call = session.calls[index];
+                    if(call.api == Api::FindNextFileW) {
+                        call.recorded_end = true;
+                    } else {
+                        call.recorded_found = false;
+                        closed_by_hook.insert(record.handle);
+                    }
+                }
+                break;
+            }
+            case Api::FindClose:
+                if(not closed_by_hook.erase(record.handle)) {
+                    session.calls.push_back({.api = record.api, .recorded_handle = record.handle});
+                }
+                break;
+            default:
+                session.calls.push_back({
+                    .api = record.api,
+                    .recorded_hidden = record.hidden,
+                    .narrow_path = record.path,
+                    .path = hook_trace::to_utf16(record.path),
+                });
+                break;
+            }
+        }
+
+        return session;
+    }
+
+    bool is_attributes_query(const Api api) {
+        return api == Api::GetFileAttributesA || api == Api::GetFileAttributesW ||
+               api == Api::GetFileAttributesExA || api == Api::GetFileAttributesExW;
+    }
+
+    /**
+     * Hiding decisions of an iteration, compared with those of the recorded session
+     */
+    struct Decisions {
+        uint64_t hidden = 0;
+        uint64_t newly_hidden = 0;
+        uint64_t newly_visible = 0;
+
+        void add(const bool hidden, const bool recorded_hidden) {
+            this->hidden += hidden;
+            newly_hidden += hidden && not recorded_hidden;
+            newly_visible += not hidden && recorded_hidden;
+        }
+    };
+
+    /**
+     * Entries of a find handle of the file system, which is advanced like the hooks advance
+     * a handle with the original `FindNextFileW`
+     */
+    class FileSystemSource final : public find_filter::Source {
+    public:
+        FileSystemSource(
+            FileSystem& file_system,
+            hook_stats::CallTimer& timer,
+            const int64_t handle,
+            std::u16string& file_name,
+            const EntryDecisions& recorded_decisions,
+            Decisions& decisions
+        ) : file_system(file_system), timer(timer), handle(handle), file_name(file_name),
+            recorded_decisions(recorded_decisions), decisions(decisions) {}
+
+        find_filter::Advance next() override {
+            const auto found = timer.call_original([&] {
+                return file_system.find_next_file(handle, file_name);
+            });
+
+            return found ? find_filter::Advance::ENTRY : find_filter::Advance::END;
+        }
+
+        [[nodiscard]] std::u16string_view name() const override {
+            return file_name;
+        }
+
+        /**
+         * The file system only reports the end of a directory, so enumerations never fail
+         */
+        [[nodiscard]] uint32_t error() const override {
+            return 0;
+        }
+
+        void examined(const bool hidden) override {
+            const auto recorded = recorded_decisions.find(std::u16string_view(file_name));
+            decisions.add(hidden, recorded != recorded_decisions.end() && recorded->second);
+        }
+
+    private:
+        FileSystem& file_system;
+        hook_stats::CallTimer& timer;
+        int64_t handle;
+        std::u16string& file_name;
+        const EntryDecisions& recorded_decisions;
+        Decisions& decisions;
+    };
+
+    /**
+     * Find handle of the file system that stands in for a recorded one
+     */
+    struct ReplayHandle {
+        int64_t handle;
+        const EntryDecisions* recorded_decisions;
+        // The caller has seen the end of the directory
+        bool ended;
+    };
+}
+
+namespace hook_replay {
+    TraceFileSystem::TraceFileSystem(const std::span<const hook_trace::Record> records) {
+        // Listings that are still being enumerated, by recorded handle.
+        // Null if the query had already been enumerated before.
+        std::unordered_map<uint64_t, std::vector<std::u16string>*> open_listings;
+
+        for(const auto& record : records) {
+            switch(record.api) {
+            case Api::FindFirstFileW:
+            case Api::FindFirstFileExW: {
+                if(record.result == INVALID_HANDLE) {
+                    break;
+                }
+
+                const auto [listing, inserted] = directories.try_emplace(hook_trace::to_utf16(record.path));
+                if(inserted) {
+                    listing->second.push_back(hook_trace::to_utf16(record.file_name));
+                }
+                open_listings[static_cast<uint64_t>(record.result)] = inserted ? &listing->second : nullptr;
+                break;
+            }
+            case Api::FindNextFileW: {
+                const auto listing = open_listings.find(record.handle);
+                if(record.result && listing != open_listings.end() && listing->second) {
+                    listing->second->push_back(hook_trace::to_utf16(record.file_name));
+                }
+                break;
+            }
+            case Api::FindClose:
+                open_listings.erase(record.handle);
+                break;
+            case Api::GetFileAttributesA:
+            case Api::GetFileAttributesW:
+                if(not record.hidden) {
+                    attributes.try_emplace(hook_trace::to_utf16(record.path), static_cast<uint32_t>(record.result));
+                }
+                break;
+            case Api::GetFileAttributesExA:
+            case Api::GetFileAttributesExW:
+                // Only success is recorded, so existing files get the most common attributes
+                if(not record.hidden) {
+                    attributes.try_emplace(
+                        hook_trace::to_utf16(record.path),
+                        record.result ? FILE_ATTRIBUTE_NORMAL : INVALID_FILE_ATTRIBUTES
+                    );
+                }
+                break;
+            case Api::CreateFileA:
+            case Api::CreateFileW:
+                if(not record.hidden) {
+                    opened_files.try_emplace(hook_trace::to_utf16(record.path), record.result);
+                }
+                break;
+            }
+        }
+    }
+
+    int64_t TraceFileSystem::find_first_file(const std::u16string_view query, std::u16string& file_name) {
+        const auto directory = directories.find(query);
+        if(directory == directories.end()) {
+            return INVALID_HANDLE;
+        }
+
+        const auto handle = next_handle++;
+        enumerations[handle] = {&directory->second, 1};
+        file_name = directory->second.front();
+
+        return handle;
+    }
+
+    bool TraceFileSystem::find_next_file(const int64_t handle, std::u16string& file_name) {
+        const auto enumeration = enumerations.find(handle);
+        if(enumeration == enumerations.end()) {
+            return false;
+        }
+
+        auto& [entries, next] = enumeration->second;
+        if(next >= entries->size()) {
+            return false;
+        }
+
+        file_name = (*entries)[next++];
+        return true;
+    }
+
+    bool TraceFileSystem::find_close(const int64_t handle) {
+        return enumerations.erase(handle) > 0;
+    }
+
+    uint32_t TraceFileSystem::get_file_attributes(const std::u16string_view path) {
+        const auto entry = attributes.find(path);
+        return entry == attributes.end() ? INVALID_FILE_ATTRIBUTES : entry->second;
+    }
+
+    int64_t TraceFileSystem::create_file(const std::u16string_view path) {
+        const auto entry = opened_files.find(path);
+        return entry == opened_files.end() ? INVALID_HANDLE : entry->second;
+    }
+
+    size_t TraceFileSystem::directory_count() const {
+        return directories.size();
+    }
+
+    double Report::calls_per_second() const {
+        const auto seconds = std::chrono::duration<double>(duration).count();
+        return seconds > 0 ? static_cast<double>(calls) / seconds : 0;
+    }
+
+    /**
+     * Calls are replayed like the caller made them in the recorded session: enumerations
+     * skip hidden entries through `find_filter` on a single handle, and enumerations that
+     * reached the end of the directory continue until they reach it with the replayed patterns,
+     * while other paths are checked before calling the original function and never reach
+     * the file system if hidden.
+     */
+    Report replay(
+        const std::span<const hook_trace::Record> records,
+        const hide_matcher::Matcher& matcher,
+        FileSystem& file_system,
+        const uint32_t iterations
+    ) {
+        const auto session = read_session(records);
+        const EntryDecisions no_decisions;
+
+        hook_stats::Registry registry;
+        std::array<hook_stats::HookStats*, hook_trace::API_COUNT> stats{};
+        for(size_t api = 0; api < hook_trace::API_COUNT; ++api) {
+            stats[api] = &registry.add(std::string(hook_trace::api_name(static_cast<Api>(api))));
+        }
+
+        Report report;
+        Decisions decisions;
+        std::u16string file_name;
+        // Handles of the file system, by recorded handle
+        std::unordered_map<uint64_t, ReplayHandle> handles;
+
+        /**
+         * @return Handle that the caller sees, or null if nothing is visible
+         */
+        const auto find_first_file = [&](const Call& call) -> ReplayHandle* {
+            hook_stats::CallTimer timer(*stats[static_cast<size_t>(call.api)], true);
+
+            const auto handle = timer.call_original([&] {
+                return file_system.find_first_file(call.path, file_name);
+            });
+
+            if(handle == INVALID_HANDLE) {
+                return nullptr;
+            }
+
+            const auto recorded = session.entry_decisions.find(std::u16string_view(call.path));
+            const auto* recorded_decisions =
+                recorded == session.entry_decisions.end() ? &no_decisions : &recorded->second;
+
+            FileSystemSource source(file_system, timer, handle, file_name, *recorded_decisions, decisions);
+            find_filter::Enumeration enumeration(source, matcher);
+
+            const auto found = enumeration.first() == find_filter::State::FOUND;
+            timer.set_hidden(enumeration.hidden() > 0);
+
+            if(not found) {
+                timer.call_original([&] { return file_system.find_close(handle); });
+                return nullptr;
+            }
+
+            return &(handles[call.recorded_handle] = {handle, recorded_decisions, false});
+        };
+
+        /**
+         * @return true if the caller sees another entry
+         */
+        const auto find_next_file = [&](ReplayHandle& handle) {
+            hook_stats::CallTimer timer(*stats[static_cast<size_t>(Api::FindNextFileW)], true);
+
+            FileSystemSource source(
+                file_system, timer, handle.handle, file_name, *handle.recorded_decisions, decisions
+            );
+            find_filter::Enumeration enumeration(source, matcher);
+
+            handle.ended = enumeration.next() != find_filter::State::FOUND;
+            timer.set_hidden(enumeration.hidden() > 0);
+
+            return not handle.ended;
+        };
+
+        const auto find_close = [&](const uint64_t recorded_handle) {
+            const auto handle = handles.find(recorded_handle);
+
+            hook_stats::CallTimer timer(*stats[static_cast<size_t>(Api::FindClose)], true);
+            timer.call_original([&] { return file_system.find_close(handle->second.handle); });
+
+            handles.erase(handle);
+        };
+
+        const auto start = hook_stats::Clock::now();
+
+        for(uint32_t iteration = 0; iteration < iterations; ++iteration) {
+            decisions = {};
+            handles.clear();
+
+            for(const auto& call : session.calls) {
+                if(call.api == Api::FindFirstFileW || call.api == Api::FindFirstFileExW) {
+                    auto* const handle = find_first_file(call);
+                    report.calls++;
+
+                    // The recorded caller saw no entries, so it has no calls that would list the visible ones
+                    if(handle && not call.recorded_found) {
+                        while(find_next_file(*handle)) {
+                            report.calls++;
+                        }
+                        find_close(call.recorded_handle);
+                        report.calls += 2;
+                    }
+                    continue;
+                }
+
+                if(call.api == Api::FindNextFileW || call.api == Api::FindClose) {
+                    // The caller never got this handle
+                    const auto handle = handles.find(call.recorded_handle);
+                    if(handle == handles.end()) {
+                        continue;
+                    }
+
+                    if(call.api == Api::FindClose) {
+                        find_close(call.recorded_handle);
+                        report.calls++;
+                        continue;
+                    }
+
+                    // The caller has already stopped enumerating
+                    if(handle->second.ended) {
+                        continue;
+                    }
+
+                    bool found;
+                    do {
+                        found = find_next_file(handle->second);
+                        report.calls++;
+                    } while(found && call.recorded_end);
+                    continue;
+                }
+
+                bool hidden;
+
+                {
+                    hook_stats::CallTimer timer(*stats[static_cast<size_t>(call.api)], true);
+
+                    hidden = hook_trace::is_narrow(call.api)
+                                 ? hide_matcher::is_file_hidden(matcher, call.narrow_path)
+                                 : hide_matcher::is_file_hidden(matcher, std::u16string_view(call.path));
+
+                    if(not hidden) {
+                        if(is_attributes_query(call.api)) {
+                            timer.call_original([&] { return file_system.get_file_attributes(call.path); });
+                        } else {
+                            timer.call_original([&] { return file_system.create_file(call.path); });
+                        }
+                    }
+
+                    timer.set_hidden(hidden);
+                }
+
+                decisions.add(hidden, call.recorded_hidden);
+                report.calls++;
+            }
+        }
+
+        report.duration = hook_stats::Clock::now() - start;
+        report.hidden = decisions.hidden;
+        report.newly_hidden = decisions.newly_hidden;
+        report.newly_visible = decisions.newly_visible;
+        report.hook_lines = registry.report();
+
+        return report;
+    }
+}
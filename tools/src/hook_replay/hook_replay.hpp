@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hide_matcher/hide_matcher.hpp"
+#include "hook_trace/hook_trace.hpp"
+
+/**
+ * Offline replay of file API hook traces.
+ *
+ * Records are grouped back into the hook calls that made them, and every call is passed
+ * through the same hiding logic as the file API hooks (`hide_matcher::is_file_hidden` and
+ * `find_filter`), with a `hide_files` matcher of choice, while the original functions are served by
+ * a portable file system interface. The replay measures each call like `hook_stats`
+ * does in the game, and compares the hiding decisions with those of the recorded session.
+ */
+namespace hook_replay {
+    constexpr int64_t INVALID_HANDLE = -1;
+    constexpr uint32_t INVALID_FILE_ATTRIBUTES = UINT32_MAX;
+
+    /**
+     * Original functions of the hooked file API, with UTF-16 paths and Win32 return values
+     */
+    class FileSystem {
+    public:
+        virtual ~FileSystem() = default;
+
+        /**
+         * @return Find handle, or `INVALID_HANDLE` if nothing matches the query
+         */
+        virtual int64_t find_first_file(std::u16string_view query, std::u16string& file_name) = 0;
+
+        /**
+         * @return false once there are no more entries
+         */
+        virtual bool find_next_file(int64_t handle, std::u16string& file_name) = 0;
+
+        virtual bool find_close(int64_t handle) = 0;
+
+        /**
+         * @return Attributes, or `INVALID_FILE_ATTRIBUTES` if the file does not exist
+         */
+        virtual uint32_t get_file_attributes(std::u16string_view path) = 0;
+
+        /**
+         * @return File handle, or `INVALID_HANDLE` if the file cannot be opened
+         */
+        virtual int64_t create_file(std::u16string_view path) = 0;
+    };
+
+    /**
+     * File system reconstructed from a trace.
+     *
+     * Directory listings are assembled from the entries that the recorded enumerations returned,
+     * including hidden ones, and other paths have the attributes and open results that were recorded.
+     * Paths that were hidden when recorded never reached the file system, so they are treated as missing.
+     */
+    class TraceFileSystem final : public FileSystem {
+    public:
+        explicit TraceFileSystem(std::span<const hook_trace::Record> records);
+
+        int64_t find_first_file(std::u16string_view query, std::u16string& file_name) override;
+
+        bool find_next_file(int64_t handle, std::u16string& file_name) override;
+
+        bool find_close(int64_t handle) override;
+
+        uint32_t get_file_attributes(std::u16string_view path) override;
+
+        int64_t create_file(std::u16string_view path) override;
+
+        [[nodiscard]] size_t directory_count() const;
+
+    private:
+        struct Enumeration {
+            const std::vector<std::u16string>* entries;
+            size_t next;
+        };
+
+        // Entries of each query, in the order they were enumerated
+        std::map<std::u16string, std::vector<std::u16string>, std::less<>> directories;
+        std::map<std::u16string, uint32_t, std::less<>> attributes;
+        std::map<std::u16string, int64_t, std::less<>> opened_files;
+        std::map<int64_t, Enumeration> enumerations;
+        int64_t next_handle = 1;
+    };
+
+    struct Report {
+        // Hook calls of all iterations
+        uint64_t calls = 0;
+        // Wall time of all iterations
+        std::chrono::nanoseconds duration{};
+        // Hidden paths and enumerated entries in the last iteration
+        uint64_t hidden = 0;
+        // Paths and entries hidden now that were not hidden in the recorded session, and vice versa
+        uint64_t newly_hidden = 0;
+        uint64_t newly_visible = 0;
+        // One line per API with call counts and latency percentiles, as logged by `hook_stats`
+        std::vector<std::string> hook_lines;
+
+        [[nodiscard]] double calls_per_second() const;
+    };
+
+    /**
+     * @param iterations Number of times the whole trace is replayed
+     */
+    Report replay(
+        std::span<const hook_trace::Record> records,
+        const hide_matcher::Matcher& matcher,
+        FileSystem& file_system,
+        uint32_t iterations = 1
+    );
+}
@@ -1,75 +1,357 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <optional>
 #include <random>
 #include <ranges>
 #include <regex>
-#include <set>
+#include <thread>
 #include <vector>
 #include <string>
-#include <map>
 #include <filesystem>
 
+#include <Windows.h>
+#include <psapi.h>
+
 #include <glob/glob.h>
+#include <nlohmann/json.hpp>
 
 #include <koalabox/lib.hpp>
 #include <koalabox/logger.hpp>
 #include <koalabox/path.hpp>
 
+#include "export_index/export_index.hpp"
+#include "symbol_table/symbol_table.hpp"
+
 namespace {
     namespace kb = koalabox;
 
-    std::vector<std::string> parse_glob_input(const int argc, char* argv[]) {
-        if(argc < 2) {
-            throw std::runtime_error("No arguments provided.");
+    enum class Format {
+        LOG,
+        JSON,
+        CSV,
+    };
+
+    struct Options {
+        // Glob paths, or libraries in the index with `--shared`
+        std::vector<std::string> arguments;
+        // Loads every library instead of parsing its export directory, which runs its DllMain
+        bool load_library = false;
+        std::optional<std::filesystem::path> index_path;
+        // Lists the libraries in the index that export this symbol
+        std::optional<std::string> symbol_query;
+        // Lists the symbols shared by all libraries in the arguments
+        bool shared_query = false;
+        Format format = Format::LOG;
+        // File that receives JSON or CSV results instead of the standard output
+        std::optional<std::filesystem::path> output_path;
+    };
+
+    Format parse_format(const std::string& format) {
+        if(format == "log") {
+            return Format::LOG;
+        }
+
+        if(format == "json") {
+            return Format::JSON;
+        }
+
+        if(format == "csv") {
+            return Format::CSV;
         }
 
-        std::vector<std::string> paths;
+        throw std::runtime_error("Unknown format: " + format);
+    }
+
+    Options parse_options(const int argc, char* argv[]) {
+        Options options;
+
+        const auto next_value = [&](int& i) -> std::string {
+            if(i + 1 >= argc) {
+                throw std::runtime_error(std::string("Missing value of ") + argv[i]);
+            }
+
+            return argv[++i];
+        };
+
         for(auto i = 1; i < argc; ++i) {
-            paths.emplace_back(argv[i]);
+            const std::string arg = argv[i];
+
+            if(arg == "--load-library") {
+                options.load_library = true;
+            } else if(arg == "--index") {
+                options.index_path = next_value(i);
+            } else if(arg == "--symbol") {
+                options.symbol_query = next_value(i);
+            } else if(arg == "--shared") {
+                options.shared_query = true;
+            } else if(arg == "--format") {
+                options.format = parse_format(next_value(i));
+            } else if(arg == "--output") {
+                options.output_path = next_value(i);
+            } else {
+                options.arguments.push_back(arg);
+            }
+        }
+
+        if(options.load_library && options.index_path) {
+            throw std::runtime_error("--load-library cannot be combined with --index.");
+        }
+
+        if((options.symbol_query || options.shared_query) && not options.index_path) {
+            throw std::runtime_error("Queries require an --index.");
+        }
+
+        if(options.symbol_query && options.shared_query) {
+            throw std::runtime_error("--symbol cannot be combined with --shared.");
         }
-        return paths;
+
+        if(options.symbol_query && not options.arguments.empty()) {
+            throw std::runtime_error("--symbol does not take any glob paths.");
+        }
+
+        if(options.output_path && options.format == Format::LOG) {
+            throw std::runtime_error("--output requires --format json or csv.");
+        }
+
+        if(not options.symbol_query && options.arguments.empty()) {
+            throw std::runtime_error("No glob paths provided.");
+        }
+
+        return options;
     }
 
-    using symbol_name_t = std::string;
     using lib_path_t = std::filesystem::path;
-    using symbol_to_lib_path_t = std::map<symbol_name_t, std::set<lib_path_t>>;
 
-    auto construct_symbol_to_lib_path_map(const std::vector<std::string>& glob_strings) {
-        symbol_to_lib_path_t result;
+    std::vector<lib_path_t> expand_globs(const std::vector<std::string>& glob_strings) {
+        std::vector<lib_path_t> lib_paths;
 
         for(const auto& glob_str : glob_strings) {
             const auto glob_paths = glob::glob(glob_str);
+            lib_paths.insert(lib_paths.end(), glob_paths.begin(), glob_paths.end());
+        }
+
+        return lib_paths;
+    }
+
+    symbol_table::SymbolTable construct_symbol_table_by_loading(const std::vector<lib_path_t>& lib_paths) {
+        symbol_table::SymbolTable result;
+
+        for(const auto& lib_path : lib_paths) {
+            const auto lib_handle = kb::lib::load_library_or_throw(lib_path);
+            const auto lib_id = result.add_library(kb::path::to_str(lib_path));
+
+            // Avoid streaming views over the export map which MSVC's ranges implementation
+            // may not accept for this container. Materialize the export map into a local
+            // variable and iterate using structured bindings.
+            const auto export_map = kb::lib::get_export_map(lib_handle);
+            for(const auto& [symbol, _] : export_map) {
+                result.add(lib_id, symbol);
+            }
+        }
+
+        result.finalize();
+        return result;
+    }
+
+    /**
+     * Brings the index up to date with the libraries, parsing export directories of changed ones on a thread per core
+     */
+    symbol_table::SymbolTable construct_symbol_table_by_parsing(
+        export_index::Index& index,
+        const std::vector<lib_path_t>& lib_paths
+    ) {
+        const auto thread_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 16);
+        const auto stats = index.update(lib_paths, thread_count);
+
+        LOG_INFO(
+            "Exports of {} libraries were parsed, {} were unchanged, {} were rehashed, {} failed, {} were removed",
+            stats.parsed, stats.unchanged, stats.rehashed, stats.failed, stats.removed
+        );
+
+        symbol_table::SymbolTable result;
+
+        for(const auto& lib_path : lib_paths) {
+            const auto it = index.entries().find(export_index::Index::to_key(lib_path));
+            if(it == index.entries().end()) {
+                LOG_WARN("Skipping '{}': file could not be read", kb::path::to_str(lib_path));
+                continue;
+            }
+
+            if(const auto& error = it->second.error) {
+                LOG_WARN("Skipping '{}': {}", kb::path::to_str(lib_path), *error);
+                continue;
+            }
+
+            const auto lib_id = result.add_library(it->first);
+            for(const auto& symbol : it->second.symbols) {
+                result.add(lib_id, symbol);
+            }
+        }
+
+        result.finalize();
+        return result;
+    }
+
+    symbol_table::SymbolTable query_symbol(const export_index::Index& index, const std::string& symbol) {
+        symbol_table::SymbolTable result;
+
+        for(const auto& library : index.libraries_exporting(symbol)) {
+            result.add(result.add_library(library), symbol);
+        }
+
+        result.finalize();
+        return result;
+    }
+
+    symbol_table::SymbolTable query_shared_symbols(
+        const export_index::Index& index,
+        const std::vector<std::string>& names
+    ) {
+        std::vector<std::string> libraries;
+
+        for(const auto& name : names) {
+            const auto resolved = index.resolve(name);
+            if(resolved.empty()) {
+                throw std::runtime_error("Library is not in the index: " + name);
+            }
 
-            for(const auto& lib_path : glob_paths) {
-                const auto lib_handle = kb::lib::load_library_or_throw(lib_path);
+            libraries.insert(libraries.end(), resolved.begin(), resolved.end());
+        }
+
+        symbol_table::SymbolTable result;
+        const auto shared_symbols = index.shared_symbols(libraries);
 
-                // Avoid streaming views over the export map which MSVC's ranges implementation
-                // may not accept for this container. Materialize the export map into a local
-                // variable and iterate using structured bindings.
-                const auto export_map = kb::lib::get_export_map(lib_handle);
-                for(const auto& [symbol, _] : export_map) {
-                    auto& lib_set = result[symbol];
-                    lib_set.insert(lib_path);
-                }
+        for(const auto& library : libraries) {
+            const auto lib_id = result.add_library(library);
+            for(const auto& symbol : shared_symbols) {
+                result.add(lib_id, symbol);
             }
         }
 
+        result.finalize();
         return result;
     }
 
-    void print_common_exports(const symbol_to_lib_path_t& symbol_to_lib_path_map) {
-        for(const auto& [symbol_name, lib_path_set] : symbol_to_lib_path_map) {
-            if(lib_path_set.empty()) {
+    /**
+     * Large scans of SDK and System32 trees are bounded by memory, hence the report
+     */
+    void log_memory_usage(const symbol_table::SymbolTable& table) {
+        LOG_INFO(
+            "Symbol table of {} symbols, {} libraries and {} exports takes {} KiB",
+            table.symbol_count(), table.library_count(), table.membership_count(), table.memory_usage() / 1024
+        );
+
+        PROCESS_MEMORY_COUNTERS counters{};
+        if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            LOG_INFO("Peak working set: {} MiB", counters.PeakWorkingSetSize / (1024 * 1024));
+        }
+    }
+
+    void print_log(const symbol_table::SymbolTable& table, const bool common_only) {
+        for(symbol_table::Id symbol_id = 0; symbol_id < table.symbol_count(); ++symbol_id) {
+            const auto symbol_name = table.symbol(symbol_id);
+            const auto lib_ids = table.libraries_of(symbol_id);
+
+            if(lib_ids.empty()) {
                 LOG_ERROR("Invalid state: empty lib path set for symbol '{}':", symbol_name);
                 DebugBreak();
                 continue;
             }
 
-            if(lib_path_set.size() > 1) {
-                LOG_INFO("Common symbol '{}' found in {} libraries:", symbol_name, lib_path_set.size());
-                for(const auto& lib_path : lib_path_set) {
-                    LOG_INFO("    {}", kb::path::to_str(lib_path));
-                }
+            if(not common_only) {
+                LOG_INFO("Symbol '{}' found in {} libraries:", symbol_name, lib_ids.size());
+            } else if(lib_ids.size() > 1) {
+                LOG_INFO("Common symbol '{}' found in {} libraries:", symbol_name, lib_ids.size());
+            } else {
+                continue;
+            }
+
+            for(const auto lib_id : lib_ids) {
+                LOG_INFO("    {}", table.library(lib_id));
+            }
+        }
+    }
+
+    void print_json(std::ostream& output, const symbol_table::SymbolTable& table, const bool common_only) {
+        auto json = nlohmann::json::array();
+
+        for(symbol_table::Id symbol_id = 0; symbol_id < table.symbol_count(); ++symbol_id) {
+            const auto lib_ids = table.libraries_of(symbol_id);
+            if(common_only && lib_ids.size() < 2) {
+                continue;
+            }
+
+            auto libraries = nlohmann::json::array();
+            for(const auto lib_id : lib_ids) {
+                libraries.push_back(table.library(lib_id));
+            }
+
+            json.push_back({{"symbol", table.symbol(symbol_id)}, {"libraries", std::move(libraries)}});
+        }
+
+        output << json.dump(2) << std::endl;
+    }
+
+    /**
+     * Quotes fields as described in RFC 4180
+     */
+    std::string to_csv_field(const std::string_view field) {
+        if(field.find_first_of(",\"\r\n") == std::string_view::npos) {
+            return std::string(field);
+        }
+
+        std::string quoted = "\"";
+        for(const auto c : field) {
+            quoted += c;
+            if(c == '"') {
+                quoted += c;
+            }
+        }
+        return quoted + "\"";
+    }
+
+    void print_csv(std::ostream& output, const symbol_table::SymbolTable& table, const bool common_only) {
+        output << "symbol,library\n";
+
+        for(symbol_table::Id symbol_id = 0; symbol_id < table.symbol_count(); ++symbol_id) {
+            const auto lib_ids = table.libraries_of(symbol_id);
+            if(common_only && lib_ids.size() < 2) {
+                continue;
+            }
+
+            for(const auto lib_id : lib_ids) {
+                output << to_csv_field(table.symbol(symbol_id)) << ',' << to_csv_field(table.library(lib_id)) << '\n';
+            }
+        }
+
+        output.flush();
+    }
+
+    /**
+     * @param common_only Prints only symbols found in more than one library
+     */
+    void print_results(const symbol_table::SymbolTable& table, const Options& options, const bool common_only) {
+        if(options.format == Format::LOG) {
+            print_log(table, common_only);
+            return;
+        }
+
+        std::ofstream file;
+        if(options.output_path) {
+            file.open(*options.output_path, std::ios::trunc);
+            if(not file) {
+                throw std::runtime_error("Failed to open " + kb::path::to_str(*options.output_path) + " for writing");
             }
         }
+
+        auto& output = options.output_path ? static_cast<std::ostream&>(file) : std::cout;
+
+        if(options.format == Format::JSON) {
+            print_json(output, table, common_only);
+        } else {
+            print_csv(output, table, common_only);
+        }
     }
 }
 
@@ -77,13 +359,38 @@ int main(const int argc, char* argv[]) { // NOLINT(*-use-internal-linkage)
     try {
         kb::logger::init_console_logger();
 
-        const auto glob_strings = parse_glob_input(argc, argv);
-        const auto symbol_to_lib_path_map = construct_symbol_to_lib_path_map(glob_strings);
-        print_common_exports(symbol_to_lib_path_map);
+        const auto options = parse_options(argc, argv);
+
+        // Without an index file, the index only lives for this run
+        auto index = options.index_path ? export_index::Index::load(*options.index_path) : export_index::Index();
+
+        if(options.symbol_query) {
+            print_results(query_symbol(index, *options.symbol_query), options, false);
+            return EXIT_SUCCESS;
+        }
+
+        if(options.shared_query) {
+            print_results(query_shared_symbols(index, options.arguments), options, false);
+            return EXIT_SUCCESS;
+        }
+
+        const auto lib_paths = expand_globs(options.arguments);
+
+        const auto table = options.load_library
+                               ? construct_symbol_table_by_loading(lib_paths)
+                               : construct_symbol_table_by_parsing(index, lib_paths);
+
+        log_memory_usage(table);
+
+        if(options.index_path) {
+            index.save(*options.index_path);
+        }
+
+        print_results(table, options, true);
 
         return EXIT_SUCCESS;
     } catch(const std::exception& e) {
         LOG_ERROR("Unhandled global exception: {}", e.what());
         return EXIT_FAILURE;
     }
-}
\ No newline at end of file
+}
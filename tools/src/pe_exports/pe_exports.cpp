@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "pe_exports/pe_exports.hpp"
+
+namespace {
+    using namespace pe_exports;
+
+    constexpr uint16_t DOS_SIGNATURE = 0x5A4D; // MZ
+    constexpr uint32_t NT_SIGNATURE = 0x00004550; // PE\0\0
+    constexpr uint16_t PE32_MAGIC = 0x10B;
+    constexpr uint16_t PE32_PLUS_MAGIC = 0x20B;
+
+    constexpr size_t DOS_HEADER_SIZE = 0x40;
+    constexpr size_t E_LFANEW_OFFSET = 0x3C;
+    constexpr size_t FILE_HEADER_SIZE = 20;
+    constexpr size_t SECTION_HEADER_SIZE = 40;
+    constexpr size_t EXPORT_DIRECTORY_SIZE = 40;
+
+    struct Section {
+        uint32_t virtual_address = 0;
+        uint32_t virtual_size = 0;
+        uint32_t raw_offset = 0;
+        uint32_t raw_size = 0;
+    };
+
+    class Image {
+    public:
+        explicit Image(const std::span<const uint8_t> file) : file(file) {}
+
+        template<typename T>
+        [[nodiscard]] T read(const uint64_t offset) const {
+            if(offset > file.size() || file.size() - offset < sizeof(T)) {
+                throw std::runtime_error("Unexpected end of file at offset " + std::to_string(offset));
+            }
+
+            T value;
+            std::memcpy(&value, file.data() + offset, sizeof(T));
+            return value;
+        }
+
+        void read_sections(const uint64_t offset, const uint16_t count) {
+            sections.reserve(count);
+
+            for(uint16_t i = 0; i < count; ++i) {
+                const auto header = offset + i * SECTION_HEADER_SIZE;
+
+                sections.push_back({
+                    .virtual_address = read<uint32_t>(header + 12),
+                    .virtual_size = read<uint32_t>(header + 8),
+                    .raw_offset = read<uint32_t>(header + 20),
+                    .raw_size = read<uint32_t>(header + 16),
+                });
+            }
+        }
+
+        /**
+         * @param size Number of bytes at the RVA that must be present in the file
+         * @return File offset of the RVA
+         */
+        [[nodiscard]] uint64_t to_offset(const uint32_t rva, const uint64_t size = 0) const {
+            // Export tables and their strings usually share a section, so the last one is tried first
+            if(not contains(sections_cache, rva)) {
+                const auto it = std::ranges::find_if(sections, [&](const Section& section) {
+                    return contains(&section, rva);
+                });
+
+                if(it == sections.end()) {
+                    throw std::runtime_error("RVA " + std::to_string(rva) + " is not backed by any section");
+                }
+
+                sections_cache = &*it;
+            }
+
+            const auto delta = rva - sections_cache->virtual_address;
+            if(sections_cache->raw_size - delta < size) {
+                throw std::runtime_error("Table at RVA " + std::to_string(rva) + " exceeds its section");
+            }
+
+            const auto offset = uint64_t{sections_cache->raw_offset} + delta;
+            if(offset > file.size() || file.size() - offset < size) {
+                throw std::runtime_error("Table at RVA " + std::to_string(rva) + " exceeds the file");
+            }
+
+            return offset;
+        }
+
+        [[nodiscard]] std::string_view read_string(const uint32_t rva) const {
+            const auto offset = to_offset(rva);
+            const auto* const begin = reinterpret_cast<const char*>(file.data() + offset);
+            const auto* const end = static_cast<const char*>(std::memchr(begin, '\0', file.size() - offset));
+
+            if(not end) {
+                throw std::runtime_error("Unterminated string at RVA " + std::to_string(rva));
+            }
+
+            return {begin, static_cast<size_t>(end - begin)};
+        }
+
+    private:
+        std::span<const uint8_t> file;
+        std::vector<Section> sections;
+        mutable const Section* sections_cache = nullptr;
+
+        /**
+         * Only the raw data of a section is present in the file, the rest of its virtual size is zero-filled.
+         * Some linkers leave the virtual size at zero, in which case the raw size applies.
+         */
+        static bool contains(const Section* section, const uint32_t rva) {
+            if(not section || rva < section->virtual_address) {
+                return false;
+            }
+
+            const auto size = section->virtual_size ? std::min(section->raw_size, section->virtual_size) : section->raw_size;
+            return rva - section->virtual_address < size;
+        }
+    };
+}
+
+namespace pe_exports {
+    Exports parse(const std::span<const uint8_t> file) {
+        Image image(file);
+
+        if(file.size() < DOS_HEADER_SIZE || image.read<uint16_t>(0) != DOS_SIGNATURE) {
+            throw std::runtime_error("Missing DOS header");
+        }
+
+        const uint64_t nt_headers = image.read<uint32_t>(E_LFANEW_OFFSET);
+        if(image.read<uint32_t>(nt_headers) != NT_SIGNATURE) {
+            throw std::runtime_error("Missing PE signature");
+        }
+
+        const auto file_header = nt_headers + 4;
+        const auto section_count = image.read<uint16_t>(file_header + 2);
+        const auto optional_header_size = image.read<uint16_t>(file_header + 16);
+        const auto optional_header = file_header + FILE_HEADER_SIZE;
+
+        Exports result;
+
+        // Offsets of `NumberOfRvaAndSizes` and of the data directories depend on the optional header format
+        uint64_t directory_count_offset = 0;
+        switch(image.read<uint16_t>(optional_header)) {
+            case PE32_MAGIC:
+                directory_count_offset = 92;
+                break;
+            case PE32_PLUS_MAGIC:
+                result.pe32_plus = true;
+                directory_count_offset = 108;
+                break;
+            default:
+                throw std::runtime_error("Unknown optional header magic");
+        }
+
+        const auto export_directory_entry = directory_count_offset + 4;
+        if(
+            optional_header_size < export_directory_entry + 8 ||
+            image.read<uint32_t>(optional_header + directory_count_offset) == 0
+        ) {
+            return result;
+        }
+
+        const auto directory_rva = image.read<uint32_t>(optional_header + export_directory_entry);
+        const auto directory_size = image.read<uint32_t>(optional_header + export_directory_entry + 4);
+        if(directory_rva == 0) {
+            return result;
+        }
+
+        image.read_sections(optional_header + optional_header_size, section_count);
+
+        const auto directory = image.to_offset(directory_rva, EXPORT_DIRECTORY_SIZE);
+        const auto name_rva = image.read<uint32_t>(directory + 12);
+        const auto ordinal_base = image.read<uint32_t>(directory + 16);
+        const auto function_count = image.read<uint32_t>(directory + 20);
+        const auto name_count = image.read<uint32_t>(directory + 24);
+
+        if(name_rva) {
+            result.dll_name = image.read_string(name_rva);
+        }
+
+        // Table sizes are validated against the file before anything is allocated for them
+        const auto functions = function_count
+                                   ? image.to_offset(image.read<uint32_t>(directory + 28), uint64_t{function_count} * 4)
+                                   : 0;
+        const auto names = name_count
+                               ? image.to_offset(image.read<uint32_t>(directory + 32), uint64_t{name_count} * 4)
+                               : 0;
+        const auto name_ordinals = name_count
+                                       ? image.to_offset(image.read<uint32_t>(directory + 36), uint64_t{name_count} * 2)
+                                       : 0;
+
+        const auto make_export = [&](const uint32_t index) {
+            Export entry{.ordinal = ordinal_base + index};
+
+            const auto rva = image.read<uint32_t>(functions + uint64_t{index} * 4);
+            if(rva >= directory_rva && rva - directory_rva < directory_size) {
+                entry.forwarder = image.read_string(rva);
+            } else {
+                entry.rva = rva;
+            }
+
+            return entry;
+        };
+
+        result.exports.reserve(std::max(function_count, name_count));
+        std::vector<bool> is_named(function_count);
+
+        for(uint32_t i = 0; i < name_count; ++i) {
+            const auto index = image.read<uint16_t>(name_ordinals + uint64_t{i} * 2);
+            if(index >= function_count) {
+                throw std::runtime_error("Name ordinal " + std::to_string(index) + " is out of range");
+            }
+
+            auto entry = make_export(index);
+            entry.name = image.read_string(image.read<uint32_t>(names + uint64_t{i} * 4));
+            result.exports.push_back(entry);
+            is_named[index] = true;
+        }
+
+        for(uint32_t index = 0; index < function_count; ++index) {
+            // Unused entries between ordinals have a null RVA
+            if(not is_named[index] && image.read<uint32_t>(functions + uint64_t{index} * 4) != 0) {
+                result.exports.push_back(make_export(index));
+            }
+        }
+
+        return result;
+    }
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        const auto file = CreateFileW(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+        );
+        if(file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Failed to open " + path.string() + ": error " + std::to_string(GetLastError()));
+        }
+
+        LARGE_INTEGER file_size{};
+        GetFileSizeEx(file, &file_size);
+        size = static_cast<size_t>(file_size.QuadPart);
+
+        // Empty files cannot be mapped
+        if(size == 0) {
+            CloseHandle(file);
+            return;
+        }
+
+        const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if(not mapping) {
+            throw std::runtime_error("Failed to map " + path.string() + ": error " + std::to_string(GetLastError()));
+        }
+
+        address = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if(not address) {
+            throw std::runtime_error("Failed to map " + path.string() + ": error " + std::to_string(GetLastError()));
+        }
+    }
+
+    MappedFile::~MappedFile() {
+        if(address) {
+            UnmapViewOfFile(address);
+        }
+    }
+#else
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd < 0) {
+            throw std::runtime_error("Failed to open " + path.string() + ": " + std::strerror(errno));
+        }
+
+        struct stat status{};
+        if(fstat(fd, &status) != 0) {
+            close(fd);
+            throw std::runtime_error("Failed to stat " + path.string() + ": " + std::strerror(errno));
+        }
+        size = static_cast<size_t>(status.st_size);
+
+        // Empty files cannot be mapped
+        if(size == 0) {
+            close(fd);
+            return;
+        }
+
+        auto* const mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(mapping == MAP_FAILED) {
+            throw std::runtime_error("Failed to map " + path.string() + ": " + std::strerror(errno));
+        }
+
+        address = static_cast<const uint8_t*>(mapping);
+    }
+
+    MappedFile::~MappedFile() {
+        if(address) {
+            munmap(const_cast<uint8_t*>(address), size);
+        }
+    }
+#endif
+
+    std::span<const uint8_t> MappedFile::data() const {
+        return {address, address ? size : 0};
+    }
+
+    std::vector<std::optional<std::string>> for_each_file(
+        const std::vector<std::filesystem::path>& paths,
+        const size_t thread_count,
+        const FileVisitor& visitor
+    ) {
+        std::vector<std::optional<std::string>> errors(paths.size());
+        std::atomic<size_t> next_index = 0;
+
+        const auto work = [&] {
+            for(auto index = next_index++; index < paths.size(); index = next_index++) {
+                try {
+                    const MappedFile file(paths[index]);
+                    visitor(index, file.data());
+                } catch(const std::exception& e) {
+                    errors[index] = e.what();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(size_t i = 1; i < std::min(thread_count, paths.size()); ++i) {
+            threads.emplace_back(work);
+        }
+
+        work();
+
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        return errors;
+    }
+
+    std::vector<std::optional<std::string>> read_files(
+        const std::vector<std::filesystem::path>& paths,
+        const size_t thread_count,
+        const Visitor& visitor
+    ) {
+        return for_each_file(paths, thread_count, [&](const size_t index, const std::span<const uint8_t> file) {
+            visitor(index, parse(file));
+        });
+    }
+}
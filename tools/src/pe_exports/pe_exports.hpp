@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Reader of PE export directories straight from the bytes of a file on disk.
+ *
+ * Unlike `LoadLibrary`, this neither maps the image sections, nor runs `DllMain`,
+ * nor loads any dependencies, so it is safe and fast to run over entire system directories.
+ * Both PE32 and PE32+ images are supported. Parsing is zero-copy: every string
+ * in the result points into the parsed bytes, and every read is bounds-checked.
+ */
+namespace pe_exports {
+    struct Export {
+        // Empty for exports that are only available by ordinal
+        std::string_view name{};
+        uint32_t ordinal = 0;
+        // RVA of the exported symbol, or 0 for forwarded exports
+        uint32_t rva = 0;
+        // Target of a forwarded export, such as `NTDLL.RtlAllocateHeap`
+        std::string_view forwarder{};
+    };
+
+    struct Exports {
+        bool pe32_plus = false;
+        // Name of the DLL recorded in the export directory, if it has one
+        std::string_view dll_name;
+        // Named exports in the order of the name table, followed by ordinal-only exports by ordinal
+        std::vector<Export> exports;
+    };
+
+    /**
+     * @param file Contents of a PE file, as laid out on disk
+     * @throws std::runtime_error if the file is not a valid PE image or its export directory is malformed
+     */
+    Exports parse(std::span<const uint8_t> file);
+
+    /**
+     * Read-only memory mapping of an entire file
+     */
+    class MappedFile {
+    public:
+        /**
+         * @throws std::runtime_error if the file cannot be opened or mapped
+         */
+        explicit MappedFile(const std::filesystem::path& path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        [[nodiscard]] std::span<const uint8_t> data() const;
+
+    private:
+        const uint8_t* address = nullptr;
+        size_t size = 0;
+    };
+
+    /**
+     * Invoked with the contents of every file that was mapped successfully, possibly from several threads at once.
+     * The file is unmapped once the visitor returns. Exceptions thrown by the visitor are reported as errors of the file.
+     */
+    using FileVisitor = std::function<void(size_t index, std::span<const uint8_t> file)>;
+
+    /**
+     * Maps every file, distributing the files over up to `thread_count` threads.
+     * The calling thread is always one of them, so a thread count of 1 maps everything inline.
+     *
+     * @return Error of each file, in the order of the paths
+     */
+    std::vector<std::optional<std::string>> for_each_file(
+        const std::vector<std::filesystem::path>& paths,
+        size_t thread_count,
+        const FileVisitor& visitor
+    );
+
+    /**
+     * Invoked with the exports of every file that was parsed successfully, possibly from several threads at once.
+     * The exports point into the mapped file, which is unmapped once the visitor returns.
+     */
+    using Visitor = std::function<void(size_t index, const Exports& exports)>;
+
+    /**
+     * Maps and parses every file in the same way as `for_each_file`
+     *
+     * @return Error of each file that could not be mapped or parsed, in the order of the paths
+     */
+    std::vector<std::optional<std::string>> read_files(
+        const std::vector<std::filesystem::path>& paths,
+        size_t thread_count,
+        const Visitor& visitor
+    );
+}
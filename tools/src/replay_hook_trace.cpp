@@ -0,0 +1,131 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "hide_matcher/hide_matcher.hpp"
+#include "hook_replay/hook_replay.hpp"
+#include "hook_trace/hook_trace.hpp"
+
+/**
+ * Portable on purpose, so that traces recorded in games can be replayed on any machine
+ */
+namespace {
+    struct Options {
+        std::filesystem::path trace_path;
+        // `hide_files` patterns to replay the trace with
+        std::set<std::string> patterns;
+        uint32_t iterations = 1;
+    };
+
+    /**
+     * Reads one pattern per line, skipping empty lines
+     */
+    void read_patterns(const std::filesystem::path& path, std::set<std::string>& patterns) {
+        std::ifstream file(path);
+        if(not file) {
+            throw std::runtime_error("Failed to open " + path.string());
+        }
+
+        for(std::string line; std::getline(file, line);) {
+            if(not line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+
+            if(not line.empty()) {
+                patterns.insert(line);
+            }
+        }
+    }
+
+    Options parse_options(const int argc, char* argv[]) {
+        Options options;
+        std::optional<std::filesystem::path> trace_path;
+
+        const auto next_value = [&](int& i) -> std::string {
+            if(i + 1 >= argc) {
+                throw std::runtime_error(std::string("Missing value of ") + argv[i]);
+            }
+
+            return argv[++i];
+        };
+
+        for(auto i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+
+            if(arg == "--pattern") {
+                options.patterns.insert(next_value(i));
+            } else if(arg == "--patterns") {
+                read_patterns(next_value(i), options.patterns);
+            } else if(arg == "--iterations") {
+                options.iterations = static_cast<uint32_t>(std::stoul(next_value(i)));
+            } else if(trace_path) {
+                throw std::runtime_error("Unexpected argument: " + arg);
+            } else {
+                trace_path = arg;
+            }
+        }
+
+        if(not trace_path) {
+            throw std::runtime_error("No trace file provided.");
+        }
+
+        if(options.iterations == 0) {
+            throw std::runtime_error("--iterations must be at least 1.");
+        }
+
+        options.trace_path = *trace_path;
+
+        return options;
+    }
+
+    void print_report(
+        const hook_replay::Report& report,
+        const std::vector<hook_trace::Record>& records,
+        const hook_replay::TraceFileSystem& file_system
+    ) {
+        const auto recorded_duration = records.empty() ? 0 : records.back().timestamp_ns;
+
+        std::cout << "Replayed " << records.size() << " calls recorded over "
+                  << std::fixed << std::setprecision(3) << static_cast<double>(recorded_duration) / 1e9 << " s, with "
+                  << file_system.directory_count() << " enumerated directories\n";
+
+        std::cout << "Replay took " << std::chrono::duration<double, std::milli>(report.duration).count()
+                  << " ms for " << report.calls << " calls ("
+                  << std::setprecision(0) << report.calls_per_second() << " calls/s)\n";
+
+        std::cout << "Hidden in each iteration: " << report.hidden << " calls, of which " << report.newly_hidden
+                  << " were not hidden in the recorded session. " << report.newly_visible
+                  << " calls that were hidden in the recorded session are visible now.\n";
+
+        std::cout << "Hooks:\n";
+        for(const auto& line : report.hook_lines) {
+            std::cout << "  " << line << '\n';
+        }
+    }
+}
+
+int main(const int argc, char* argv[]) { // NOLINT(*-use-internal-linkage)
+    try {
+        const auto options = parse_options(argc, argv);
+
+        const auto records = hook_trace::load(options.trace_path);
+        const hide_matcher::Matcher matcher(options.patterns);
+
+        hook_replay::TraceFileSystem file_system(records);
+
+        const auto report = hook_replay::replay(records, matcher, file_system, options.iterations);
+
+        print_report(report, records, file_system);
+
+        return EXIT_SUCCESS;
+    } catch(const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
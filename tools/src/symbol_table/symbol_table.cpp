@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "symbol_table/symbol_table.hpp"
+
+namespace {
+    /**
+     * FNV-1a
+     */
+    uint64_t hash(const std::string_view str) {
+        uint64_t result = 14695981039346656037ull;
+        for(const auto c : str) {
+            result = (result ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+        }
+        return result;
+    }
+
+    template<typename T>
+    size_t capacity_bytes(const std::vector<T>& vector) {
+        return vector.capacity() * sizeof(T);
+    }
+}
+
+namespace symbol_table {
+    Id StringPool::intern(const std::string_view str) {
+        // The load factor is kept at or below 1/2, so that probe sequences stay short
+        if((size() + 1) * 2 > slots.size()) {
+            rehash(std::max<size_t>(slots.size() * 2, 16));
+        }
+
+        const auto slot = find_slot(str);
+        if(slots[slot] != EMPTY_SLOT) {
+            return slots[slot];
+        }
+
+        if(arena.size() + str.size() > UINT32_MAX || size() >= EMPTY_SLOT) {
+            throw std::length_error("String pool is full");
+        }
+
+        const auto id = static_cast<Id>(size());
+        arena.append(str);
+        starts.push_back(static_cast<uint32_t>(arena.size()));
+        slots[slot] = id;
+
+        return id;
+    }
+
+    std::optional<Id> StringPool::find(const std::string_view str) const {
+        if(slots.empty()) {
+            return std::nullopt;
+        }
+
+        const auto id = slots[find_slot(str)];
+        return id == EMPTY_SLOT ? std::nullopt : std::optional(id);
+    }
+
+    std::string_view StringPool::get(const Id id) const {
+        return std::string_view(arena).substr(starts[id], starts[id + 1] - starts[id]);
+    }
+
+    size_t StringPool::size() const {
+        return starts.size() - 1;
+    }
+
+    std::vector<Id> StringPool::sort() {
+        std::vector<Id> order(size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::sort(order, {}, [&](const Id id) { return get(id); });
+
+        std::vector<Id> new_ids(size());
+        std::string sorted_arena;
+        sorted_arena.reserve(arena.size());
+        std::vector<uint32_t> sorted_starts{0};
+        sorted_starts.reserve(starts.size());
+
+        for(size_t i = 0; i < order.size(); ++i) {
+            new_ids[order[i]] = static_cast<Id>(i);
+            sorted_arena.append(get(order[i]));
+            sorted_starts.push_back(static_cast<uint32_t>(sorted_arena.size()));
+        }
+
+        arena = std::move(sorted_arena);
+        starts = std::move(sorted_starts);
+        rehash(slots.size());
+
+        return new_ids;
+    }
+
+    size_t StringPool::memory_usage() const {
+        return arena.capacity() + capacity_bytes(starts) + capacity_bytes(slots);
+    }
+
+    /**
+     * @return Slot that holds the string, or the empty slot where it belongs
+     */
+    size_t StringPool::find_slot(const std::string_view str) const {
+        const auto mask = slots.size() - 1;
+
+        for(auto slot = hash(str) & mask;; slot = (slot + 1) & mask) {
+            if(slots[slot] == EMPTY_SLOT || get(slots[slot]) == str) {
+                return slot;
+            }
+        }
+    }
+
+    void StringPool::rehash(const size_t slot_count) {
+        slots.assign(slot_count, EMPTY_SLOT);
+
+        for(Id id = 0; id < size(); ++id) {
+            slots[find_slot(get(id))] = id;
+        }
+    }
+
+    Id SymbolTable::add_library(const std::string_view path) {
+        if(finalized) {
+            throw std::logic_error("Symbol table is already finalized");
+        }
+
+        return libraries.intern(path);
+    }
+
+    void SymbolTable::add(const Id library, const std::string_view symbol) {
+        if(finalized) {
+            throw std::logic_error("Symbol table is already finalized");
+        }
+
+        pending.push_back(uint64_t{symbols.intern(symbol)} << 32 | library);
+    }
+
+    void SymbolTable::finalize() {
+        if(finalized) {
+            return;
+        }
+
+        const auto new_symbol_ids = symbols.sort();
+        const auto new_library_ids = libraries.sort();
+
+        for(auto& membership : pending) {
+            const auto symbol = new_symbol_ids[membership >> 32];
+            const auto library = new_library_ids[membership & UINT32_MAX];
+            membership = uint64_t{symbol} << 32 | library;
+        }
+
+        std::ranges::sort(pending);
+        pending.erase(std::ranges::unique(pending).begin(), pending.end());
+
+        // Memberships are sorted by symbol, so the libraries of each symbol follow each other
+        offsets.assign(symbols.size() + 1, 0);
+        members.reserve(pending.size());
+
+        for(const auto membership : pending) {
+            offsets[(membership >> 32) + 1]++;
+            members.push_back(static_cast<Id>(membership & UINT32_MAX));
+        }
+
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        pending.clear();
+        pending.shrink_to_fit();
+        finalized = true;
+    }
+
+    size_t SymbolTable::symbol_count() const {
+        return symbols.size();
+    }
+
+    size_t SymbolTable::library_count() const {
+        return libraries.size();
+    }
+
+    size_t SymbolTable::membership_count() const {
+        return finalized ? members.size() : pending.size();
+    }
+
+    std::string_view SymbolTable::symbol(const Id id) const {
+        return symbols.get(id);
+    }
+
+    std::string_view SymbolTable::library(const Id id) const {
+        return libraries.get(id);
+    }
+
+    std::optional<Id> SymbolTable::find_symbol(const std::string_view symbol) const {
+        return symbols.find(symbol);
+    }
+
+    std::span<const Id> SymbolTable::libraries_of(const Id symbol) const {
+        if(not finalized) {
+            throw std::logic_error("Symbol table is not finalized");
+        }
+
+        return std::span(members).subspan(offsets[symbol], offsets[symbol + 1] - offsets[symbol]);
+    }
+
+    size_t SymbolTable::memory_usage() const {
+        return symbols.memory_usage() + libraries.memory_usage() +
+               capacity_bytes(pending) + capacity_bytes(offsets) + capacity_bytes(members);
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Memory-compact table of which libraries export which symbols.
+ *
+ * Symbol names and library paths are interned once into contiguous arenas and referred to
+ * by 32-bit IDs, found through open-addressing hash tables that store nothing but IDs.
+ * Memberships are collected as packed ID pairs and compacted by `finalize` into
+ * a flat, sorted list of library IDs per symbol. This takes a few bytes per export
+ * instead of a separately allocated string per symbol and a path copy per export.
+ */
+namespace symbol_table {
+    using Id = uint32_t;
+
+    /**
+     * Deduplicated strings, stored back to back
+     */
+    class StringPool {
+    public:
+        /**
+         * @return ID of the string, which is added if the pool does not contain it yet
+         * @throws std::length_error if the pool would exceed 4 GiB
+         */
+        Id intern(std::string_view str);
+
+        [[nodiscard]] std::optional<Id> find(std::string_view str) const;
+
+        [[nodiscard]] std::string_view get(Id id) const;
+
+        [[nodiscard]] size_t size() const;
+
+        /**
+         * Renumbers the strings so that their IDs follow the lexicographical order of the strings
+         *
+         * @return New ID of each string, indexed by its previous ID
+         */
+        std::vector<Id> sort();
+
+        [[nodiscard]] size_t memory_usage() const;
+
+    private:
+        static constexpr Id EMPTY_SLOT = UINT32_MAX;
+
+        std::string arena;
+        // String `i` spans from `starts[i]` to `starts[i + 1]`
+        std::vector<uint32_t> starts{0};
+        // IDs of strings at the position of their hash, or `EMPTY_SLOT`
+        std::vector<Id> slots;
+
+        [[nodiscard]] size_t find_slot(std::string_view str) const;
+
+        void rehash(size_t slot_count);
+    };
+
+    class SymbolTable {
+    public:
+        /**
+         * @return ID of the library, which is the same for every call with the same path
+         * @throws std::logic_error if the table is already finalized
+         */
+        Id add_library(std::string_view path);
+
+        /**
+         * @throws std::logic_error if the table is already finalized
+         */
+        void add(Id library, std::string_view symbol);
+
+        /**
+         * Compacts the memberships, and renumbers symbols and libraries in the lexicographical order
+         * of their names, so that iterating over IDs visits them in sorted order.
+         * Must be called before `libraries_of`, and invalidates IDs returned so far.
+         */
+        void finalize();
+
+        [[nodiscard]] size_t symbol_count() const;
+
+        [[nodiscard]] size_t library_count() const;
+
+        [[nodiscard]] size_t membership_count() const;
+
+        [[nodiscard]] std::string_view symbol(Id id) const;
+
+        [[nodiscard]] std::string_view library(Id id) const;
+
+        [[nodiscard]] std::optional<Id> find_symbol(std::string_view symbol) const;
+
+        /**
+         * @return Sorted IDs of libraries that export the symbol
+         * @throws std::logic_error if the table is not finalized
+         */
+        [[nodiscard]] std::span<const Id> libraries_of(Id symbol) const;
+
+        /**
+         * @return Bytes allocated by the table
+         */
+        [[nodiscard]] size_t memory_usage() const;
+
+    private:
+        StringPool symbols;
+        StringPool libraries;
+
+        // Symbol ID in the upper half and library ID in the lower half, until finalized
+        std::vector<uint64_t> pending;
+        // Libraries of symbol `i` span from `offsets[i]` to `offsets[i + 1]` in `members`
+        std::vector<uint32_t> offsets;
+        std::vector<Id> members;
+        bool finalized = false;
+    };
+}